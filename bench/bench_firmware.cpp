@@ -0,0 +1,119 @@
+// Host replacements for the firmware modules that need hardware or radio:
+// replaces src/ir_transmitter.cpp, network_manager.cpp, wall_clock.cpp,
+// session_journal.cpp and trigger_socket.cpp in the benchmark build.
+// Everything else, including the web handlers in src/main.cpp and the
+// real-time task, is the firmware code itself.
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include <atomic>
+#include "ir_transmitter.h"
+#include "network_manager.h"
+#include "session_journal.h"
+#include "trigger_socket.h"
+#include "wall_clock.h"
+
+// IR sender: on the air for the length of the loaded train, in real time
+static uint32_t trainUs = 0;
+static std::atomic<int64_t> busyUntilUs{0};
+
+bool irTransmitterBegin(uint8_t pin) {
+    return true;
+}
+
+bool irTransmitterLoad(const IrPulseTrain& train) {
+    trainUs = irTrainDurationUs(train);
+    return true;
+}
+
+bool irTransmitterSend() {
+    if (irTransmitterBusy()) return false;
+    busyUntilUs = esp_timer_get_time() + trainUs;
+    return true;
+}
+
+bool irTransmitterBusy() {
+    return esp_timer_get_time() < busyUntilUs;
+}
+
+// Network: an associated station with SNTP time
+BootTiming bootTiming;
+
+void networkBegin() {
+    bootTiming.networkReadyMs = millis();
+    bootTiming.timeSyncMs = millis();
+}
+
+void networkUpdate() {
+}
+
+NetworkState networkState() {
+    return NET_STATION;
+}
+
+bool networkTimeSynced() {
+    return true;
+}
+
+// Wall clock: the host clock
+void wallClockRestore() {
+}
+
+void wallClockSynced() {
+}
+
+void wallClockMaintain() {
+}
+
+int64_t wallClockEpochMs() {
+    timeval now;
+    gettimeofday(&now, nullptr);
+    return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
+WallClockSource wallClockSource() {
+    return CLOCK_NTP;
+}
+
+const char* wallClockSourceName() {
+    return "ntp";
+}
+
+// Session journal: no file system, nothing to resume; the plan is kept in
+// RAM for the sync beacon
+static SequencePlan journaledPlan;
+static bool planSaved = false;
+
+bool sessionJournalBegin(JournalRecovery& recovery) {
+    return false;
+}
+
+bool sessionJournalSavePlan(const SequencePlan& plan) {
+    journaledPlan = plan;
+    planSaved = true;
+    return true;
+}
+
+bool sessionJournalLoadPlan(SequencePlan& plan) {
+    plan = journaledPlan;
+    return planSaved;
+}
+
+void sessionJournalOnStatus(const StatusSnapshot& previous, const StatusSnapshot& current) {
+}
+
+void sessionJournalMaintain() {
+}
+
+// The WebSocket trigger channel is not part of the HTTP benchmark
+bool triggerSocketAccept(WiFiClient& client, const char* key) {
+    return false;
+}
+
+void triggerSocketUpdate(const StatusSnapshot& status) {
+}
+
+uint8_t triggerSocketClientCount() {
+    return 0;
+}
@@ -0,0 +1,128 @@
+// The /system page as it was rendered before HtmlWriter: one String built
+// by concatenation, with a String(...) temporary per value, then sent with
+// a Content-Length. Same content as handleSystemOverview() in src/main.cpp.
+// Served at /system-legacy with --compare-system so the benchmark reports
+// bytes, allocations and handler time of both renderers side by side.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WebServer.h>
+#include "ir_profiles.h"
+#include "network_manager.h"
+#include "rt_task.h"
+#include "session.h"
+#include "temperature_sensor.h"
+#include "wall_clock.h"
+
+// From src/main.cpp
+extern WebServer server;
+extern StatusSnapshot status;
+void noteRequest();
+const char* formatCenti(char* buffer, size_t size, int16_t centi, const char* unknown);
+
+static void handleLegacySystemOverview() {
+    noteRequest();
+    const SessionData& session = status.session;
+    
+    String html = "<!DOCTYPE html><html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">";
+    html += "<title>AstroController Rev 1 - System Overview</title>";
+    html += "<style>body { background: #1a1a1a; color: #ff6b6b; font-family: monospace; margin: 0; padding: 20px; }";
+    html += ".container { max-width: 800px; margin: 0 auto; } h1, h2 { color: #ff6b6b; }";
+    html += ".component { background: #2a2a2a; padding: 15px; border-radius: 8px; margin: 15px 0; }";
+    html += ".status-ok { color: #4CAF50; } .status-warn { color: #FFC107; } .status-err { color: #F44336; }";
+    html += ".back { color: #ff6b6b; text-decoration: none; }";
+    html += "</style></head><body><div class=\"container\">";
+    
+    html += "<h1>AstroController Rev 1 System</h1>";
+    html += "<a href=\"/\" class=\"back\">← Back to Control</a>";
+    
+    html += "<h2>System Architecture</h2>";
+    html += "<div class=\"component\">";
+    html += "<h3>ESP32 D32 Pro (Standalone)</h3>";
+    html += "<p><strong>Function:</strong> IR sender for camera, session management, web interface</p>";
+    html += "<p><strong>Hardware:</strong> IR LED on GPIO 4, WiFi, HTTP API</p>";
+    html += "<p><strong>Status:</strong> <span class=\"status-ok\">Online</span></p>";
+    html += "<p><strong>IP:</strong> " + WiFi.localIP().toString() + "</p>";
+    html += "<p><strong>Memory:</strong> " + String((unsigned long)(ESP.getFreeHeap() / 1024)) + " KB free</p>";
+    html += "</div>";
+    
+    html += "<h2>Current Session</h2>";
+    html += "<div class=\"component\">";
+    html += "<p><strong>Status:</strong> ";
+    
+    switch(session.state) {
+        case STATE_IDLE:
+            html += "<span class=\"status-ok\">Ready</span>";
+            break;
+        case STATE_RUNNING:
+            html += "<span class=\"status-warn\">Running</span>";
+            break;
+        case STATE_COMPLETED:
+            html += "<span class=\"status-ok\">Completed</span>";
+            break;
+        default:
+            html += "<span class=\"status-err\">Unknown</span>";
+    }
+    
+    html += "</p>";
+    uint32_t intervalMs = session.state == STATE_RUNNING ? session.intervalMs : calculateIntervalMs();
+    html += "<p><strong>Photo Interval:</strong> " + String(intervalMs / 1000.0f, 1) + " seconds</p>";
+    html += "<p><strong>Photos Taken:</strong> " + String((unsigned)session.currentShot) + " / " + String((unsigned)session.totalShots) + "</p>";
+    html += "<p><strong>Runtime:</strong> " + String((millis() - session.sessionStartTime) / 1000) + " seconds</p>";
+    char temperature[8];
+    html += "<p><strong>Temperature:</strong> " + String(formatCenti(temperature, sizeof(temperature), temperatureLatestCenti(), "--")) + "°C</p>";
+    html += "</div>";
+    
+    html += "<h2>Hardware Status</h2>";
+    html += "<div class=\"component\">";
+    html += "<p><strong>IR Sender:</strong> <span class=\"status-ok\">Ready (" + String(IR_PROFILES[status.irProfile].name) + ")</span></p>";
+    html += "<p><strong>WiFi:</strong> <span class=\"status-ok\">Connected</span> (RSSI: " + String(WiFi.RSSI()) + " dBm)</p>";
+    html += "<p><strong>Web Server:</strong> <span class=\"status-ok\">Running on Port 80</span></p>";
+    
+    TemperatureStatus sensor;
+    temperatureReadStatus(sensor);
+    html += "<p><strong>Temperature Sensor:</strong> <span class=\"" + String(sensor.valid ? "status-ok" : "status-err") + "\">" +
+            String(sensor.valid ? "Reading" : "No data") + "</span> (" + String(temperatureSensorName()) + ", " +
+            String((unsigned long)sensor.readings) + " readings, " + String((unsigned long)sensor.dropped) + " dropped)</p>";
+    
+    if (networkState() == NET_STATION) {
+        if (networkTimeSynced()) {
+            struct tm timeinfo;
+            if (getLocalTime(&timeinfo)) {
+                char timeStr[64];
+                strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
+                html += "<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span> (" + String(timeStr) + ")</p>";
+            } else {
+                html += "<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span></p>";
+            }
+        } else {
+            html += "<p><strong>NTP Sync:</strong> <span class=\"status-warn\">Not Synchronized</span></p>";
+        }
+    } else if (networkState() == NET_CONNECTING) {
+        html += "<p><strong>NTP Sync:</strong> <span class=\"status-warn\">Connecting to WiFi</span></p>";
+    } else {
+        html += "<p><strong>NTP Sync:</strong> <span class=\"status-warn\">AP Mode - No Internet</span></p>";
+    }
+    html += "<p><strong>Clock Source:</strong> " + String(wallClockSourceName()) + "</p>";
+    html += "</div>";
+    
+    html += "<h2>Usage</h2>";
+    html += "<div class=\"component\">";
+    html += "<p><strong>1. Start Session:</strong> Enter time → Start Session</p>";
+    html += "<p><strong>2. Single Shot:</strong> Single Shot button</p>";
+    html += "<p><strong>3. Automated:</strong> ESP32 handles timing automatically</p>";
+    html += "<p><strong>4. Network:</strong> Web interface via WiFi</p>";
+    html += "</div>";
+    
+    html += "<p style=\"text-align: center; margin-top: 30px; color: #666;\">";
+    html += "AstroController Rev 1 | ESP32 Standalone | Uptime: " + String(millis() / 1000) + "s";
+    html += "</p>";
+    
+    html += "</div></body></html>";
+    
+    server.send(200, "text/html", html);
+}
+
+void benchAddLegacyRoutes() {
+    server.on("/system-legacy", HTTP_GET, handleLegacySystemOverview);
+}
@@ -0,0 +1,311 @@
+// AstroController HTTP benchmark
+//
+//   pio run -e bench && .pio/build/bench/program [options]
+//
+// Boots the firmware (setup() from src/main.cpp, real-time task included)
+// on the host with the web server listening on loopback, drives it with
+// closed-loop clients and reports per endpoint: throughput, latency
+// percentiles, bytes sent and heap allocations made by the handler.
+//
+//   --clients N        Concurrent clients (default 4)
+//   --seconds S        Length of the run (default 10)
+//   --think MS         Pause between a client's requests (default 0)
+//   --only A,B         Only these endpoints of the mix (root, status, system,
+//                      metrics, shots, temperature, start, stop)
+//   --out FILE         Append the results as one JSON line to FILE
+//   --label TEXT       Label stored with the results, e.g. the git revision
+//   --port N           Loopback port (default: any free port)
+//   --seed N           PRNG seed for the endpoint mix
+//   --compare-system   Only /system, against the String-built page it
+//                      replaced (bench_legacy.cpp), in equal shares
+//   --check-allocs     Fail unless the arena handlers made no heap allocations
+//                      of their own after their first request (ALLOCATION_BUDGETS)
+//   --verbose          Show the firmware's Serial output
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "bench_platform.h"
+#include "load_generator.h"
+
+void setup();
+void benchAddLegacyRoutes();
+
+// Request mix, weighted like a phone with the status page open: mostly
+// status polls, an occasional page load, session control now and then
+static const LoadEndpoint ENDPOINT_MIX[] = {
+    {"root", "GET", "/", nullptr, 2},
+    {"status", "GET", "/api/status", nullptr, 10},
+    {"system", "GET", "/system", nullptr, 2},
+    {"metrics", "GET", "/api/metrics", nullptr, 1},
+    {"shots", "GET", "/api/shots", nullptr, 1},
+    {"temperature", "GET", "/api/temperature", nullptr, 1},
+    {"schedule", "GET", "/api/schedule", nullptr, 1},
+    {"start", "POST", "/start", "{\"minutes\":1}", 1},
+    {"stop", "POST", "/stop", nullptr, 1},
+};
+
+// Steady-state heap allocations per request the handlers behind the request
+// arena and HtmlWriter may make: none of their own, only the WebServer's
+static const struct {
+    const char* name;
+    double perRequest;
+} ALLOCATION_BUDGETS[] = {
+    {"status", 0},
+    {"system", 0},
+    {"metrics", 0},
+    {"schedule", 0},
+    {"start", 1},       // The String copy of the body server.arg("plain") returns
+    {"stop", 0},
+};
+
+static const LoadEndpoint COMPARE_SYSTEM_MIX[] = {
+    {"system", "GET", "/system", nullptr, 1},
+    {"system_old", "GET", "/system-legacy", nullptr, 1},
+};
+
+struct BenchOptions {
+    LoadConfig load;
+    const char* only = nullptr;
+    const char* outPath = nullptr;
+    const char* label = "";
+    bool compareSystem = false;
+    bool checkAllocations = false;
+    bool verbose = false;
+};
+
+static void usage() {
+    fprintf(stderr, "usage: program [--clients N] [--seconds S] [--think MS] [--only A,B] [--out FILE]\n"
+                    "               [--label TEXT] [--port N] [--seed N] [--compare-system] [--check-allocs]\n"
+                    "               [--verbose]\n");
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+        
+        if (strcmp(arg, "--verbose") == 0) {
+            options.verbose = true;
+            takesValue = false;
+        } else if (strcmp(arg, "--compare-system") == 0) {
+            options.compareSystem = true;
+            takesValue = false;
+        } else if (strcmp(arg, "--check-allocs") == 0) {
+            options.checkAllocations = true;
+            takesValue = false;
+        } else if (value == nullptr) {
+            return false;
+        } else if (strcmp(arg, "--clients") == 0) {
+            options.load.clients = atoi(value);
+        } else if (strcmp(arg, "--seconds") == 0) {
+            options.load.seconds = atoi(value);
+        } else if (strcmp(arg, "--think") == 0) {
+            options.load.thinkMs = atoi(value);
+        } else if (strcmp(arg, "--only") == 0) {
+            options.only = value;
+        } else if (strcmp(arg, "--out") == 0) {
+            options.outPath = value;
+        } else if (strcmp(arg, "--label") == 0) {
+            options.label = value;
+        } else if (strcmp(arg, "--port") == 0) {
+            options.load.port = atoi(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            options.load.seed = atoi(value);
+        } else {
+            return false;
+        }
+        if (takesValue) i++;
+    }
+    return options.load.clients > 0 && options.load.seconds > 0;
+}
+
+// Endpoint names in a comma separated list
+static bool listed(const char* list, const char* name) {
+    size_t len = strlen(name);
+    for (const char* p = list; *p != '\0';) {
+        const char* comma = strchr(p, ',');
+        size_t itemLen = comma != nullptr ? (size_t)(comma - p) : strlen(p);
+        if (itemLen == len && strncmp(p, name, len) == 0) return true;
+        if (comma == nullptr) break;
+        p = comma + 1;
+    }
+    return false;
+}
+
+// Everything reported for one endpoint
+struct EndpointReport {
+    const LoadEndpoint* endpoint;
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t status[6];
+    double perSecond;
+    uint32_t p50Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+    double bytesPerRequest;
+    double allocationsPerRequest;
+    double allocatedBytesPerRequest;
+    double steadyAllocationsPerRequest;     // -1 until a route served two requests
+    double handlerMeanUs;
+    uint32_t handlerMaxUs;
+};
+
+static void buildReports(const std::vector<LoadEndpoint>& endpoints, std::vector<EndpointResult>& results,
+                         double elapsedSeconds, std::vector<EndpointReport>& reports) {
+    std::vector<BenchRouteStats> routes;
+    benchRouteStats(routes);
+    
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        EndpointResult& result = results[i];
+        EndpointReport report = {};
+        report.endpoint = &endpoints[i];
+        report.steadyAllocationsPerRequest = -1;
+        report.requests = result.requests;
+        report.failures = result.failures;
+        memcpy(report.status, result.status, sizeof(report.status));
+        report.perSecond = result.requests / elapsedSeconds;
+        report.p50Us = latencyPercentile(result.latencyUs, 50);
+        report.p99Us = latencyPercentile(result.latencyUs, 99);
+        report.maxUs = latencyPercentile(result.latencyUs, 100);
+        
+        // Server side figures, matched by route
+        std::string key = std::string(endpoints[i].method) + " " + endpoints[i].path;
+        for (const BenchRouteStats& route : routes) {
+            if (route.key != key || route.requests == 0) continue;
+            report.bytesPerRequest = (double)route.bytesSent / route.requests;
+            report.allocationsPerRequest = (double)route.allocations / route.requests;
+            report.allocatedBytesPerRequest = (double)route.allocatedBytes / route.requests;
+            if (route.requests > 1) report.steadyAllocationsPerRequest = (double)route.steadyAllocations / (route.requests - 1);
+            report.handlerMeanUs = (double)route.handlerUs / route.requests;
+            report.handlerMaxUs = route.handlerMaxUs;
+        }
+        reports.push_back(report);
+    }
+}
+
+static void printReports(const BenchOptions& options, const std::vector<EndpointReport>& reports, double elapsedSeconds) {
+    printf("\n%u clients, %.1f s%s\n\n", options.load.clients, elapsedSeconds,
+           benchHeapHooked() ? "" : " (no heap hooks on this platform, allocations not counted)");
+    printf("%-11s %8s %8s %8s %8s %8s %9s %8s %10s %9s %6s\n", "endpoint", "requests", "req/s", "p50 us", "p99 us",
+           "max us", "bytes/req", "allocs", "alloc B", "handler", "errors");
+    for (const EndpointReport& report : reports) {
+        uint32_t errors = report.failures + report.status[4] + report.status[5];
+        printf("%-11s %8u %8.1f %8u %8u %8u %9.0f %8.1f %10.0f %9.1f %6u\n", report.endpoint->name, report.requests,
+               report.perSecond, report.p50Us, report.p99Us, report.maxUs, report.bytesPerRequest,
+               report.allocationsPerRequest, report.allocatedBytesPerRequest, report.handlerMeanUs, errors);
+    }
+    printf("\nallocs and alloc B per request, handler = mean handler time in us;\n"
+           "errors = failed connections plus 4xx/5xx (start/stop answer 400 when already in that state)\n");
+}
+
+// Every budgeted endpoint that ran must stay within its budget
+static bool checkAllocations(const std::vector<EndpointReport>& reports) {
+    if (!benchHeapHooked()) {
+        printf("\nallocation check: no heap hooks on this platform\n");
+        return false;
+    }
+    
+    bool ok = true;
+    printf("\nallocation check, steady state:\n");
+    for (const EndpointReport& report : reports) {
+        for (const auto& budget : ALLOCATION_BUDGETS) {
+            if (strcmp(budget.name, report.endpoint->name) != 0) continue;
+            
+            bool within = report.steadyAllocationsPerRequest >= 0 &&
+                          report.steadyAllocationsPerRequest <= budget.perRequest;
+            if (report.steadyAllocationsPerRequest < 0) {
+                printf("  %-11s not enough requests\n", report.endpoint->name);
+            } else {
+                printf("  %-11s %6.2f allocs/req, budget %.0f  %s\n", report.endpoint->name,
+                       report.steadyAllocationsPerRequest, budget.perRequest, within ? "ok" : "FAIL");
+            }
+            ok = ok && within;
+        }
+    }
+    return ok;
+}
+
+static bool writeResults(const BenchOptions& options, const std::vector<EndpointReport>& reports, double elapsedSeconds) {
+    FILE* out = fopen(options.outPath, "a");
+    if (out == nullptr) {
+        fprintf(stderr, "cannot open %s\n", options.outPath);
+        return false;
+    }
+    
+    // Labels are revision names, anything JSON would need escaped is dropped
+    std::string label;
+    for (const char* p = options.label; *p != '\0'; p++) {
+        if (*p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) label += *p;
+    }
+    
+    fprintf(out, "{\"label\":\"%s\",\"time\":%ld,\"clients\":%u,\"seconds\":%.3f,\"think_ms\":%u,\"heap_hooked\":%s,\"endpoints\":[",
+            label.c_str(), (long)time(nullptr), options.load.clients, elapsedSeconds, options.load.thinkMs,
+            benchHeapHooked() ? "true" : "false");
+    for (size_t i = 0; i < reports.size(); i++) {
+        const EndpointReport& r = reports[i];
+        fprintf(out, "%s{\"name\":\"%s\",\"method\":\"%s\",\"path\":\"%s\",\"requests\":%u,\"failures\":%u,"
+                     "\"status\":{\"2xx\":%u,\"3xx\":%u,\"4xx\":%u,\"5xx\":%u},\"per_second\":%.2f,"
+                     "\"p50_us\":%u,\"p99_us\":%u,\"max_us\":%u,\"bytes_per_request\":%.1f,"
+                     "\"allocations_per_request\":%.2f,\"allocated_bytes_per_request\":%.1f,"
+                     "\"handler_mean_us\":%.1f,\"handler_max_us\":%u}",
+                i > 0 ? "," : "", r.endpoint->name, r.endpoint->method, r.endpoint->path, r.requests, r.failures,
+                r.status[2], r.status[3], r.status[4], r.status[5], r.perSecond, r.p50Us, r.p99Us, r.maxUs,
+                r.bytesPerRequest, r.allocationsPerRequest, r.allocatedBytesPerRequest, r.handlerMeanUs, r.handlerMaxUs);
+    }
+    fprintf(out, "]}\n");
+    fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+    
+    std::vector<LoadEndpoint> endpoints;
+    if (options.compareSystem) {
+        endpoints.assign(COMPARE_SYSTEM_MIX, COMPARE_SYSTEM_MIX + 2);
+        benchAddLegacyRoutes();
+    } else {
+        for (const LoadEndpoint& endpoint : ENDPOINT_MIX) {
+            if (options.only == nullptr || listed(options.only, endpoint.name)) endpoints.push_back(endpoint);
+        }
+    }
+    if (endpoints.empty()) {
+        fprintf(stderr, "no endpoints selected\n");
+        return 2;
+    }
+    
+    benchSetVerbose(options.verbose);
+    benchSetListenPort(options.load.port);
+    setup();
+    options.load.port = benchListenPort();
+    if (options.load.port == 0) {
+        fprintf(stderr, "web server did not start\n");
+        return 1;
+    }
+    printf("Firmware listening on 127.0.0.1:%u\n", options.load.port);
+    
+    std::vector<EndpointResult> results;
+    double elapsedSeconds = 0;
+    runLoad(options.load, endpoints, results, elapsedSeconds);
+    
+    std::vector<EndpointReport> reports;
+    buildReports(endpoints, results, elapsedSeconds, reports);
+    printReports(options, reports, elapsedSeconds);
+    bool written = options.outPath == nullptr || writeResults(options, reports, elapsedSeconds);
+    bool allocationsOk = !options.checkAllocations || checkAllocations(reports);
+    
+    // The firmware tasks never return, leave without joining them
+    fflush(stdout);
+    _exit(written && allocationsOk ? 0 : 1);
+}
@@ -0,0 +1,306 @@
+// Host implementation of the Arduino-ESP32 shim (shim/Arduino.h and friends):
+// clocks, Serial, heap accounting, FreeRTOS tasks as threads, in-memory NVS.
+
+#include "bench_platform.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+static std::atomic<bool> verbose{false};
+
+// Heap accounting through the glibc malloc entry points. Counters are per
+// thread so the load generator's own allocations never mix into the
+// network task's.
+static thread_local BenchHeapCounters threadHeap;
+static std::atomic<int64_t> liveBytes{0};
+static std::atomic<int64_t> peakBytes{0};
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* pointer, size_t size);
+extern "C" void __libc_free(void* pointer);
+
+static void noteAllocation(void* pointer) {
+    if (pointer == nullptr) return;
+    size_t size = malloc_usable_size(pointer);
+    threadHeap.allocations++;
+    threadHeap.bytes += size;
+    int64_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+static void noteRelease(void* pointer) {
+    if (pointer != nullptr) liveBytes.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+}
+
+extern "C" void* malloc(size_t size) {
+    void* pointer = __libc_malloc(size);
+    noteAllocation(pointer);
+    return pointer;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    void* pointer = __libc_calloc(count, size);
+    noteAllocation(pointer);
+    return pointer;
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+    noteRelease(pointer);
+    void* moved = __libc_realloc(pointer, size);
+    noteAllocation(moved != nullptr ? moved : (size != 0 ? pointer : nullptr));
+    return moved;
+}
+
+extern "C" void free(void* pointer) {
+    noteRelease(pointer);
+    __libc_free(pointer);
+}
+
+bool benchHeapHooked() {
+    return true;
+}
+#else
+bool benchHeapHooked() {
+    return false;
+}
+#endif
+
+BenchHeapCounters benchThreadHeap() {
+    return threadHeap;
+}
+
+void benchSetVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+// Clocks
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)esp_timer_get_time();
+}
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    time_t now = time(nullptr);
+    return localtime_r(&now, info) != nullptr;
+}
+
+// Print and Serial
+
+size_t Print::write(const uint8_t* data, size_t len) {
+    size_t written = 0;
+    while (written < len && write(data[written])) written++;
+    return written;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(buffer)) return write((const uint8_t*)buffer, len);
+    
+    char* large = (char*)malloc(len + 1);
+    if (large == nullptr) return 0;
+    va_start(args, format);
+    vsnprintf(large, len + 1, format, args);
+    va_end(args);
+    size_t written = write((const uint8_t*)large, len);
+    free(large);
+    return written;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    if (verbose) fwrite(data, 1, len, stdout);
+    return len;
+}
+
+// Heap figures
+
+uint32_t EspClass::getFreeHeap() {
+    int64_t live = liveBytes.load(std::memory_order_relaxed);
+    return live < BENCH_HEAP_SIZE ? BENCH_HEAP_SIZE - live : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    return peak < BENCH_HEAP_SIZE ? BENCH_HEAP_SIZE - peak : 0;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+bool psramFound() {
+    return false;
+}
+
+void* ps_malloc(size_t size) {
+    return malloc(size);
+}
+
+float temperatureRead() {
+    return 41.5f;
+}
+
+// FreeRTOS tasks
+
+struct BenchTask {
+    TaskFunction_t function;
+    void* parameter;
+    std::mutex mutex;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+};
+
+static thread_local BenchTask* currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    // Firmware tasks run forever, so the task block is never freed
+    BenchTask* task = new BenchTask();
+    task->function = function;
+    task->parameter = parameter;
+    if (handle != nullptr) *handle = task;
+    
+    std::thread([task] {
+        currentTask = task;
+        task->function(task->parameter);
+    }).detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Only ever used by a task on itself; park the thread
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+}
+
+void vTaskDelay(TickType_t ticks) {
+    delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+    *previousWake += increment;
+    int32_t wait = (int32_t)(*previousWake - xTaskGetTickCount());
+    if (wait > 0) delay(wait);
+}
+
+TickType_t xTaskGetTickCount() {
+    return millis();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    BenchTask* task = currentTask;
+    if (task == nullptr) return 0;
+    
+    std::unique_lock<std::mutex> lock(task->mutex);
+    if (ticks == portMAX_DELAY) {
+        task->wake.wait(lock, [task] { return task->notifications > 0; });
+    } else {
+        task->wake.wait_for(lock, std::chrono::milliseconds(ticks), [task] { return task->notifications > 0; });
+    }
+    uint32_t value = task->notifications;
+    if (value > 0) task->notifications = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+// NVS
+
+static std::mutex nvsMutex;
+static std::map<std::string, std::string> nvs;
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    space = name;
+    return true;
+}
+
+std::string Preferences::path(const char* key) const {
+    return space + "/" + key;
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+    return getUChar(key, defaultValue ? 1 : 0) != 0;
+}
+
+size_t Preferences::putBool(const char* key, bool value) {
+    return putUChar(key, value ? 1 : 0);
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    auto entry = nvs.find(path(key));
+    return entry != nvs.end() && entry->second.size() == 1 ? (uint8_t)entry->second[0] : defaultValue;
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvs[path(key)] = std::string(1, (char)value);
+    return 1;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    auto entry = nvs.find(path(key));
+    if (entry == nvs.end() || entry->second.size() + 1 > maxLen) return 0;
+    memcpy(value, entry->second.c_str(), entry->second.size() + 1);
+    return entry->second.size() + 1;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    nvs[path(key)] = value;
+    return strlen(value);
+}
+
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(text);
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_PLATFORM_H
+#define BENCH_PLATFORM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Controls and measurements of the host platform under the HTTP benchmark
+// (shim/ and bench_*.cpp), used by bench_main.cpp.
+
+const uint32_t BENCH_HEAP_SIZE = 320 * 1024;    // Reported free heap = this minus live bytes
+
+// Heap use of the calling thread, from the malloc hooks (glibc only;
+// elsewhere the counters stay at zero)
+struct BenchHeapCounters {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+BenchHeapCounters benchThreadHeap();
+bool benchHeapHooked();
+
+// Firmware Serial output goes to stdout only when verbose
+void benchSetVerbose(bool verbose);
+
+// Loopback port the stand-in WebServer listens on, 0 = any free port;
+// set before setup(), read back once it is listening
+void benchSetListenPort(uint16_t port);
+uint16_t benchListenPort();
+
+// What the server did per "METHOD /path", measured around each handler
+struct BenchRouteStats {
+    std::string key;
+    uint32_t requests = 0;
+    uint64_t bytesSent = 0;         // Status line, headers and body
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t steadyAllocations = 0; // Leaving out the route's first request
+    uint64_t handlerUs = 0;
+    uint32_t handlerMaxUs = 0;
+};
+
+void benchRouteStats(std::vector<BenchRouteStats>& stats);
+
+#endif // BENCH_PLATFORM_H
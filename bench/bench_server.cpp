@@ -0,0 +1,400 @@
+// Stand-in WebServer and WiFiClient over loopback TCP (shim/WebServer.h,
+// shim/WiFi.h), with the per-route accounting the benchmark reports.
+
+#include "bench_platform.h"
+
+#include <WebServer.h>
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+static const size_t MAX_REQUEST_HEAD = 8192;
+static const int REQUEST_TIMEOUT_MS = 5000;     // Like HTTP_MAX_DATA_WAIT of the ESP32 server
+
+static std::atomic<uint16_t> listenPort{0};
+static std::mutex statsMutex;
+static std::map<std::string, BenchRouteStats> routeStats;
+
+void benchSetListenPort(uint16_t port) {
+    listenPort = port;
+}
+
+uint16_t benchListenPort() {
+    return listenPort;
+}
+
+void benchRouteStats(std::vector<BenchRouteStats>& stats) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.clear();
+    for (const auto& entry : routeStats) stats.push_back(entry.second);
+}
+
+// WiFiClient
+
+WiFiClient::WiFiClient(int fd) : socket(std::make_shared<Socket>()) {
+    socket->fd = fd;
+}
+
+WiFiClient::Socket::~Socket() {
+    if (fd >= 0) close(fd);
+}
+
+bool WiFiClient::connected() {
+    if (!*this) return false;
+    char c;
+    ssize_t result = recv(socket->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return result > 0 || (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
+
+int WiFiClient::available() {
+    int count = 0;
+    if (!*this || ioctl(socket->fd, FIONREAD, &count) < 0) return 0;
+    return count;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (!*this) return -1;
+    return recv(socket->fd, buffer, size, MSG_DONTWAIT);
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* data, size_t len) {
+    if (!*this) return 0;
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t result = send(socket->fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (result <= 0) break;
+        sent += result;
+    }
+    return sent;
+}
+
+void WiFiClient::stop() {
+    if (!*this) return;
+    close(socket->fd);
+    socket->fd = -1;
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+    int value = noDelay ? 1 : 0;
+    if (*this) setsockopt(socket->fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+void WiFiClient::setTimeout(uint32_t seconds) {
+    timeval timeout = {(time_t)seconds, 0};
+    if (*this) setsockopt(socket->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// WebServer
+
+static const char* statusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 426: return "Upgrade Required";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+static HTTPMethod parseMethod(const std::string& name) {
+    if (name == "GET") return HTTP_GET;
+    if (name == "HEAD") return HTTP_HEAD;
+    if (name == "POST") return HTTP_POST;
+    if (name == "PUT") return HTTP_PUT;
+    if (name == "PATCH") return HTTP_PATCH;
+    if (name == "DELETE") return HTTP_DELETE;
+    if (name == "OPTIONS") return HTTP_OPTIONS;
+    return HTTP_ANY;
+}
+
+static std::string urlDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '+') {
+            out += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size()) {
+            out += (char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+static bool waitReadable(int fd) {
+    pollfd entry = {fd, POLLIN, 0};
+    return poll(&entry, 1, REQUEST_TIMEOUT_MS) > 0;
+}
+
+void WebServer::begin() {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(listenPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenFd, 64) < 0) {
+        perror("Benchmark server");
+        exit(2);
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr*)&addr, &len);
+    listenPort = ntohs(addr.sin_port);
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    routes.push_back({uri.c_str(), method, handler});
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t count) {
+    collected.assign(headerKeys, headerKeys + count);
+}
+
+bool WebServer::readRequest(int fd) {
+    std::string data;
+    size_t headEnd;
+    char buffer[1024];
+    while ((headEnd = data.find("\r\n\r\n")) == std::string::npos) {
+        if (data.size() > MAX_REQUEST_HEAD || !waitReadable(fd)) return false;
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len <= 0) return false;
+        data.append(buffer, len);
+    }
+    
+    // Request line
+    size_t lineEnd = data.find("\r\n");
+    std::string line = data.substr(0, lineEnd);
+    size_t space1 = line.find(' ');
+    size_t space2 = line.find(' ', space1 + 1);
+    if (space1 == std::string::npos || space2 == std::string::npos) return false;
+    requestMethod = parseMethod(line.substr(0, space1));
+    std::string target = line.substr(space1 + 1, space2 - space1 - 1);
+    size_t query = target.find('?');
+    requestUri = target.substr(0, query);
+    
+    args.clear();
+    if (query != std::string::npos) {
+        std::string rest = target.substr(query + 1);
+        size_t pos = 0;
+        while (pos <= rest.size()) {
+            size_t amp = rest.find('&', pos);
+            std::string pair = rest.substr(pos, amp == std::string::npos ? std::string::npos : amp - pos);
+            size_t eq = pair.find('=');
+            if (!pair.empty()) {
+                args.push_back({urlDecode(pair.substr(0, eq)),
+                                eq == std::string::npos ? "" : urlDecode(pair.substr(eq + 1))});
+            }
+            if (amp == std::string::npos) break;
+            pos = amp + 1;
+        }
+    }
+    
+    // Headers; only collected ones are kept, like the ESP32 server
+    headers.clear();
+    size_t contentLen = 0;
+    size_t pos = lineEnd + 2;
+    while (pos < headEnd) {
+        size_t end = data.find("\r\n", pos);
+        std::string field = data.substr(pos, end - pos);
+        pos = end + 2;
+        size_t colon = field.find(':');
+        if (colon == std::string::npos) continue;
+        std::string name = field.substr(0, colon);
+        size_t start = field.find_first_not_of(' ', colon + 1);
+        std::string value = start == std::string::npos ? "" : field.substr(start);
+        if (strcasecmp(name.c_str(), "Content-Length") == 0) contentLen = strtoul(value.c_str(), nullptr, 10);
+        for (const std::string& key : collected) {
+            if (strcasecmp(key.c_str(), name.c_str()) == 0) headers.push_back({key, value});
+        }
+    }
+    
+    // Body; anything that is not a form arrives as the "plain" argument
+    std::string body = data.substr(headEnd + 4);
+    while (body.size() < contentLen) {
+        if (!waitReadable(fd)) return false;
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len <= 0) return false;
+        body.append(buffer, len);
+    }
+    if (contentLen > 0) args.push_back({"plain", body.substr(0, contentLen)});
+    return true;
+}
+
+void WebServer::handleClient() {
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+    
+    current = WiFiClient(fd);
+    currentFd = fd;
+    extraHeaders.clear();
+    contentLength = CONTENT_LENGTH_NOT_SET;
+    chunked = false;
+    headSent = false;
+    bytesSent = 0;
+    
+    if (!readRequest(fd)) {
+        finishRequest();
+        return;
+    }
+    
+    const Route* route = nullptr;
+    for (const Route& candidate : routes) {
+        if (candidate.uri == requestUri && (candidate.method == HTTP_ANY || candidate.method == requestMethod)) {
+            route = &candidate;
+            break;
+        }
+    }
+    
+    // Only the handler is measured, not the request parsing above
+    BenchHeapCounters before = benchThreadHeap();
+    int64_t start = esp_timer_get_time();
+    if (route != nullptr) {
+        route->handler();
+    } else {
+        std::string message = "Not found: " + requestUri;
+        send(404, "text/plain", String(message));
+    }
+    uint32_t elapsedUs = esp_timer_get_time() - start;
+    BenchHeapCounters after = benchThreadHeap();
+    
+    static const char* const METHOD_NAMES[] = {"ANY", "GET", "HEAD", "POST", "PUT", "PATCH", "DELETE", "OPTIONS"};
+    std::string key = std::string(METHOD_NAMES[requestMethod]) + " " + requestUri;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        BenchRouteStats& stats = routeStats[key];
+        stats.key = key;
+        stats.requests++;
+        stats.bytesSent += bytesSent;
+        stats.allocations += after.allocations - before.allocations;
+        if (stats.requests > 1) stats.steadyAllocations += after.allocations - before.allocations;
+        stats.allocatedBytes += after.bytes - before.bytes;
+        stats.handlerUs += elapsedUs;
+        if (elapsedUs > stats.handlerMaxUs) stats.handlerMaxUs = elapsedUs;
+    }
+    finishRequest();
+}
+
+void WebServer::finishRequest() {
+    // A handler that took over the socket keeps its own copy open
+    current = WiFiClient();
+    currentFd = -1;
+}
+
+String WebServer::arg(const String& name) {
+    for (const Field& field : args) {
+        if (field.name != name.c_str()) continue;
+        
+        // The ESP32 String keeps only about 10 characters inline, a longer
+        // value such as a request body is a heap copy there. std::string
+        // keeps 15, so reserve past that to make the same allocation here.
+        String value;
+        if (field.value.size() > 10) value.reserve(field.value.size() > 16 ? field.value.size() : 16);
+        value.concat(field.value.c_str());
+        return value;
+    }
+    return String();
+}
+
+bool WebServer::hasArg(const String& name) {
+    for (const Field& field : args) {
+        if (field.name == name.c_str()) return true;
+    }
+    return false;
+}
+
+String WebServer::header(const String& name) {
+    for (const Field& field : headers) {
+        if (strcasecmp(field.name.c_str(), name.c_str()) == 0) return String(field.value);
+    }
+    return String();
+}
+
+bool WebServer::hasHeader(const String& name) {
+    for (const Field& field : headers) {
+        if (strcasecmp(field.name.c_str(), name.c_str()) == 0) return true;
+    }
+    return false;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    std::string line = std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+    extraHeaders = first ? line + extraHeaders : extraHeaders + line;
+}
+
+void WebServer::writeRaw(const char* data, size_t len) {
+    if (currentFd < 0) return;
+    size_t sent = 0;
+    while (sent < len) {
+        ssize_t result = ::send(currentFd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (result <= 0) break;
+        sent += result;
+    }
+    bytesSent += sent;
+}
+
+void WebServer::writeHead(int code, const char* contentType, size_t len) {
+    char head[256];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n", code, statusText(code),
+                     contentType != nullptr ? contentType : "text/html");
+    writeRaw(head, n);
+    
+    chunked = len == CONTENT_LENGTH_UNKNOWN;
+    n = chunked ? snprintf(head, sizeof(head), "Transfer-Encoding: chunked\r\n")
+                : snprintf(head, sizeof(head), "Content-Length: %zu\r\n", len);
+    writeRaw(head, n);
+    writeRaw(extraHeaders.data(), extraHeaders.size());
+    writeRaw("Connection: close\r\n\r\n", 21);
+    headSent = true;
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    size_t len = contentLength != CONTENT_LENGTH_NOT_SET ? contentLength : content.length();
+    writeHead(code, contentType, len);
+    if (content.length() > 0) sendContent(content.c_str(), content.length());
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t len) {
+    writeHead(code, contentType, len);
+    writeRaw(content, len);
+}
+
+void WebServer::sendContent(const char* content, size_t len) {
+    if (!headSent) return;
+    if (!chunked) {
+        writeRaw(content, len);
+        return;
+    }
+    
+    // Zero length ends the chunked response
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", len);
+    writeRaw(size, n);
+    writeRaw(content, len);
+    writeRaw("\r\n", 2);
+}
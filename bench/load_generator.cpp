@@ -0,0 +1,143 @@
+#include "load_generator.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+#include <string>
+#include <thread>
+
+typedef std::chrono::steady_clock Clock;
+
+static uint32_t loadRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static std::string buildRequest(const LoadEndpoint& endpoint) {
+    std::string request = std::string(endpoint.method) + " " + endpoint.path + " HTTP/1.1\r\n"
+                          "Host: 127.0.0.1\r\nConnection: close\r\n";
+    if (endpoint.body != nullptr) {
+        request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(strlen(endpoint.body)) + "\r\n\r\n";
+        request += endpoint.body;
+    } else {
+        request += "\r\n";
+    }
+    return request;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+// One request on a fresh connection; returns the HTTP status or 0 on failure
+static int exchange(uint16_t port, const std::string& request, uint64_t& bytesReceived) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+    
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    
+    int status = 0;
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) == 0 && sendAll(fd, request)) {
+        // The server closes after the response, so read to EOF
+        char buffer[4096];
+        char head[16] = {};
+        size_t headLen = 0;
+        ssize_t n;
+        while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            if (headLen < sizeof(head) - 1) {
+                size_t take = std::min((size_t)n, sizeof(head) - 1 - headLen);
+                memcpy(head + headLen, buffer, take);
+                headLen += take;
+            }
+            bytesReceived += n;
+        }
+        if (n == 0 && strncmp(head, "HTTP/1.", 7) == 0 && headLen >= 12) status = atoi(head + 9);
+    }
+    close(fd);
+    return status;
+}
+
+void runLoad(const LoadConfig& config, const std::vector<LoadEndpoint>& endpoints,
+             std::vector<EndpointResult>& results, double& elapsedSeconds) {
+    std::vector<std::string> requests;
+    uint32_t totalWeight = 0;
+    for (const LoadEndpoint& endpoint : endpoints) {
+        requests.push_back(buildRequest(endpoint));
+        totalWeight += endpoint.weight;
+    }
+    
+    // Per-client results, merged at the end so the clients share nothing
+    std::vector<std::vector<EndpointResult>> perClient(config.clients, std::vector<EndpointResult>(endpoints.size()));
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + std::chrono::seconds(config.seconds);
+    
+    std::vector<std::thread> clients;
+    for (uint16_t c = 0; c < config.clients; c++) {
+        clients.emplace_back([&, c] {
+            uint32_t state = config.seed * 2654435761u + c + 1;
+            std::vector<EndpointResult>& mine = perClient[c];
+            
+            while (Clock::now() < end) {
+                uint32_t pick = loadRandom(state) % totalWeight;
+                size_t index = 0;
+                while (pick >= endpoints[index].weight) pick -= endpoints[index++].weight;
+                
+                EndpointResult& result = mine[index];
+                Clock::time_point sent = Clock::now();
+                int status = exchange(config.port, requests[index], result.bytesReceived);
+                uint32_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent).count();
+                
+                result.requests++;
+                if (status >= 100 && status < 600) {
+                    result.status[status / 100]++;
+                    result.latencyUs.push_back(latencyUs);
+                } else {
+                    result.failures++;
+                }
+                if (config.thinkMs > 0) std::this_thread::sleep_for(std::chrono::milliseconds(config.thinkMs));
+            }
+        });
+    }
+    for (std::thread& client : clients) client.join();
+    elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    results.assign(endpoints.size(), EndpointResult());
+    for (const std::vector<EndpointResult>& mine : perClient) {
+        for (size_t i = 0; i < endpoints.size(); i++) {
+            results[i].requests += mine[i].requests;
+            results[i].failures += mine[i].failures;
+            for (uint8_t s = 0; s < 6; s++) results[i].status[s] += mine[i].status[s];
+            results[i].bytesReceived += mine[i].bytesReceived;
+            results[i].latencyUs.insert(results[i].latencyUs.end(), mine[i].latencyUs.begin(), mine[i].latencyUs.end());
+        }
+    }
+}
+
+uint32_t latencyPercentile(std::vector<uint32_t>& latencyUs, uint8_t percentile) {
+    if (latencyUs.empty()) return 0;
+    std::sort(latencyUs.begin(), latencyUs.end());
+    size_t rank = (latencyUs.size() * percentile + 99) / 100;
+    return latencyUs[rank > 0 ? rank - 1 : 0];
+}
@@ -0,0 +1,43 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+// Closed-loop HTTP load: each client thread picks an endpoint by weight,
+// sends one request on a fresh connection (the firmware closes after every
+// response), reads the response to the end and goes again after the think
+// time. Latency is measured from connect to the last byte.
+
+struct LoadEndpoint {
+    const char* name;
+    const char* method;
+    const char* path;
+    const char* body;           // nullptr = none; sent as application/json
+    uint32_t weight;
+};
+
+struct LoadConfig {
+    uint16_t port = 0;
+    uint16_t clients = 4;
+    uint32_t seconds = 10;
+    uint32_t thinkMs = 0;
+    uint32_t seed = 1;
+};
+
+struct EndpointResult {
+    uint32_t requests = 0;
+    uint32_t failures = 0;          // Connect, send or receive failed
+    uint32_t status[6] = {};        // By first digit: [2] = 2xx ...
+    uint64_t bytesReceived = 0;
+    std::vector<uint32_t> latencyUs;
+};
+
+// One result per endpoint, in the order given
+void runLoad(const LoadConfig& config, const std::vector<LoadEndpoint>& endpoints,
+             std::vector<EndpointResult>& results, double& elapsedSeconds);
+
+// Nearest-rank percentile of `latencyUs`, which it sorts
+uint32_t latencyPercentile(std::vector<uint32_t>& latencyUs, uint8_t percentile);
+
+#endif // LOAD_GENERATOR_H
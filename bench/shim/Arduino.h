@@ -0,0 +1,135 @@
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino-ESP32 core the firmware uses,
+// so that src/main.cpp and its web handlers build natively for the HTTP
+// benchmark (bench/). Only what the firmware calls is here; time comes from
+// the host's monotonic clock and FreeRTOS tasks are host threads.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <string>
+
+#define LED_BUILTIN 2
+#define PROGMEM
+#define IRAM_ATTR
+#define PGM_P const char*
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+class String {
+public:
+    String(const char* text = "") : s(text != nullptr ? text : "") {}
+    String(const std::string& text) : s(text) {}
+    explicit String(int value) : s(std::to_string(value)) {}
+    explicit String(unsigned value) : s(std::to_string(value)) {}
+    explicit String(long value) : s(std::to_string(value)) {}
+    explicit String(unsigned long value) : s(std::to_string(value)) {}
+    explicit String(float value, unsigned char decimals = 2) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*f", decimals, value);
+        s = text;
+    }
+    
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+    bool concat(const char* text) { s += text; return true; }
+    long toInt() const { return atol(s.c_str()); }
+    bool equalsIgnoreCase(const String& other) const { return strcasecmp(s.c_str(), other.c_str()) == 0; }
+    char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    
+    String& operator+=(const String& other) { s += other.s; return *this; }
+    String& operator+=(const char* other) { s += other; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    bool operator==(const String& other) const { return s == other.s; }
+    bool operator==(const char* other) const { return s == other; }
+    bool operator!=(const String& other) const { return s != other.s; }
+    bool operator!=(const char* other) const { return s != other; }
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+
+private:
+    std::string s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t len);
+    size_t write(const char* data, size_t len) { return write((const uint8_t*)data, len); }
+    
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t println(const char* text = "") { return print(text) + print("\r\n"); }
+    size_t println(const String& text) { return println(text.c_str()); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Silent unless the benchmark runs with --verbose
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// Heap figures come from the benchmark's allocation hooks (bench_platform.h)
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFULL; }
+};
+
+extern EspClass ESP;
+
+bool psramFound();
+void* ps_malloc(size_t size);
+
+// Internal temperature sensor, a fixed die temperature on the host
+float temperatureRead();
+
+// FreeRTOS subset: tasks are detached host threads, one tick per millisecond
+// like the ESP32 default configuration
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+struct BenchTask;
+typedef BenchTask* TaskHandle_t;
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment);
+TickType_t xTaskGetTickCount();
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+#endif // BENCH_ARDUINO_H
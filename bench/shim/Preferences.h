@@ -0,0 +1,24 @@
+#ifndef BENCH_PREFERENCES_H
+#define BENCH_PREFERENCES_H
+
+#include <Arduino.h>
+
+// NVS stand-in, kept in memory for the run
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end() {}
+    
+    bool getBool(const char* key, bool defaultValue = false);
+    size_t putBool(const char* key, bool value);
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    size_t putUChar(const char* key, uint8_t value);
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t putString(const char* key, const char* value);
+
+private:
+    std::string path(const char* key) const;
+    std::string space;
+};
+
+#endif // BENCH_PREFERENCES_H
@@ -0,0 +1,93 @@
+#ifndef BENCH_WEBSERVER_H
+#define BENCH_WEBSERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+// Stand-in for the ESP32 WebServer over local TCP, for the HTTP benchmark.
+// It behaves like the 2.x core server the firmware is built against: one
+// connection per handleClient() call, read and answered in full by the
+// calling task, then closed. Status line and body go straight to the
+// socket; like on the ESP32, only sendHeader() and arg() allocate.
+// The port passed to the constructor is ignored; the benchmark listens on
+// the loopback port set with benchSetListenPort() (bench_platform.h).
+
+enum HTTPMethod {
+    HTTP_ANY,
+    HTTP_GET,
+    HTTP_HEAD,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_PATCH,
+    HTTP_DELETE,
+    HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+    
+    explicit WebServer(int port = 80) {}
+    
+    void begin();
+    void handleClient();
+    
+    void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void collectHeaders(const char* headerKeys[], const size_t count);
+    
+    String arg(const String& name);
+    bool hasArg(const String& name);
+    String header(const String& name);
+    bool hasHeader(const String& name);
+    WiFiClient client() { return current; }
+    HTTPMethod method() { return requestMethod; }
+    String uri() { return String(requestUri); }
+    
+    void send(int code, const char* contentType = nullptr, const String& content = String(""));
+    void send_P(int code, PGM_P contentType, PGM_P content, size_t len);
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void setContentLength(size_t len) { contentLength = len; }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t len);
+
+private:
+    struct Route {
+        std::string uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+    struct Field {
+        std::string name;
+        std::string value;
+    };
+    
+    bool readRequest(int fd);
+    void writeHead(int code, const char* contentType, size_t len);
+    void writeRaw(const char* data, size_t len);
+    void finishRequest();
+    
+    int listenFd = -1;
+    std::vector<Route> routes;
+    std::vector<std::string> collected;
+    
+    // Current request
+    WiFiClient current;
+    int currentFd = -1;
+    HTTPMethod requestMethod = HTTP_GET;
+    std::string requestUri;
+    std::vector<Field> args;
+    std::vector<Field> headers;
+    std::string extraHeaders;
+    size_t contentLength = CONTENT_LENGTH_NOT_SET;
+    bool chunked = false;
+    bool headSent = false;
+    size_t bytesSent = 0;
+};
+
+#endif // BENCH_WEBSERVER_H
@@ -0,0 +1,55 @@
+#ifndef BENCH_WIFI_H
+#define BENCH_WIFI_H
+
+#include <Arduino.h>
+#include <memory>
+
+// Host stand-in for the ESP32 WiFi library. WiFiClient wraps a TCP socket of
+// the benchmark server; like on the ESP32, copies share the socket and it is
+// closed when the last copy lets go, which is what lets /api/events keep a
+// request's client after the handler returns.
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : bytes{a, b, c, d} {}
+    uint8_t operator[](int index) const { return bytes[index]; }
+    String toString() const;
+
+private:
+    uint8_t bytes[4];
+};
+
+class WiFiClient : public Print {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd);
+    
+    bool connected();
+    int available();
+    int read(uint8_t* buffer, size_t size);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t len) override;
+    using Print::write;
+    void stop();
+    void setNoDelay(bool noDelay);
+    void setTimeout(uint32_t seconds);
+    explicit operator bool() const { return socket != nullptr && socket->fd >= 0; }
+
+private:
+    struct Socket {
+        int fd;
+        ~Socket();
+    };
+    std::shared_ptr<Socket> socket;
+};
+
+// Always an associated station
+class WiFiClass {
+public:
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    int RSSI() { return -55; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // BENCH_WIFI_H
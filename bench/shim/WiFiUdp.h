@@ -0,0 +1,20 @@
+#ifndef BENCH_WIFI_UDP_H
+#define BENCH_WIFI_UDP_H
+
+#include <WiFi.h>
+
+// Sync is off in the benchmark; the multicast socket never opens
+class WiFiUDP : public Print {
+public:
+    uint8_t beginMulticast(IPAddress group, uint16_t port) { return 0; }
+    int beginMulticastPacket() { return 0; }
+    int endPacket() { return 0; }
+    int parsePacket() { return 0; }
+    int read(uint8_t* buffer, size_t size) { return 0; }
+    size_t write(uint8_t c) override { return 0; }
+    size_t write(const uint8_t* data, size_t len) override { return 0; }
+    using Print::write;
+    void stop() {}
+};
+
+#endif // BENCH_WIFI_UDP_H
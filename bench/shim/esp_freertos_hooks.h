@@ -0,0 +1,13 @@
+#ifndef BENCH_ESP_FREERTOS_HOOKS_H
+#define BENCH_ESP_FREERTOS_HOOKS_H
+
+#include "esp_pm.h"
+
+// No tick interrupts to count in the benchmark; these only have to link
+typedef void (*esp_freertos_tick_cb_t)();
+
+inline esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t callback, int cpu) {
+    return ESP_OK;
+}
+
+#endif // BENCH_ESP_FREERTOS_HOOKS_H
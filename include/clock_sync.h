@@ -0,0 +1,122 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "shot_sequence.h"
+
+// Leader/follower synchronization between controllers.
+// The leader multicasts a beacon with its clock and the running session
+// (start time on the leader clock plus the sequence plan); followers
+// estimate the leader clock from the beacons and run the same session with
+// the start mapped onto their own millis(), so every rig fires at the same
+// deadlines. Followers multicast reports with their estimate back, which the
+// leader keeps per follower.
+// Packet format, clock estimation and the follower table are host-portable;
+// the simulator runs several nodes over loopback with the same code.
+//
+// Clocks are 64-bit microsecond counters (esp_timer on the ESP32) whose
+// value / 1000 is millis(). Offsets are leader minus local clock.
+
+const uint16_t SYNC_PORT = 4242;
+const uint8_t SYNC_GROUP[4] = {239, 255, 42, 42};
+const uint32_t SYNC_BEACON_MS = 1000;
+const uint32_t SYNC_REPORT_MS = 5000;
+const uint32_t SYNC_LOST_MS = 10000;        // Followers keep their last estimate after this
+const uint8_t SYNC_WINDOW = 16;             // Beacons kept for the estimate
+const uint8_t SYNC_MIN_SAMPLES = 4;
+const int64_t SYNC_STEP_US = 50000;         // Larger jumps mean the leader restarted
+const uint32_t SYNC_REANCHOR_MIN_MS = 2;    // Follower start moves below this or the jitter are noise
+const int32_t SYNC_MAX_SKEW_PPB = 100000;     // Crystals are within tens of ppm
+const uint8_t SYNC_MAX_FOLLOWERS = 8;
+const size_t SYNC_MAX_PACKET = 160;
+
+enum SyncMode : uint8_t {
+    SYNC_OFF = 0,
+    SYNC_LEADER = 1,
+    SYNC_FOLLOWER = 2
+};
+
+enum SyncPacketType : uint8_t {
+    SYNC_BEACON = 1,
+    SYNC_REPORT = 2
+};
+
+struct SyncPacket {
+    SyncPacketType type = SYNC_BEACON;
+    uint32_t nodeId = 0;
+    uint32_t seq = 0;
+    int64_t sentUs = 0;             // Sender clock at transmission
+    
+    // SYNC_BEACON
+    bool sessionRunning = false;
+    int64_t sessionStartUs = 0;     // Leader clock
+    SequencePlan plan;
+    
+    // SYNC_REPORT
+    uint32_t leaderId = 0;
+    int64_t offsetUs = 0;
+    uint32_t jitterUs = 0;
+    int32_t skewPpb = 0;
+    uint8_t samples = 0;
+    bool following = false;         // Running the leader's session
+    uint16_t currentShot = 0;
+};
+
+// Little-endian wire format; 0 if the buffer is too small
+size_t syncEncode(const SyncPacket& packet, uint8_t* buffer, size_t size);
+bool syncDecode(const uint8_t* data, size_t len, SyncPacket& packet);
+
+struct ClockSyncSample {
+    int64_t localUs;
+    int64_t offsetUs;               // Leader send time minus local receive time
+};
+
+// Follower estimate of the leader clock. Network delay only ever makes a
+// sample too small, so the estimate is the largest sample in the window
+// after removing the clock skew estimated over the window.
+struct ClockSync {
+    uint32_t leaderId = 0;
+    uint32_t lastSeq = 0;
+    ClockSyncSample samples[SYNC_WINDOW];
+    uint8_t count = 0;
+    uint8_t next = 0;
+    int64_t anchorUs = 0;           // Local time of the newest sample
+    int64_t offsetUs = 0;           // Estimate at anchorUs
+    int32_t skewPpb = 0;            // Leader rate minus local rate
+    uint32_t jitterUs = 0;          // Mean distance of the samples below the estimate
+    uint32_t resets = 0;
+};
+
+void clockSyncReset(ClockSync& sync, uint32_t leaderId);
+
+// One beacon, stamped with the local clock on receipt
+void clockSyncAddSample(ClockSync& sync, uint32_t leaderId, uint32_t seq, int64_t leaderUs, int64_t localUs);
+
+bool clockSyncReady(const ClockSync& sync);
+int64_t clockSyncOffsetAt(const ClockSync& sync, int64_t localUs);
+
+// Session start on the 64-bit clock for a millis() start time
+int64_t syncStartUs(int64_t nowUs, uint32_t startMs);
+
+// millis() start time on this node for a leader session start, with the
+// offset at `localNowUs`. Deadlines run on the local clock from there, so
+// the start has to be refreshed as the clocks drift apart.
+uint32_t syncLocalStartMs(const ClockSync& sync, int64_t leaderStartUs, int64_t localNowUs);
+
+// Leader view of its followers, filled from their reports
+struct SyncFollower {
+    uint32_t nodeId = 0;
+    uint32_t lastSeenMs = 0;
+    int64_t offsetUs = 0;
+    uint32_t jitterUs = 0;
+    int32_t skewPpb = 0;
+    uint8_t samples = 0;
+    bool following = false;
+    uint16_t currentShot = 0;
+};
+
+// Adds or refreshes the follower, replacing the longest silent one if full
+void syncFollowerUpdate(SyncFollower* table, uint8_t size, const SyncPacket& report, uint32_t nowMs);
+
+#endif // CLOCK_SYNC_H
@@ -0,0 +1,40 @@
+#ifndef HTML_WRITER_H
+#define HTML_WRITER_H
+
+#include <stddef.h>
+#include <stdarg.h>
+
+// Streaming text writer over a caller-provided fixed buffer.
+// Output is collected in the buffer and handed to the sink whenever it fills
+// up, so peak memory is the buffer size no matter how large the page gets.
+// printf() output longer than the whole buffer cannot be split and is cut
+// at the buffer size; such calls are counted. Use write() for long text.
+// No heap allocations; host-portable.
+
+typedef void (*HtmlSink)(const char* data, size_t len, void* context);
+
+class HtmlWriter {
+public:
+    HtmlWriter(char* buffer, size_t size, HtmlSink sink, void* context = nullptr);
+    
+    void print(const char* text);
+    void write(const char* data, size_t len);
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void flush();
+    
+    size_t bytesWritten() const { return total; }
+    size_t flushCount() const { return flushes; }
+    size_t truncationCount() const { return truncations; }
+    
+private:
+    char* buffer;
+    size_t size;
+    size_t used = 0;
+    size_t total = 0;
+    size_t flushes = 0;
+    size_t truncations = 0;
+    HtmlSink sink;
+    void* context;
+};
+
+#endif // HTML_WRITER_H
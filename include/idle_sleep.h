@@ -0,0 +1,58 @@
+#ifndef IDLE_SLEEP_H
+#define IDLE_SLEEP_H
+
+#include <stdint.h>
+
+// Automatic light sleep between session shots, for battery use in the field.
+// When the next shot is far enough away and nobody is using the web side,
+// the real-time task drops its power management lock and blocks until
+// shortly before the shot; with every task blocked, the FreeRTOS idle task
+// light-sleeps the chip (tickless idle) and WiFi wakes it for the DTIM
+// beacons of modem sleep. This needs CONFIG_PM_ENABLE and
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE, which the [env:esp32-field] build sets
+// in sdkconfig.defaults; the prebuilt core of [env:esp32] has no tickless
+// idle, so enabling it fails there.
+// The wait ends ahead of the deadline by a margin learned from the measured
+// wakeup latency, so shots still go out on time.
+// Planning and accounting are host-portable; the simulator drives them with
+// a virtual sleep clock.
+
+const uint32_t IDLE_SLEEP_MIN_MS = 100;         // Shorter waits stay in a task wait
+const uint32_t IDLE_SLEEP_MAX_MS = 3000;        // Longer gaps are planned again, the margin follows
+const uint32_t IDLE_WAKE_MARGIN_US = 2000;      // Initial and smallest wakeup margin
+const uint32_t IDLE_SLEEP_CLOCK_PPM = 1000;     // Allowance for RTC slow clock error
+const uint32_t IDLE_HOLD_AWAKE_MS = 3000;       // Stay awake this long after web activity
+
+// Typical supply current, awake with WiFi modem sleep and in light sleep,
+// used to estimate the average current from the measured time asleep
+const uint32_t IDLE_ACTIVE_CURRENT_UA = 45000;
+const uint32_t IDLE_SLEEP_CURRENT_UA = 1500;
+
+// The time asleep is measured: tickless idle steps the tick count over a
+// light sleep without taking tick interrupts, so the ticks that passed
+// without an interrupt were slept through (1 ms resolution)
+struct IdleSleepStats {
+    uint32_t sleeps = 0;            // Waits the chip light-slept in
+    uint64_t sleptUs = 0;
+    uint64_t sinceUs = 0;           // Clock time the statistics were reset at
+    uint32_t wakeLatencyUs = 0;     // Last sleep, measured minus requested length
+    uint32_t wakeLatencyMaxUs = 0;
+    uint32_t latencyPeakUs = 0;     // Slowly decaying maximum the margin follows
+    uint32_t marginUs = IDLE_WAKE_MARGIN_US;
+    uint32_t lateWakeups = 0;       // Woke after the deadline the sleep was planned for
+};
+
+// Sleep length for an event `untilEventMs` away, 0 if not worth sleeping
+uint32_t idleSleepPlanUs(const IdleSleepStats& stats, uint32_t untilEventMs);
+
+// Feeds back one wait that ran its full length: planned length, measured
+// length and the time that was left until the event when it was planned
+void idleSleepRecord(IdleSleepStats& stats, uint32_t requestedUs, uint32_t actualUs, uint32_t untilEventMs);
+
+// Adds the time a wait spent asleep, also for waits a command cut short
+void idleSleepAddAsleep(IdleSleepStats& stats, uint32_t asleepUs);
+
+// Estimated average current over `elapsedUs`, of which stats.sleptUs asleep
+uint32_t idleSleepAverageCurrentUa(const IdleSleepStats& stats, uint64_t elapsedUs);
+
+#endif // IDLE_SLEEP_H
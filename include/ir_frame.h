@@ -0,0 +1,126 @@
+#ifndef IR_FRAME_H
+#define IR_FRAME_H
+
+#include <stdint.h>
+
+// Precomputed IR pulse trains.
+// A train is a list of durations in microseconds, alternating mark (carrier on)
+// and space (carrier off), starting with a mark. The encoders are constexpr,
+// so camera profiles are built by the compiler and the transmitter only
+// replays them (see ir_profiles.h).
+// This file has no Arduino dependencies so it can be built on the host.
+
+const uint16_t IR_MAX_PULSES = 192;
+
+struct IrPulseTrain {
+    uint16_t carrierKhz = 0;
+    uint16_t count = 0;
+    uint32_t durations[IR_MAX_PULSES] = {};
+};
+
+// Sony SIRC timing (600 us base unit, 40 kHz carrier, frames repeat every 45 ms)
+const uint16_t SONY_CARRIER_KHZ = 40;
+const uint32_t SONY_UNIT_US = 600;
+const uint32_t SONY_HEADER_MARK_US = 4 * SONY_UNIT_US;
+const uint32_t SONY_ONE_MARK_US = 2 * SONY_UNIT_US;
+const uint32_t SONY_ZERO_MARK_US = SONY_UNIT_US;
+const uint32_t SONY_SPACE_US = SONY_UNIT_US;
+const uint32_t SONY_REPEAT_PERIOD_US = 45000;
+
+constexpr bool irAppendPulse(IrPulseTrain& train, uint32_t durationUs) {
+    if (train.count >= IR_MAX_PULSES) return false;
+    train.durations[train.count++] = durationUs;
+    return true;
+}
+
+// Total on-air duration of a train in microseconds
+constexpr uint32_t irTrainDurationUs(const IrPulseTrain& train) {
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < train.count; i++) {
+        total += train.durations[i];
+    }
+    return total;
+}
+
+// Encode a Sony SIRC command the same way IRremote's sendSony() emits it:
+// 7 command bits followed by (bits - 7) address bits, LSB first, sent
+// repeats + 1 times. Returns false if the train does not fit.
+constexpr bool irEncodeSony(IrPulseTrain& train, uint16_t address, uint8_t command, uint8_t bits, uint8_t repeats) {
+    train.carrierKhz = SONY_CARRIER_KHZ;
+    train.count = 0;
+    
+    if (bits != 12 && bits != 15 && bits != 20) return false;
+    
+    uint32_t data = ((uint32_t)address << 7) | (command & 0x7F);
+    
+    for (uint8_t frame = 0; frame <= repeats; frame++) {
+        uint32_t frameUs = 0;
+        
+        // Header
+        if (!irAppendPulse(train, SONY_HEADER_MARK_US)) return false;
+        if (!irAppendPulse(train, SONY_SPACE_US)) return false;
+        frameUs += SONY_HEADER_MARK_US + SONY_SPACE_US;
+        
+        // Data, LSB first, pulse width coded
+        for (uint8_t bit = 0; bit < bits; bit++) {
+            uint32_t mark = (data >> bit) & 1 ? SONY_ONE_MARK_US : SONY_ZERO_MARK_US;
+            if (!irAppendPulse(train, mark)) return false;
+            frameUs += mark;
+            
+            bool lastPulse = frame == repeats && bit == bits - 1;
+            if (lastPulse) break;
+            
+            // The space after the last bit stretches to the next frame start
+            uint32_t space = SONY_SPACE_US;
+            if (bit == bits - 1) {
+                space = SONY_REPEAT_PERIOD_US - frameUs;
+            }
+            if (!irAppendPulse(train, space)) return false;
+            frameUs += space;
+        }
+    }
+    return true;
+}
+
+// Pulse distance coding (NEC style): header, then per bit a fixed mark and
+// a short or long space, MSB first, closed by a final mark
+constexpr bool irEncodePulseDistance(IrPulseTrain& train, uint16_t carrierKhz,
+                                     uint32_t headerMarkUs, uint32_t headerSpaceUs,
+                                     uint32_t bitMarkUs, uint32_t zeroSpaceUs, uint32_t oneSpaceUs,
+                                     uint32_t data, uint8_t bits) {
+    train.carrierKhz = carrierKhz;
+    train.count = 0;
+    
+    if (!irAppendPulse(train, headerMarkUs)) return false;
+    if (!irAppendPulse(train, headerSpaceUs)) return false;
+    for (uint8_t bit = bits; bit-- > 0;) {
+        if (!irAppendPulse(train, bitMarkUs)) return false;
+        if (!irAppendPulse(train, (data >> bit) & 1 ? oneSpaceUs : zeroSpaceUs)) return false;
+    }
+    return irAppendPulse(train, bitMarkUs);
+}
+
+// Fixed mark/space pattern (odd count, ends with a mark), sent `frames`
+// times with frame starts `periodUs` apart
+constexpr bool irEncodeFrames(IrPulseTrain& train, uint16_t carrierKhz,
+                              const uint32_t* pattern, uint16_t length, uint8_t frames, uint32_t periodUs) {
+    train.carrierKhz = carrierKhz;
+    train.count = 0;
+    if (length % 2 == 0 || frames == 0) return false;
+    
+    uint32_t frameUs = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        frameUs += pattern[i];
+    }
+    if (frames > 1 && periodUs <= frameUs) return false;
+    
+    for (uint8_t frame = 0; frame < frames; frame++) {
+        if (frame > 0 && !irAppendPulse(train, periodUs - frameUs)) return false;
+        for (uint16_t i = 0; i < length; i++) {
+            if (!irAppendPulse(train, pattern[i])) return false;
+        }
+    }
+    return true;
+}
+
+#endif // IR_FRAME_H
@@ -0,0 +1,132 @@
+#ifndef IR_PROFILES_H
+#define IR_PROFILES_H
+
+#include <stdint.h>
+#include "ir_frame.h"
+
+// Camera IR profiles.
+// Every profile's shutter pulse train is encoded by the compiler through a
+// specialization of IrProfileTrain and lives in flash; switching profiles
+// only points the transmitter at another table. Reference timings are
+// checked with static_assert in ir_profiles.cpp.
+
+enum IrProfileId : uint8_t {
+    IR_PROFILE_SONY = 0,        // SIRC 20 bit shutter (NEX / Alpha, RMT-DSLR1)
+    IR_PROFILE_SONY_2S,         // SIRC 20 bit, 2 s self-timer
+    IR_PROFILE_CANON,           // RC-1 / RC-6 immediate
+    IR_PROFILE_CANON_2S,        // RC-1 / RC-6 with 2 s delay
+    IR_PROFILE_NIKON,           // ML-L3
+    IR_PROFILE_PENTAX,          // F / O-RC1
+    IR_PROFILE_OLYMPUS,         // RM-1
+    IR_PROFILE_COUNT
+};
+
+const IrProfileId IR_PROFILE_DEFAULT = IR_PROFILE_SONY;
+
+// Sony SIRC shutter command
+const uint16_t SONY_ADDRESS = 0x1E3A;
+const uint8_t SONY_COMMAND = 0x2D;
+const uint8_t SONY_COMMAND_2S = 0x37;
+const uint8_t SONY_BITS = 20;
+const uint8_t SONY_REPEATS = 3;
+
+// Canon: two bursts of 16 carrier cycles, the gap selects the mode
+const uint16_t CANON_CARRIER_KHZ = 33;
+const uint32_t CANON_BURST_US = 485;
+const uint32_t CANON_GAP_US = 7330;
+const uint32_t CANON_GAP_2S_US = 5360;
+
+// Nikon: fixed pattern, sent twice
+const uint16_t NIKON_CARRIER_KHZ = 38;
+const uint32_t NIKON_PATTERN_US[] = {2000, 27830, 390, 1580, 410, 3580, 400};
+const uint32_t NIKON_REPEAT_PERIOD_US = 63200;
+
+// Pentax: long header, then seven 1 ms marks
+const uint16_t PENTAX_CARRIER_KHZ = 38;
+const uint32_t PENTAX_PATTERN_US[] = {13000, 3000, 1000, 1000, 1000, 1000, 1000, 1000, 1000,
+                                      1000, 1000, 1000, 1000, 1000, 1000};
+
+// Olympus: NEC style 32 bit code
+const uint16_t OLYMPUS_CARRIER_KHZ = 40;
+const uint32_t OLYMPUS_SHUTTER_CODE = 0x61DC807F;
+
+constexpr IrPulseTrain irSonyTrain(uint8_t command) {
+    IrPulseTrain train;
+    if (!irEncodeSony(train, SONY_ADDRESS, command, SONY_BITS, SONY_REPEATS)) train.count = 0;
+    return train;
+}
+
+constexpr IrPulseTrain irCanonTrain(uint32_t gapUs) {
+    const uint32_t pattern[] = {CANON_BURST_US, gapUs, CANON_BURST_US};
+    IrPulseTrain train;
+    if (!irEncodeFrames(train, CANON_CARRIER_KHZ, pattern, 3, 1, 0)) train.count = 0;
+    return train;
+}
+
+constexpr IrPulseTrain irPatternTrain(uint16_t carrierKhz, const uint32_t* pattern, uint16_t length,
+                                      uint8_t frames, uint32_t periodUs) {
+    IrPulseTrain train;
+    if (!irEncodeFrames(train, carrierKhz, pattern, length, frames, periodUs)) train.count = 0;
+    return train;
+}
+
+constexpr IrPulseTrain irOlympusTrain() {
+    IrPulseTrain train;
+    if (!irEncodePulseDistance(train, OLYMPUS_CARRIER_KHZ, 8972, 4384, 600, 488, 1600, OLYMPUS_SHUTTER_CODE, 32)) {
+        train.count = 0;
+    }
+    return train;
+}
+
+// Compile-time pulse train of each profile
+template <IrProfileId P>
+struct IrProfileTrain;
+
+template <>
+struct IrProfileTrain<IR_PROFILE_SONY> {
+    static constexpr IrPulseTrain train = irSonyTrain(SONY_COMMAND);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_SONY_2S> {
+    static constexpr IrPulseTrain train = irSonyTrain(SONY_COMMAND_2S);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_CANON> {
+    static constexpr IrPulseTrain train = irCanonTrain(CANON_GAP_US);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_CANON_2S> {
+    static constexpr IrPulseTrain train = irCanonTrain(CANON_GAP_2S_US);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_NIKON> {
+    static constexpr IrPulseTrain train = irPatternTrain(NIKON_CARRIER_KHZ, NIKON_PATTERN_US, 7, 2,
+                                                         NIKON_REPEAT_PERIOD_US);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_PENTAX> {
+    static constexpr IrPulseTrain train = irPatternTrain(PENTAX_CARRIER_KHZ, PENTAX_PATTERN_US, 15, 1, 0);
+};
+
+template <>
+struct IrProfileTrain<IR_PROFILE_OLYMPUS> {
+    static constexpr IrPulseTrain train = irOlympusTrain();
+};
+
+struct IrProfile {
+    const char* key;            // API name
+    const char* name;
+    const IrPulseTrain* train;
+};
+
+extern const IrProfile IR_PROFILES[IR_PROFILE_COUNT];
+
+// Profile by API name; false if unknown
+bool irProfileFind(const char* key, IrProfileId& id);
+
+#endif // IR_PROFILES_H
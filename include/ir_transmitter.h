@@ -0,0 +1,16 @@
+#ifndef IR_TRANSMITTER_H
+#define IR_TRANSMITTER_H
+
+#include "ir_frame.h"
+
+// IR transmission through the ESP32 RMT peripheral.
+// A pulse train is converted to RMT items once by irTransmitterLoad();
+// irTransmitterSend() only hands the cached items to the peripheral and
+// returns immediately while the hardware modulates the carrier.
+
+bool irTransmitterBegin(uint8_t pin);
+bool irTransmitterLoad(const IrPulseTrain& train);
+bool irTransmitterSend();   // false if not loaded or still transmitting
+bool irTransmitterBusy();
+
+#endif // IR_TRANSMITTER_H
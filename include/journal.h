@@ -0,0 +1,55 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Session journal record format and recovery.
+// The journal is a ring of fixed-size records; a record's slot in the ring
+// is its sequence number modulo the capacity. Each record carries a CRC so
+// torn or corrupted writes are detected and skipped on replay.
+// Host-portable: no file system access here, see session_journal.cpp.
+
+enum JournalType : uint8_t {
+    JOURNAL_SESSION_START = 1,
+    JOURNAL_CHECKPOINT = 2,     // Repeats the session config so it survives ring wrap
+    JOURNAL_SHOT = 3,
+    JOURNAL_SESSION_END = 4
+};
+
+struct JournalRecord {
+    uint32_t sequence;          // 0 = never written
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t shot;              // JOURNAL_SHOT: slot index; others: shots done so far
+    int64_t startEpochMs;       // Wall-clock time of the session start
+    uint32_t sessionId;         // Sequence number of the session's start record
+    uint32_t intervalMs;
+    uint16_t minutes;
+    uint16_t totalShots;
+    uint32_t crc;               // CRC-32 over all preceding bytes
+};
+
+static_assert(sizeof(JournalRecord) == 32, "Journal records must stay 32 bytes");
+
+struct JournalRecovery {
+    uint32_t nextSequence = 1;  // Continue writing here
+    uint32_t validRecords = 0;
+    uint32_t skippedRecords = 0;    // Written but torn or out of place
+    bool sessionActive = false;     // Started and never ended
+    uint32_t sessionId = 0;
+    int64_t startEpochMs = 0;
+    uint32_t intervalMs = 0;
+    uint16_t minutes = 0;
+    uint16_t totalShots = 0;
+    uint16_t nextShot = 0;          // First slot not recorded as taken
+};
+
+uint32_t journalCrc32(const uint8_t* data, size_t len);
+void journalSeal(JournalRecord& record);
+bool journalRecordValid(const JournalRecord& record);
+
+// Replays the valid records of a ring of `capacity` in sequence order
+JournalRecovery journalRecover(const JournalRecord* records, uint32_t capacity);
+
+#endif // JOURNAL_H
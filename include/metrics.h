@@ -0,0 +1,81 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+// Hot-path instrumentation, served as Prometheus text at /api/metrics.
+// Sections are timed with micros(), the esp_timer clock, into log2
+// microsecond histograms; the cycle counter would follow the CPU clock that
+// power management scales between 80 and 240 MHz. Every histogram and counter has a single writer task and is
+// updated with relaxed atomics: no locks, no allocations.
+// Build without -D ENABLE_METRICS and all of it compiles away.
+
+enum MetricTimer : uint8_t {
+    METRIC_HANDLE_CLIENT = 0,
+    METRIC_HTTP_ROOT,
+    METRIC_HTTP_STATUS,
+    METRIC_HTTP_EVENTS,
+    METRIC_HTTP_START,
+    METRIC_HTTP_STOP,
+    METRIC_HTTP_SHOT,
+    METRIC_HTTP_BURST,
+    METRIC_HTTP_SYSTEM,
+    METRIC_HTTP_METRICS,
+    METRIC_HTTP_SHOTS,
+    METRIC_HTTP_IR,
+    METRIC_HTTP_POWER,
+    METRIC_HTTP_SYNC,
+    METRIC_HTTP_TEMPERATURE,
+    METRIC_HTTP_SCHEDULE,
+    METRIC_HTTP_TRIGGER,
+    METRIC_TRIGGER_FRAME,
+    METRIC_SESSION_POLL,
+    METRIC_IR_SEND,
+    METRIC_TIMER_COUNT
+};
+
+enum MetricCounter : uint8_t {
+    METRIC_SHOTS_SENT = 0,
+    METRIC_SHOTS_LATE,
+    METRIC_IR_BUSY,
+    METRIC_HTML_TRUNCATED,      // Pages with a printf() cut at the chunk buffer
+    METRIC_COUNTER_COUNT
+};
+
+// Session shots at least this late count as late
+const uint32_t LATE_SHOT_THRESHOLD_MS = 1;
+
+#ifdef ENABLE_METRICS
+
+#include <Arduino.h>
+
+class HtmlWriter;
+
+void metricsRecordUs(MetricTimer timer, uint32_t us);
+void metricsCount(MetricCounter counter);
+void metricsWritePrometheus(HtmlWriter& out);
+
+// Times the enclosing scope
+class MetricScope {
+public:
+    explicit MetricScope(MetricTimer timer) : timer(timer), start(micros()) {}
+    ~MetricScope() { metricsRecordUs(timer, micros() - start); }
+    
+private:
+    MetricTimer timer;
+    uint32_t start;
+};
+
+#define METRIC_CONCAT_(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_(a, b)
+#define METRIC_TIME_SCOPE(timer) MetricScope METRIC_CONCAT(metricScope, __LINE__)(timer)
+#define METRIC_COUNT(counter) metricsCount(counter)
+
+#else
+
+#define METRIC_TIME_SCOPE(timer) do {} while (0)
+#define METRIC_COUNT(counter) do {} while (0)
+
+#endif // ENABLE_METRICS
+
+#endif // METRICS_H
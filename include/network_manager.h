@@ -0,0 +1,33 @@
+#ifndef NETWORK_MANAGER_H
+#define NETWORK_MANAGER_H
+
+#include <stdint.h>
+
+// Non-blocking WiFi and SNTP bring-up.
+// networkBegin() only starts the station connect and returns; WiFi events
+// and networkUpdate() (called from the network task) then drive the
+// connect / access point fallback / SNTP state machine. The web server and
+// shot task are usable while this is still in progress.
+
+enum NetworkState : uint8_t {
+    NET_CONNECTING = 0,
+    NET_STATION = 1,
+    NET_ACCESS_POINT = 2
+};
+
+struct BootTiming {
+    uint32_t webReadyMs = 0;        // Web server listening
+    uint32_t firstRequestMs = 0;    // First HTTP request handled
+    uint32_t networkReadyMs = 0;    // Got an IP or AP is up
+    uint32_t timeSyncMs = 0;        // First SNTP sync
+};
+
+extern BootTiming bootTiming;
+
+void networkBegin();
+void networkUpdate();
+
+NetworkState networkState();
+bool networkTimeSynced();
+
+#endif // NETWORK_MANAGER_H
@@ -0,0 +1,40 @@
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// Per-request scratch memory for the web handlers.
+// JSON documents, request bodies and serialized responses are bumped out of
+// one static buffer that is reset after every handled request, so the
+// handlers' own work never allocates from the heap. What still does is the
+// WebServer library: the request line, headers, and the String each
+// server.arg() returns, one heap copy per request for a body. Those are
+// freed before the next request. `pio run -e bench` checks this with
+// --check-allocs. Network task only.
+
+const size_t REQUEST_ARENA_SIZE = 4096;
+const size_t MAX_REQUEST_BODY = 1024;
+
+// 4 byte aligned block, nullptr when the arena is exhausted
+void* requestArenaAllocate(size_t size);
+void requestArenaReset();
+
+// Copy of `len` bytes plus terminator, nullptr if it does not fit
+char* requestArenaCopy(const char* data, size_t len);
+
+size_t requestArenaHighWater();
+uint32_t requestArenaFailures();
+
+// ArduinoJson allocator on top of the arena. Freeing is a no-op and memory
+// never moves; ArduinoJson only reallocates to shrink.
+struct ArenaAllocator {
+    void* allocate(size_t size) { return requestArenaAllocate(size); }
+    void deallocate(void* pointer) {}
+    void* reallocate(void* pointer, size_t size) { return pointer; }
+};
+
+typedef BasicJsonDocument<ArenaAllocator> ArenaJsonDocument;
+
+#endif // REQUEST_ARENA_H
@@ -0,0 +1,49 @@
+#ifndef RT_TASK_H
+#define RT_TASK_H
+
+#include "idle_sleep.h"
+#include "session.h"
+
+// Real-time shot task.
+// Session scheduling and IR transmission run in a high-priority FreeRTOS
+// task pinned to core 1, away from WiFi and the web server on core 0.
+// The web side submits commands through a lock-free SPSC ring and reads
+// status from a seqlock-protected snapshot; it never touches session state.
+
+const uint8_t RT_TASK_CORE = 1;
+const uint8_t RT_TASK_PRIORITY = 10;
+const uint32_t RT_TASK_STACK = 4096;
+const uint32_t RT_COMMAND_QUEUE_SIZE = 16;
+const uint32_t RT_MAX_SLEEP_MS = 1000;
+const uint32_t RT_IR_POLL_MS = 20;         // Frame end poll while light sleep is on
+
+bool rtTaskStart();
+
+// Only call from the network task (single producer)
+bool rtSubmit(const ControlCommand& command);
+
+// Queues a manual shot job under a fresh id; 0 if the command ring is full.
+// Network task only, like rtSubmit.
+uint32_t rtSubmitShotJob(uint16_t count, uint32_t spacingMs);
+
+void rtReadStatus(StatusSnapshot& snapshot);
+
+// Increments on every published snapshot
+uint32_t rtStatusVersion();
+
+// Light sleep between session shots (idle_sleep.h), off until enabled.
+// Returns whether it is on; false if the core cannot light-sleep.
+bool rtSetIdleSleep(bool enabled);
+bool rtIdleSleepEnabled();
+
+// True while the shot task lets the chip light-sleep; the network task
+// then polls slowly so the idle task gets long enough gaps
+bool rtLightSleepPermitted();
+
+// Keeps the chip out of light sleep for `ms`, called on web activity.
+// Network task only.
+void rtHoldAwake(uint32_t ms);
+
+void rtReadIdleSleepStats(IdleSleepStats& stats);
+
+#endif // RT_TASK_H
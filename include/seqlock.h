@@ -0,0 +1,46 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// Sequence lock for publishing a snapshot from one writer to many readers.
+// The writer never waits; readers retry while a write is in progress.
+// T must be trivially copyable.
+
+template <typename T>
+class SeqLock {
+public:
+    void write(const T& value) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        memcpy(&data, &value, sizeof(T));
+        
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+    
+    void read(T& out) const {
+        uint32_t before;
+        uint32_t after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            memcpy(&out, &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+    }
+    
+    // Number of completed writes, cheap change detection for readers
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) >> 1;
+    }
+    
+private:
+    T data;
+    std::atomic<uint32_t> sequence{0};
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,93 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdint.h>
+#include "ir_profiles.h"
+#include "shot_scheduler.h"
+#include "shot_sequence.h"
+
+// Session and manual shot logic driven by the real-time task.
+// Everything here takes the current millis() value as a parameter and only
+// talks to the hardware through ir_transmitter.h, so it has no Arduino
+// dependencies. Other threads interact through ControlCommand and read
+// StatusSnapshot copies.
+
+// Session states
+enum SessionState {
+    STATE_IDLE = 0,
+    STATE_RUNNING = 1,
+    STATE_PAUSED = 2,
+    STATE_COMPLETED = 3
+};
+
+// Session management
+struct SessionData {
+    SessionState state = STATE_IDLE;
+    uint16_t totalMinutes = 0;
+    uint16_t totalShots = 0;
+    uint16_t currentShot = 0;
+    unsigned long sessionStartTime = 0;
+    unsigned long nextShotTime = 0;
+    uint32_t intervalMs = 60000;        // Gap between the current and the next shot
+    uint32_t durationMs = 0;            // Planned length from session start
+    uint32_t sessionNumber = 0;         // Counts started sessions; moving the start keeps it
+};
+
+// Requests from the web side to the real-time task
+enum CommandType : uint8_t {
+    CMD_START_SESSION = 0,
+    CMD_STOP_SESSION = 1,
+    CMD_SHOT_JOB = 2,
+    CMD_RESUME_SESSION = 3,     // Continue a journaled session after a reset
+    CMD_SET_IR_PROFILE = 4,
+    CMD_SYNC_SESSION = 5        // Follow a leader's session (clock_sync.h)
+};
+
+struct ControlCommand {
+    CommandType type = CMD_STOP_SESSION;
+    SequencePlan plan;          // CMD_START_SESSION, CMD_RESUME_SESSION, CMD_SYNC_SESSION
+    uint16_t count = 0;         // CMD_SHOT_JOB
+    uint32_t spacingMs = 0;     // CMD_SHOT_JOB
+    uint32_t jobId = 0;         // CMD_SHOT_JOB
+    uint32_t startTime = 0;     // CMD_RESUME_SESSION, CMD_SYNC_SESSION; millis() domain, may lie in the past
+    uint16_t nextShot = 0;      // CMD_RESUME_SESSION
+    IrProfileId irProfile = IR_PROFILE_DEFAULT;     // CMD_SET_IR_PROFILE
+};
+
+// Everything the web side may show, published after every change
+struct StatusSnapshot {
+    SessionData session;
+    LatenessStats lateness;
+    uint8_t jobsPending = 0;
+    uint32_t lastJobId = 0;         // Job of the most recent manual shot
+    uint32_t jobShotsFired = 0;
+    uint32_t jobsRejected = 0;      // Job queue was full
+    IrProfileId irProfile = IR_PROFILE_DEFAULT;     // Camera profile on air
+};
+
+const uint32_t SESSION_START_DELAY_MS = 5000; // First shot after session start
+const uint32_t IR_PROFILE_RETRY_MS = 10;      // Poll period while a profile change waits for the sender
+
+// Loads the camera profile into the transmitter; call once the transmitter
+// is initialized. Profile changes later go through CMD_SET_IR_PROFILE.
+bool sessionBegin(IrProfileId profile);
+
+void sessionApplyCommand(const ControlCommand& command, uint32_t now);
+
+// Fire due session and job shots; true if the status changed
+bool sessionPoll(uint32_t now);
+
+// Deadline of session shot `slot`; real-time task and simulator only
+uint32_t sessionShotDeadline(uint16_t slot);
+
+// Milliseconds until the next session or job deadline, capped at maxWaitMs
+uint32_t sessionTimeToNextEvent(uint32_t now, uint32_t maxWaitMs);
+
+void sessionFillSnapshot(StatusSnapshot& snapshot);
+
+// Classic fixed-interval session of `minutes`
+uint16_t calculateTotalShots(uint16_t minutes);
+uint32_t calculateIntervalMs();
+void sessionPlanForMinutes(SequencePlan& plan, uint16_t minutes);
+
+#endif // SESSION_H
@@ -0,0 +1,34 @@
+#ifndef SESSION_JOURNAL_H
+#define SESSION_JOURNAL_H
+
+#include "journal.h"
+#include "session.h"
+
+// Crash-safe session journal on LittleFS.
+// Session start, periodic config checkpoints, shots and session end are
+// appended as 32 byte records to a preallocated ring file. Records are
+// collected in RAM and written in batches from the network task, so flash
+// latency never reaches the shot task and every write is bounded to one
+// batch. After a reset the ring is replayed to resume the session.
+
+const char* const JOURNAL_PATH = "/journal.bin";
+const char* const JOURNAL_PLAN_PATH = "/session_plan.bin";   // Sequence of the last started session
+const uint32_t JOURNAL_CAPACITY = 512;          // 16 KB ring file
+const uint8_t JOURNAL_BATCH_RECORDS = 8;        // Records per flash write
+const uint32_t JOURNAL_FLUSH_MS = 30000;        // Max age of buffered shot records
+const uint32_t JOURNAL_CHECKPOINT_EVERY = 64;   // Records between config checkpoints
+
+// Mounts the file system, preallocates the ring and replays it
+bool sessionJournalBegin(JournalRecovery& recovery);
+
+// The sequence to resume is stored next to the ring, records only refer to it
+bool sessionJournalSavePlan(const SequencePlan& plan);
+bool sessionJournalLoadPlan(SequencePlan& plan);
+
+// Journal whatever changed between two status snapshots
+void sessionJournalOnStatus(const StatusSnapshot& previous, const StatusSnapshot& current);
+
+// Flushes buffered records once they are too old
+void sessionJournalMaintain();
+
+#endif // SESSION_JOURNAL_H
@@ -0,0 +1,72 @@
+#ifndef SESSION_SCHEDULE_H
+#define SESSION_SCHEDULE_H
+
+#include "session.h"
+#include "timer_wheel.h"
+
+// Session starts, stops and shot jobs at absolute wall-clock times.
+// Entries sit in a timer wheel (timer_wheel.h) in the millis() domain,
+// kept 64 bits wide so it does not wrap, mapped from the wall clock with
+// the offset between the two clocks. The network task advances the wheel
+// on every pass and hands due entries to the real-time task as ordinary
+// commands. When an SNTP sync or a restore steps the wall clock, every
+// entry is filed again under the new offset and keeps its wall-clock time.
+// Entries are kept in RAM and do not survive a reset.
+
+const uint16_t SCHEDULE_CAPACITY = 256;
+const uint8_t SCHEDULE_PLAN_CAPACITY = 16;                  // Sequences of pending starts
+const int64_t SCHEDULE_MAX_AHEAD_MS = 30LL * 24 * 3600000;
+const int64_t SCHEDULE_STEP_TOLERANCE_MS = 5;               // Smaller offset changes are not steps
+const uint32_t SCHEDULE_LATE_LIMIT_MS = 60000;              // Later entries are dropped as missed
+
+struct ScheduleEntry {
+    uint32_t id = 0;                // 0 while the slot is free
+    CommandType type = CMD_START_SESSION;   // CMD_START_SESSION, CMD_STOP_SESSION or CMD_SHOT_JOB
+    uint8_t plan = 0;               // CMD_START_SESSION: sequence slot
+    uint16_t count = 0;             // CMD_SHOT_JOB
+    uint32_t spacingMs = 0;         // CMD_SHOT_JOB
+    int64_t epochMs = 0;            // Wall-clock time; for a start, that of the first shot
+};
+
+struct ScheduleStats {
+    uint16_t pending = 0;
+    uint32_t fired = 0;
+    uint32_t missed = 0;            // Due more than SCHEDULE_LATE_LIMIT_MS ago, e.g. after a clock step
+    uint32_t skipped = 0;           // Start while a session ran or while following, or a full command queue
+    uint32_t steps = 0;             // Wall-clock steps that refiled the wheel
+    int64_t lastStepMs = 0;
+    uint32_t cascaded = 0;
+};
+
+// Call once the wall clock is restored
+void scheduleBegin();
+
+// Queues `command` (CMD_START_SESSION with a validated plan, CMD_STOP_SESSION
+// or CMD_SHOT_JOB) for `epochMs`; returns an error message or nullptr and
+// the new entry's id
+const char* scheduleAdd(const ControlCommand& command, int64_t epochMs, uint32_t& id);
+
+bool scheduleCancel(uint32_t id);
+
+// Follows clock steps and submits due entries; network task, every pass
+void scheduleUpdate(const StatusSnapshot& status);
+
+// Time until the next entry may become due, at most `maxMs`. Can be early by
+// part of a wheel slot, never late; enough to keep the chip out of light sleep.
+uint32_t scheduleTimeToNext(uint32_t maxMs);
+
+// Indices of the pending entries, earliest first; returns their number
+uint16_t scheduleList(uint16_t* order, uint16_t capacity);
+
+const ScheduleEntry& scheduleEntry(uint16_t index);
+
+void scheduleReadStats(ScheduleStats& stats);
+
+// "start", "stop" or "shot"
+const char* scheduleActionName(CommandType type);
+
+// "HH:MM[:SS]", the next such local time after `afterEpochMs`, or
+// "YYYY-MM-DDTHH:MM[:SS]" in local time (TIMEZONE)
+bool scheduleParseTime(const char* text, int64_t afterEpochMs, int64_t& epochMs);
+
+#endif // SESSION_SCHEDULE_H
@@ -0,0 +1,37 @@
+#ifndef SHOT_JOBS_H
+#define SHOT_JOBS_H
+
+#include <stdint.h>
+
+// Queued manual shot jobs (single shots and bursts).
+// HTTP handlers only submit a job and return; the real-time task fires job
+// shots on absolute deadlines (start + n * spacing) next to a running session.
+
+const uint8_t MAX_SHOT_JOBS = 8;
+const uint16_t MAX_BURST_COUNT = 100;
+const uint32_t MIN_BURST_SPACING_MS = 200;   // One Sony frame set takes ~170 ms on air
+const uint32_t MAX_BURST_SPACING_MS = 60000;
+
+struct ShotJob {
+    uint32_t id = 0;            // 0 = free slot
+    uint16_t count = 0;
+    uint16_t fired = 0;
+    uint32_t spacingMs = 0;
+    uint32_t startTime = 0;
+};
+
+// Job ids are assigned by the submitter; false if the queue is full
+bool shotJobsAdd(uint32_t id, uint16_t count, uint32_t spacingMs, uint32_t now);
+
+// Oldest job with a due shot, or nullptr
+ShotJob* shotJobsDue(uint32_t now);
+
+// Mark one shot of `job` as sent; frees the slot after the last one
+void shotJobsShotFired(ShotJob* job);
+
+// Earliest pending job deadline; false if there are no jobs
+bool shotJobsNextDeadline(uint32_t now, uint32_t& deadline);
+
+uint8_t shotJobsPending();
+
+#endif // SHOT_JOBS_H
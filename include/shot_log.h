@@ -0,0 +1,49 @@
+#ifndef SHOT_LOG_H
+#define SHOT_LOG_H
+
+#include <stdint.h>
+
+// Per-shot telemetry ring, exported through /api/shots.
+// The real-time task appends one record per shot; the network task streams
+// ranges out without copying the history. Records are addressed by a
+// sequence number counting every shot since boot, so a range query stays
+// meaningful while the ring wraps.
+
+enum ShotKind : uint8_t {
+    SHOT_SESSION = 0,
+    SHOT_JOB = 1
+};
+
+// Also the binary export format: 32 bytes, little-endian
+struct ShotRecord {
+    uint32_t sequence;          // Shots since boot, starting at 1
+    uint16_t index;             // Session slot, or shot number within the job
+    uint8_t kind;               // ShotKind
+    uint8_t reserved;
+    uint32_t scheduledMs;       // Deadline, millis()
+    uint32_t actualMs;          // Time the IR frames went out, millis()
+    int64_t epochMs;            // Wall-clock time of the shot, 0 if unknown
+    int16_t temperatureCenti;   // Filtered temperature in 1/100 °C, INT16_MIN if unknown
+    uint16_t jobId;             // Low 16 bits of the job id, SHOT_JOB only
+    uint32_t freeHeap;
+};
+
+static_assert(sizeof(ShotRecord) == 32, "Shot records are exported as 32 byte blocks");
+
+const uint32_t SHOT_LOG_CAPACITY = 512;         // Internal RAM, 16 KB
+const uint32_t SHOT_LOG_CAPACITY_PSRAM = 8192;  // With PSRAM, 256 KB
+
+bool shotLogBegin();
+
+// Real-time task: fills in sequence, wall clock, temperature and heap, then appends
+void shotLogRecord(ShotRecord& record);
+
+// Oldest sequence still held and the next one to be written
+void shotLogRange(uint32_t& first, uint32_t& next);
+
+// Copies one record; false if not written yet or already overwritten
+bool shotLogRead(uint32_t sequence, ShotRecord& record);
+
+uint32_t shotLogCapacity();
+
+#endif // SHOT_LOG_H
@@ -0,0 +1,42 @@
+#ifndef SHOT_SCHEDULER_H
+#define SHOT_SCHEDULER_H
+
+#include <stdint.h>
+
+// Absolute-deadline shot scheduling on top of millis().
+// Every deadline is derived from the session start (start + offset of the slot),
+// so handler or loop delays never push the schedule back. All comparisons use
+// modular arithmetic and stay valid across the 49.7 day millis() wraparound.
+
+// Lateness histogram: 1 ms per bucket, the last bucket collects everything above
+const uint16_t LATENESS_BUCKETS = 128;
+
+struct LatenessStats {
+    uint32_t count = 0;
+    uint32_t minMs = 0;
+    uint32_t maxMs = 0;
+    uint64_t sumMs = 0;
+    uint32_t missed = 0;        // Slots skipped because the next one was already due
+    uint16_t histogram[LATENESS_BUCKETS] = {0};
+};
+
+// True once `now` has reached `deadline`, independent of wraparound
+inline bool timeReached(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+// Deadline of shot `slot` (0-based) on a fixed interval
+inline uint32_t shotDeadline(uint32_t startTime, uint32_t offsetMs, uint32_t intervalMs, uint16_t slot) {
+    return startTime + offsetMs + (uint32_t)slot * intervalMs;
+}
+
+// Latest slot whose deadline (start + offsets[slot]) has passed at `now`,
+// never below `nextSlot`. Callers must check timeReached() for `nextSlot` first.
+uint16_t dueScheduleSlot(uint32_t now, uint32_t startTime, const uint32_t* offsets, uint16_t count, uint16_t nextSlot);
+
+void latenessReset(LatenessStats& stats);
+void latenessRecord(LatenessStats& stats, uint32_t latenessMs);
+uint32_t latenessMeanMs(const LatenessStats& stats);
+uint32_t latenessPercentileMs(const LatenessStats& stats, uint8_t percentile);
+
+#endif // SHOT_SCHEDULER_H
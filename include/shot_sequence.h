@@ -0,0 +1,68 @@
+#ifndef SHOT_SEQUENCE_H
+#define SHOT_SEQUENCE_H
+
+#include <stdint.h>
+
+// Programmable interval sequences.
+// A session is a list of phases (fixed interval, linear or exponential
+// interval ramp, pause, burst, absolute start time). On start the phases are
+// compiled once into a table of deadline offsets from the session start, so
+// the shot path only reads the next entry: no floating point per shot and
+// the same drift-free start + offset deadlines as before.
+
+enum PhaseType : uint8_t {
+    PHASE_FIXED = 0,        // `shots` at `intervalMs`
+    PHASE_RAMP_LINEAR = 1,  // `shots`, interval going linearly from `intervalMs` to `endIntervalMs`
+    PHASE_RAMP_EXP = 2,     // Same, with a constant ratio between consecutive intervals
+    PHASE_PAUSE = 3,        // No shots for `durationMs`
+    PHASE_BURST = 4,        // `shots` back to back at `intervalMs` spacing
+    PHASE_AT = 5            // Next phase starts `durationMs` after the session start
+};
+
+struct SequencePhase {
+    PhaseType type = PHASE_FIXED;
+    uint16_t shots = 0;
+    uint32_t intervalMs = 0;
+    uint32_t endIntervalMs = 0;
+    uint32_t durationMs = 0;
+};
+
+const uint8_t MAX_SEQUENCE_PHASES = 8;
+const uint16_t MAX_SEQUENCE_SHOTS = 4096;                    // 16 KB schedule table
+const uint32_t MIN_SEQUENCE_INTERVAL_MS = 200;               // One Sony frame set takes ~170 ms on air
+const uint32_t MAX_SEQUENCE_INTERVAL_MS = 3600000;
+const uint32_t MAX_SEQUENCE_DURATION_MS = 7UL * 24 * 3600000;   // Far below the int32 deadline horizon
+
+struct SequencePlan {
+    uint8_t phaseCount = 0;
+    SequencePhase phases[MAX_SEQUENCE_PHASES];
+};
+
+enum SequenceError : uint8_t {
+    SEQUENCE_OK = 0,
+    SEQUENCE_NO_PHASES,
+    SEQUENCE_BAD_PHASE,
+    SEQUENCE_BAD_INTERVAL,
+    SEQUENCE_AT_IN_PAST,
+    SEQUENCE_NO_SHOTS,
+    SEQUENCE_TOO_MANY_SHOTS,
+    SEQUENCE_TOO_LONG
+};
+
+struct SequenceSummary {
+    uint16_t shots = 0;
+    uint32_t durationMs = 0;    // From session start to the end of the last phase
+};
+
+// Single fixed-interval phase, the classic session
+void sequenceFixed(SequencePlan& plan, uint16_t shots, uint32_t intervalMs);
+
+// Validates `plan` and, if `offsets` is not null, writes the deadline offset
+// of every shot (at most `capacity`). The first phase starts `startDelayMs`
+// after the session start.
+SequenceError sequenceCompile(const SequencePlan& plan, uint32_t startDelayMs,
+                              uint32_t* offsets, uint16_t capacity, SequenceSummary& summary);
+
+const char* sequenceErrorText(SequenceError error);
+
+#endif // SHOT_SEQUENCE_H
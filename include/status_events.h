@@ -0,0 +1,25 @@
+#ifndef STATUS_EVENTS_H
+#define STATUS_EVENTS_H
+
+#include <WiFi.h>
+
+// Server-Sent Events broadcaster for /api/events.
+// Subscribed sockets are kept open after the handler returns; events are
+// only written when something changed, so idle subscribers cost nothing
+// beyond an occasional keepalive comment.
+
+const uint8_t MAX_EVENT_CLIENTS = 4;
+const unsigned long EVENT_KEEPALIVE_MS = 30000;
+
+// Takes over the client of the current request; false if all slots are taken
+bool statusEventsSubscribe(WiFiClient& client, const char* initialData, size_t len);
+
+// Send one "data:" event to all subscribers, dropping disconnected ones
+void statusEventsPublish(const char* data, size_t len);
+
+// Keepalive so dead connections are noticed and slots freed
+void statusEventsMaintain();
+
+uint8_t statusEventsClientCount();
+
+#endif // STATUS_EVENTS_H
@@ -0,0 +1,46 @@
+#ifndef SYNC_LINK_H
+#define SYNC_LINK_H
+
+#include "clock_sync.h"
+#include "session.h"
+
+// UDP multicast transport for leader/follower sync (clock_sync.h).
+// The socket is opened once the station has an IP; in access point mode
+// there are no peers. A leader beacons every SYNC_BEACON_MS; a follower
+// feeds the beacons into its clock estimate and keeps the real-time task
+// running the leader's session at the leader's deadlines. The session start
+// is re-anchored once the estimate has moved by SYNC_REANCHOR_MIN_MS or the
+// beacon jitter, whichever is larger; smaller moves are noise. When the
+// leader goes quiet the follower keeps its last anchor.
+// Network task only.
+
+struct SyncStatus {
+    SyncMode mode = SYNC_OFF;
+    uint32_t nodeId = 0;
+    bool linkUp = false;
+    uint32_t beaconsSent = 0;
+    uint32_t beaconsReceived = 0;
+    
+    // Follower
+    bool locked = false;            // Enough beacons for an estimate
+    bool following = false;         // Running the leader's session
+    uint32_t beaconAgeMs = 0;
+    ClockSync clock;
+};
+
+void syncBegin(SyncMode mode);
+void syncSetMode(SyncMode mode);
+SyncMode syncMode();
+
+// Receives, beacons and follows; call from the network task loop
+void syncUpdate(const StatusSnapshot& status);
+
+void syncReadStatus(SyncStatus& status);
+
+// Leader: followers that reported recently
+const SyncFollower* syncFollowers();
+
+const char* syncModeName(SyncMode mode);
+bool syncModeFind(const char* name, SyncMode& mode);
+
+#endif // SYNC_LINK_H
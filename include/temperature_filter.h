@@ -0,0 +1,79 @@
+#ifndef TEMPERATURE_FILTER_H
+#define TEMPERATURE_FILTER_H
+
+#include <stdint.h>
+
+// Temperature signal chain: each reading is the trimmed mean of a block of
+// oversampled conversions, smoothed by a first-order IIR in fixed point and
+// decimated into per-minute mean/min/max. All values are integers in
+// 1/1000 °C. Host-portable; the simulator replays recorded conversion
+// streams through the same code (--temp-replay).
+
+const uint32_t TEMP_SAMPLE_MS = 1000;           // One reading per second
+const uint8_t TEMP_OVERSAMPLE = 16;             // Conversions per reading
+const uint8_t TEMP_TRIM = 3;                    // Dropped from each end of the sorted block
+const uint8_t TEMP_IIR_SHIFT = 4;               // alpha = 1/16, time constant ~16 readings
+const uint8_t TEMP_IIR_FRACTION_BITS = 8;       // Extra resolution of the filter state
+const uint32_t TEMP_STALE_MS = 10000;           // Gap after which the filter restarts
+const uint32_t TEMP_MINUTE_MS = 60000;
+const uint16_t TEMP_HISTORY_MINUTES = 480;      // 8 hours, 5.6 KB
+
+// Plausible sensor range; conversions outside are rejected
+const int32_t TEMP_MIN_MILLI = -40000;
+const int32_t TEMP_MAX_MILLI = 125000;
+const int32_t TEMP_INVALID_MILLI = INT32_MIN;
+const int16_t TEMP_UNKNOWN_CENTI = INT16_MIN;
+
+// NTC thermistor from 3.3 V through the series resistor to the ADC pin,
+// thermistor from there to ground
+const uint32_t TEMP_NTC_SUPPLY_MV = 3300;
+const uint32_t TEMP_NTC_SERIES_OHM = 10000;
+const uint32_t TEMP_NTC_R25_OHM = 10000;
+const uint32_t TEMP_NTC_BETA = 3950;
+
+// Filtered minute, 12 bytes
+struct TemperatureMinute {
+    uint32_t startMs;           // millis() at the start of the minute
+    int16_t meanCenti;          // 1/100 °C, filtered
+    int16_t minCenti;
+    int16_t maxCenti;
+    uint16_t readings;          // Readings that went into it
+};
+
+struct TemperatureFilter {
+    bool primed = false;
+    int32_t state = 0;              // Filter output << TEMP_IIR_FRACTION_BITS
+    uint32_t lastMs = 0;            // Time of the last reading
+    
+    // Minute being collected
+    bool collecting = false;
+    uint32_t minuteStartMs = 0;
+    int32_t minuteSum = 0;
+    int32_t minuteMin = 0;
+    int32_t minuteMax = 0;
+    uint16_t minuteReadings = 0;
+    
+    uint32_t readings = 0;
+    uint32_t restarts = 0;          // Restarted after a gap of TEMP_STALE_MS
+};
+
+// Trimmed mean of `count` conversions, out-of-range ones rejected; sorts
+// `conversions`. TEMP_INVALID_MILLI if fewer than half are usable.
+int32_t temperatureOversample(int32_t* conversions, uint8_t count, uint8_t& rejected);
+
+void temperatureFilterReset(TemperatureFilter& filter);
+
+// Adds one reading; true if it closed a minute, which is then in `completed`.
+// Minutes are aligned to the first reading, a gap leaves minutes out.
+bool temperatureFilterAdd(TemperatureFilter& filter, uint32_t nowMs, int32_t milliC, TemperatureMinute& completed);
+
+// Filtered value, TEMP_INVALID_MILLI before the first reading
+int32_t temperatureFilterValue(const TemperatureFilter& filter);
+
+// Thermistor divider voltage to temperature, TEMP_INVALID_MILLI if the
+// voltage means an open or shorted sensor
+int32_t temperatureNtcMilli(uint32_t milliVolts);
+
+int16_t temperatureMilliToCenti(int32_t milliC);
+
+#endif // TEMPERATURE_FILTER_H
@@ -0,0 +1,49 @@
+#ifndef TEMPERATURE_SENSOR_H
+#define TEMPERATURE_SENSOR_H
+
+#include "temperature_filter.h"
+
+// Background temperature acquisition.
+// A low-priority task on core 0 takes TEMP_OVERSAMPLE conversions every
+// TEMP_SAMPLE_MS and runs them through temperature_filter.h. It publishes
+// the filtered value for single atomic loads and appends every closed
+// minute to a history ring, so neither the real-time task nor the web
+// handlers ever wait for the sensor.
+// Source: an NTC thermistor on the ADC1 pin TEMP_SENSOR_PIN (ADC2 is taken
+// by WiFi) when that is defined, otherwise the ESP32's internal sensor,
+// which reads the die and runs several degrees above ambient.
+
+const uint8_t TEMP_TASK_CORE = 0;
+const uint8_t TEMP_TASK_PRIORITY = 1;
+const uint32_t TEMP_TASK_STACK = 3072;
+
+struct TemperatureStatus {
+    bool valid = false;             // A reading within the last TEMP_STALE_MS
+    int32_t milliC = 0;             // Filtered
+    int32_t rawMilliC = 0;          // Last oversampled reading, before the IIR
+    uint32_t readingMs = 0;         // millis() of the last reading
+    uint32_t readings = 0;
+    uint32_t dropped = 0;           // Readings with too few usable conversions
+    uint32_t rejected = 0;          // Conversions out of range
+    uint32_t restarts = 0;          // Filter restarted after a gap
+};
+
+bool temperatureSensorBegin();
+
+// "ntc" or "internal"
+const char* temperatureSensorName();
+
+// Filtered value in 1/100 °C, TEMP_UNKNOWN_CENTI without a recent reading.
+// Lock-free, safe from the real-time task.
+int16_t temperatureLatestCenti();
+
+void temperatureReadStatus(TemperatureStatus& status);
+
+// Per-minute history, addressed by sequence like the shot log: oldest
+// minute still held and the next one to be written
+void temperatureHistoryRange(uint32_t& first, uint32_t& next);
+
+// Copies one minute; false if not written yet or already overwritten
+bool temperatureHistoryRead(uint32_t sequence, TemperatureMinute& minute);
+
+#endif // TEMPERATURE_SENSOR_H
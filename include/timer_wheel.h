@@ -0,0 +1,72 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+// Hierarchical timer wheel over a fixed node pool.
+// Level L has 64 slots and holds the timers that expire in the current
+// round of level L + 1, filed under their level-L digit; timers further
+// out than the whole wheel wait in an overflow list. Insert and cancel are
+// O(1) through intrusive lists. When a level-L round ends, the matching
+// slot of level L + 1 cascades down, so every timer is touched at most
+// once per level. A bitmap per level lets an advance jump over empty
+// slots, and an advance with nothing due costs the same for one pending
+// timer or a thousand. Host-portable; ticks are whatever the caller counts
+// in (session_schedule.h uses milliseconds).
+
+const uint8_t TIMER_WHEEL_LEVELS = 5;
+const uint8_t TIMER_WHEEL_SLOT_BITS = 6;
+const uint16_t TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+const uint8_t TIMER_WHEEL_SPAN_BITS = TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS;  // 2^30 ticks, 12.4 days of ms
+const uint16_t TIMER_NONE = 0xFFFF;
+
+// List heads: one per slot, then overflow and due
+const uint16_t TIMER_LIST_OVERFLOW = TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS;
+const uint16_t TIMER_LIST_DUE = TIMER_LIST_OVERFLOW + 1;
+const uint16_t TIMER_LIST_COUNT = TIMER_LIST_DUE + 1;
+
+struct TimerNode {
+    uint64_t expires;
+    uint16_t next;
+    uint16_t prev;
+    uint16_t list;      // TIMER_NONE while free
+};
+
+struct TimerWheel {
+    TimerNode* nodes = nullptr;
+    uint16_t capacity = 0;
+    uint16_t pending = 0;           // Timers in the wheel or due, not popped yet
+    uint16_t freeHead = TIMER_NONE;
+    uint64_t now = 0;               // First tick not processed yet
+    uint64_t occupied[TIMER_WHEEL_LEVELS] = {};
+    uint16_t heads[TIMER_LIST_COUNT];
+    uint16_t dueTail = TIMER_NONE;  // Due timers pop in the order they expired
+    uint32_t cascaded = 0;          // Timers moved down a level
+};
+
+// `nodes` is caller storage for `capacity` timers (fewer than TIMER_NONE);
+// callers keep their payload in a parallel array under the same index
+void timerWheelInit(TimerWheel& wheel, TimerNode* nodes, uint16_t capacity, uint64_t now);
+
+// TIMER_NONE if the pool is full. A timer at or before the last processed
+// tick is due right away.
+uint16_t timerWheelAdd(TimerWheel& wheel, uint64_t expires);
+
+// Files a pending timer under a new expiry, e.g. after a clock step
+void timerWheelMove(TimerWheel& wheel, uint16_t timer, uint64_t expires);
+
+// Removes and frees a pending timer; false if it was not pending
+bool timerWheelCancel(TimerWheel& wheel, uint16_t timer);
+
+// Makes every timer expiring at or before `tick` due
+void timerWheelAdvance(TimerWheel& wheel, uint64_t tick);
+
+// Takes the next due timer and frees it, TIMER_NONE if none is due. The
+// caller's payload under that index stays intact until the next add.
+uint16_t timerWheelPop(TimerWheel& wheel);
+
+// Earliest tick a pending timer can expire at, never later than the real
+// next expiry; UINT64_MAX if nothing is pending
+uint64_t timerWheelNextExpiry(const TimerWheel& wheel);
+
+#endif // TIMER_WHEEL_H
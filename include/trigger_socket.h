@@ -0,0 +1,51 @@
+#ifndef TRIGGER_SOCKET_H
+#define TRIGGER_SOCKET_H
+
+#include <WiFi.h>
+#include "session.h"
+
+// Persistent WebSocket trigger channel at /api/trigger.
+// A manual shot over HTTP pays for a TCP connect and a request parse before
+// the job reaches the real-time task; over an open socket it is one small
+// binary frame, submitted as soon as the network task reads it. Each job is
+// acknowledged when queued and again for every shot with the millis() time
+// the IR frames went out, taken from the shot log.
+// Messages are binary frames, little-endian, first byte the opcode, then a
+// client-chosen tag that is echoed back. Network task only.
+
+enum TriggerOp : uint8_t {
+    // Client to controller
+    TRIGGER_SHOT = 0x01,        // tag u16
+    TRIGGER_BURST = 0x02,       // tag u16, count u16, spacing ms u32
+    TRIGGER_STATUS = 0x03,      // tag u16
+    
+    // Controller to client
+    TRIGGER_QUEUED = 0x81,      // tag u16, job u32, received ms u32
+    TRIGGER_FIRED = 0x82,       // tag u16, job u32, shot u16, fired ms u32
+    TRIGGER_STATE = 0x83,       // tag u16, now ms u32, state u8, current u16, total u16, jobs u8
+    TRIGGER_ERROR = 0x8F        // tag u16, TriggerError u8
+};
+
+enum TriggerError : uint8_t {
+    TRIGGER_ERR_INVALID = 1,    // Unknown opcode, short message or burst out of range
+    TRIGGER_ERR_BUSY = 2,       // Command ring or acknowledgement table full
+    TRIGGER_ERR_DROPPED = 3     // Job did not fire in time, e.g. the job queue was full
+};
+
+const uint8_t MAX_TRIGGER_CLIENTS = 2;
+const uint8_t MAX_TRIGGER_PENDING = 8;          // Jobs awaiting their FIRED acknowledgements
+const uint32_t TRIGGER_ACK_TIMEOUT_MS = 5000;   // Past the job's last deadline
+const uint32_t TRIGGER_PING_MS = 20000;         // Browsers answer pings on their own
+const uint32_t TRIGGER_IDLE_TIMEOUT_MS = 45000; // Nothing received, not even a pong
+
+// Completes the WebSocket handshake on the client of the current request and
+// keeps the socket, replacing the quietest client if all slots are taken;
+// false if the key is malformed
+bool triggerSocketAccept(WiFiClient& client, const char* key);
+
+// Reads and answers frames, sends FIRED acknowledgements and keepalives
+void triggerSocketUpdate(const StatusSnapshot& status);
+
+uint8_t triggerSocketClientCount();
+
+#endif // TRIGGER_SOCKET_H
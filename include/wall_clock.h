@@ -0,0 +1,34 @@
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Wall-clock time that is usable right after reset.
+// The last known time is mirrored to RTC memory (survives resets and
+// brownouts) and periodically to NVS (survives power loss). On boot it is
+// restored immediately and later replaced by SNTP.
+
+enum WallClockSource : uint8_t {
+    CLOCK_NONE = 0,     // Unknown, still at the 1970 epoch
+    CLOCK_NVS = 1,      // Restored from flash, may be off by the power-off time
+    CLOCK_RTC = 2,      // Restored from RTC memory after a reset
+    CLOCK_NTP = 3       // Synchronized via SNTP
+};
+
+const char* const TIMEZONE = "CET-1CEST,M3.5.0,M10.5.0/3";
+const uint32_t CLOCK_NVS_SAVE_INTERVAL_MS = 600000;
+
+void wallClockRestore();
+void wallClockSynced();
+
+// Mirrors the current time; call regularly from the network task
+void wallClockMaintain();
+
+// Milliseconds since the Unix epoch, only meaningful once restored
+int64_t wallClockEpochMs();
+
+WallClockSource wallClockSource();
+const char* wallClockSourceName();
+
+#endif // WALL_CLOCK_H
@@ -0,0 +1,83 @@
+# gen_web_assets.py - PlatformIO pre-build script
+#
+# Compresses the files in web/ with gzip and emits include/web_assets.h,
+# a header with the compressed bytes as flash arrays plus a content-hash
+# ETag per file. The header is regenerated on every build and not tracked.
+#
+# Can also be run directly: python scripts/gen_web_assets.py
+
+import gzip
+import hashlib
+import os
+import re
+
+ASSETS = [
+    # (source file in web/, C identifier prefix)
+    ("index.html", "INDEX_HTML"),
+]
+
+
+def project_dir():
+    try:
+        Import("env")  # noqa: F821 - provided by PlatformIO
+        return env.subst("$PROJECT_DIR")  # noqa: F821
+    except NameError:
+        return os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def minify_html(text):
+    # Drop leading indentation and blank lines; content is small enough
+    # that a real minifier buys little over gzip
+    lines = (line.strip() for line in text.splitlines())
+    return "\n".join(line for line in lines if line)
+
+
+def render_asset(source, prefix):
+    with open(source, "r", encoding="utf-8") as f:
+        text = minify_html(f.read())
+
+    # mtime=0 keeps the output (and therefore the ETag) reproducible
+    data = gzip.compress(text.encode("utf-8"), compresslevel=9, mtime=0)
+    etag = hashlib.sha256(data).hexdigest()[:16]
+
+    out = []
+    out.append("// %s: %d bytes, %d gzipped" % (os.path.basename(source), len(text), len(data)))
+    out.append('const char %s_ETAG[] = "\\"%s\\"";' % (prefix, etag))
+    out.append("const size_t %s_GZ_LEN = %d;" % (prefix, len(data)))
+    out.append("const uint8_t %s_GZ[] PROGMEM = {" % prefix)
+    for i in range(0, len(data), 16):
+        out.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    out.append("};")
+    return "\n".join(out)
+
+
+def generate():
+    root = project_dir()
+    target = os.path.join(root, "include", "web_assets.h")
+
+    parts = [
+        "// Generated by scripts/gen_web_assets.py from web/ - do not edit",
+        "#ifndef WEB_ASSETS_H",
+        "#define WEB_ASSETS_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+    ]
+    for name, prefix in ASSETS:
+        assert re.match(r"^[A-Z_]+$", prefix)
+        parts.append(render_asset(os.path.join(root, "web", name), prefix))
+        parts.append("")
+    parts.append("#endif // WEB_ASSETS_H")
+    content = "\n".join(parts) + "\n"
+
+    # Only touch the header when the content changed to avoid needless rebuilds
+    if os.path.exists(target):
+        with open(target, "r", encoding="utf-8") as f:
+            if f.read() == content:
+                return
+    with open(target, "w", encoding="utf-8") as f:
+        f.write(content)
+    print("Generated %s" % os.path.relpath(target, root))
+
+
+generate()
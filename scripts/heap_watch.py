@@ -0,0 +1,117 @@
+# heap_watch.py - long-run heap check against a running controller
+#
+# Drives the JSON API the way an open status page does (a status poll every
+# --poll seconds, the schedule every 30th poll) and samples
+# /api/metrics every --interval seconds: free heap, minimum free heap,
+# largest free block and the request arena high-water mark. Each sample is
+# one CSV line on stdout. At the end the largest free block is compared
+# with its value after the warm-up; a fragmenting heap shows up as a block
+# that keeps shrinking while the free total stays put.
+#
+# Exits 1 if the largest block fell by more than --max-drop bytes or the
+# arena ever failed an allocation. Only the standard library is needed:
+#   python scripts/heap_watch.py 192.168.1.50 --hours 8 > heap.csv
+
+import argparse
+import http.client
+import sys
+import time
+
+GAUGES = (
+    "astro_heap_free_bytes",
+    "astro_heap_min_free_bytes",
+    "astro_heap_largest_free_block_bytes",
+    "astro_request_arena_high_water_bytes",
+    "astro_request_arena_failures_total",
+)
+
+
+def get(host, port, path, timeout):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    try:
+        conn.request("GET", path)
+        response = conn.getresponse()
+        return response.status, response.read()
+    finally:
+        conn.close()
+
+
+def read_gauges(host, port, timeout):
+    status, body = get(host, port, "/api/metrics", timeout)
+    if status != 200:
+        raise ConnectionError(f"/api/metrics answered {status}")
+    values = {}
+    for line in body.decode().splitlines():
+        name, _, value = line.partition(" ")
+        if name in GAUGES:
+            values[name] = int(float(value))
+    missing = [name for name in GAUGES if name not in values]
+    if missing:
+        raise ValueError("metrics without " + ", ".join(missing) + " (firmware built without ENABLE_METRICS?)")
+    return values
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Long-run heap check against a running controller")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--hours", type=float, default=8.0)
+    parser.add_argument("--warmup", type=float, default=60.0, help="seconds before the reference sample")
+    parser.add_argument("--interval", type=float, default=30.0, help="seconds between heap samples")
+    parser.add_argument("--poll", type=float, default=1.0, help="seconds between status polls")
+    parser.add_argument("--max-drop", type=int, default=1024, help="allowed shrink of the largest block, bytes")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    args = parser.parse_args()
+
+    start = time.monotonic()
+    end = start + args.hours * 3600
+    next_sample = start
+    reference = None
+    lowest = None
+    arena_failures = 0
+    errors = 0
+    polls = 0
+
+    print("elapsed_s,free,min_free,largest_block,arena_high_water,arena_failures,polls,errors")
+    while time.monotonic() < end:
+        now = time.monotonic()
+        try:
+            get(args.host, args.port, "/api/status", args.timeout)
+            if polls % 30 == 0:
+                get(args.host, args.port, "/api/schedule", args.timeout)
+            polls += 1
+        except (OSError, http.client.HTTPException):
+            errors += 1
+
+        if now >= next_sample:
+            next_sample += args.interval
+            try:
+                g = read_gauges(args.host, args.port, args.timeout)
+            except (OSError, http.client.HTTPException):
+                errors += 1
+            else:
+                largest = g["astro_heap_largest_free_block_bytes"]
+                arena_failures = g["astro_request_arena_failures_total"]
+                if reference is None and now - start >= args.warmup:
+                    reference = largest
+                if reference is not None:
+                    lowest = largest if lowest is None else min(lowest, largest)
+                print(f"{now - start:.0f},{g['astro_heap_free_bytes']},{g['astro_heap_min_free_bytes']},"
+                      f"{largest},{g['astro_request_arena_high_water_bytes']},{arena_failures},{polls},{errors}",
+                      flush=True)
+
+        time.sleep(max(0.0, args.poll - (time.monotonic() - now)))
+
+    if reference is None:
+        print("run shorter than the warm-up, nothing to compare", file=sys.stderr)
+        return 1
+    drop = reference - lowest
+    ok = drop <= args.max_drop and arena_failures == 0
+    print(f"largest block after warm-up {reference}, lowest {lowest}, drop {drop} bytes, "
+          f"arena failures {arena_failures}, {polls} polls, {errors} errors: {'ok' if ok else 'FAIL'}",
+          file=sys.stderr)
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,210 @@
+# trigger_latency.py - click-to-emit latency of a manual shot
+#
+# Fires single shots at a controller through the binary WebSocket channel
+# (/api/trigger) and through POST /shot, and reports for each path how long
+# it took from the moment the request left this machine until the IR frames
+# went out. The transmit time is the millis() stamp the controller records
+# for every shot; it is mapped onto the host clock with STATUS round trips
+# over the socket, keeping the fastest one, before every shot.
+#
+# Every trial really fires the camera. Only the standard library is needed:
+#   python scripts/trigger_latency.py 192.168.1.50 --shots 20
+
+import argparse
+import base64
+import http.client
+import os
+import socket
+import statistics
+import struct
+import time
+
+TRIGGER_SHOT = 0x01
+TRIGGER_STATUS = 0x03
+TRIGGER_QUEUED = 0x81
+TRIGGER_FIRED = 0x82
+TRIGGER_STATE = 0x83
+TRIGGER_ERROR = 0x8F
+
+
+def now_ms():
+    return time.perf_counter() * 1000.0
+
+
+class TriggerSocket:
+    """Just enough of a WebSocket client for the trigger protocol."""
+
+    def __init__(self, host, port, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = (
+            "GET /api/trigger HTTP/1.1\r\n"
+            f"Host: {host}\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n"
+        )
+        self.sock.sendall(request.encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(256)
+            if not chunk:
+                raise ConnectionError("Connection closed during handshake")
+            response += chunk
+        header, self.buffer = response.split(b"\r\n\r\n", 1)
+        if not header.startswith(b"HTTP/1.1 101"):
+            raise ConnectionError(header.split(b"\r\n")[0].decode())
+        self.tag = 0
+
+    def send(self, message):
+        mask = os.urandom(4)
+        payload = bytes(b ^ mask[i % 4] for i, b in enumerate(message))
+        self.sock.sendall(bytes([0x82, 0x80 | len(message)]) + mask + payload)
+
+    def _read(self, count):
+        while len(self.buffer) < count:
+            chunk = self.sock.recv(256)
+            if not chunk:
+                raise ConnectionError("Connection closed")
+            self.buffer += chunk
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def receive(self):
+        # Controller frames are unmasked and short
+        while True:
+            first, length = self._read(2)
+            payload = self._read(length & 0x7F)
+            opcode = first & 0x0F
+            if opcode == 0x2:
+                return payload
+            if opcode == 0x9:
+                self.sock.sendall(bytes([0x8A, 0x80 | len(payload)]) + b"\0\0\0\0" + payload)
+            elif opcode == 0x8:
+                raise ConnectionError("Closed by controller")
+
+    def request(self, op, *fields):
+        self.tag = (self.tag + 1) & 0xFFFF
+        self.send(struct.pack("<BH", op, self.tag) + b"".join(fields))
+        return self.tag
+
+    def wait(self, op, tag):
+        while True:
+            message = self.receive()
+            if message[0] == TRIGGER_ERROR and struct.unpack_from("<H", message, 1)[0] == tag:
+                raise RuntimeError(f"Controller error {message[3]}")
+            if message[0] == op and struct.unpack_from("<H", message, 1)[0] == tag:
+                return message
+
+    def clock_offset(self, rounds):
+        """Device millis() minus host time, from the fastest STATUS round trip."""
+        best = None
+        for _ in range(rounds):
+            sent = now_ms()
+            message = self.wait(TRIGGER_STATE, self.request(TRIGGER_STATUS))
+            received = now_ms()
+            device_ms = struct.unpack_from("<I", message, 3)[0]
+            rtt = received - sent
+            if best is None or rtt < best[0]:
+                best = (rtt, device_ms - (sent + received) / 2)
+        return best[1]
+
+
+def device_to_host(device_ms, offset, reference_host_ms):
+    # millis() wraps after 49 days; unwrap near the reference
+    host = device_ms - offset
+    wrap = 2.0 ** 32
+    while host - reference_host_ms > wrap / 2:
+        host -= wrap
+    while reference_host_ms - host > wrap / 2:
+        host += wrap
+    return host
+
+
+def trial_socket(ws, offset):
+    click = now_ms()
+    tag = ws.request(TRIGGER_SHOT)
+    ws.wait(TRIGGER_QUEUED, tag)
+    queued = now_ms() - click
+    fired = ws.wait(TRIGGER_FIRED, tag)
+    fired_ms = struct.unpack_from("<I", fired, 9)[0]
+    return device_to_host(fired_ms, offset, click) - click, queued
+
+
+def shots_next(host, port, timeout):
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    conn.request("GET", "/api/shots?from=4294967295")
+    response = conn.getresponse()
+    response.read()
+    conn.close()
+    return int(response.getheader("X-Shots-Next"))
+
+
+def trial_http(host, port, offset, timeout):
+    cursor = shots_next(host, port, timeout)
+
+    # New connection per shot, as the controller closes after every response
+    click = now_ms()
+    conn = http.client.HTTPConnection(host, port, timeout=timeout)
+    conn.request("POST", "/shot")
+    response = conn.getresponse()
+    body = response.read().decode()
+    conn.close()
+    queued = now_ms() - click
+    if response.status != 202:
+        raise RuntimeError(f"POST /shot: {response.status} {body}")
+    job = int(body.split('"job":')[1].rstrip("}")) & 0xFFFF
+
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        conn = http.client.HTTPConnection(host, port, timeout=timeout)
+        conn.request("GET", f"/api/shots?from={cursor}")
+        rows = conn.getresponse().read().decode().splitlines()[1:]
+        conn.close()
+        for row in rows:
+            fields = row.split(",")
+            if fields[1] == "job" and int(fields[3]) == job:
+                return device_to_host(int(fields[5]), offset, click) - click, queued
+        time.sleep(0.05)
+    raise RuntimeError(f"Job {job} never showed up in /api/shots")
+
+
+def report(name, samples):
+    emit = sorted(s[0] for s in samples)
+    acked = [s[1] for s in samples]
+    p95 = emit[min(len(emit) - 1, int(len(emit) * 0.95))]
+    print(f"{name:<10} click-to-emit ms: min {emit[0]:6.1f}  median {statistics.median(emit):6.1f}  "
+          f"p95 {p95:6.1f}  max {emit[-1]:6.1f}   acknowledged after: median {statistics.median(acked):6.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Click-to-emit latency, WebSocket trigger vs. POST /shot")
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--shots", type=int, default=10, help="trials per path")
+    parser.add_argument("--gap", type=float, default=1.5, help="seconds between shots")
+    parser.add_argument("--sync-rounds", type=int, default=8, help="STATUS round trips per clock estimate")
+    parser.add_argument("--timeout", type=float, default=5.0)
+    args = parser.parse_args()
+
+    ws = TriggerSocket(args.host, args.port, args.timeout)
+    results = {"websocket": [], "http": []}
+
+    # Interleaved, so both paths see the same network conditions
+    for _ in range(args.shots):
+        for path in results:
+            offset = ws.clock_offset(args.sync_rounds)
+            if path == "websocket":
+                results[path].append(trial_socket(ws, offset))
+            else:
+                results[path].append(trial_http(args.host, args.port, offset, args.timeout))
+            time.sleep(args.gap)
+
+    for path, samples in results.items():
+        report(path, samples)
+
+
+if __name__ == "__main__":
+    main()
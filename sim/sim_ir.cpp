@@ -0,0 +1,53 @@
+// Mock IR sink for the simulator: replaces src/ir_transmitter.cpp and
+// keeps the sender busy for the real on-air time of the loaded profile.
+
+#include "ir_transmitter.h"
+#include "sim_ir.h"
+
+static uint32_t simNow = 0;
+static uint32_t busyUntil = 0;
+static uint32_t trainMs = 0;
+static uint32_t sendCount = 0;
+static uint32_t lastSendTime = 0;
+
+void simIrReset(uint32_t now, uint32_t trainDurationMs) {
+    simNow = now;
+    busyUntil = now;
+    trainMs = trainDurationMs;
+    sendCount = 0;
+    lastSendTime = 0;
+}
+
+void simIrSetTime(uint32_t now) {
+    simNow = now;
+}
+
+uint32_t simIrSendCount() {
+    return sendCount;
+}
+
+uint32_t simIrLastSendTime() {
+    return lastSendTime;
+}
+
+bool irTransmitterBegin(uint8_t) {
+    return true;
+}
+
+bool irTransmitterLoad(const IrPulseTrain& train) {
+    trainMs = irTrainDurationUs(train) / 1000 + 1;
+    return true;
+}
+
+bool irTransmitterSend() {
+    if (irTransmitterBusy()) return false;
+    
+    busyUntil = simNow + trainMs;
+    lastSendTime = simNow;
+    sendCount++;
+    return true;
+}
+
+bool irTransmitterBusy() {
+    return (int32_t)(simNow - busyUntil) < 0;
+}
@@ -0,0 +1,12 @@
+#ifndef SIM_IR_H
+#define SIM_IR_H
+
+#include <stdint.h>
+
+// Control of the mock IR sink (sim_ir.cpp)
+void simIrReset(uint32_t now, uint32_t trainDurationMs);
+void simIrSetTime(uint32_t now);
+uint32_t simIrSendCount();
+uint32_t simIrLastSendTime();
+
+#endif // SIM_IR_H
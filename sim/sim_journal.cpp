@@ -0,0 +1,468 @@
+#include "sim_journal.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "journal.h"
+#include "session_journal.h"
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Config fields follow from the session id, so a replayed config can be
+// traced back to the session it came from
+static int64_t startEpochFor(uint32_t sessionId) {
+    return 1700000000000LL + (int64_t)sessionId * 1000;
+}
+
+static JournalRecord makeRecord(uint32_t sequence, JournalType type, uint16_t shot, uint32_t sessionId,
+                                uint16_t totalShots) {
+    JournalRecord record = JournalRecord();
+    record.sequence = sequence;
+    record.type = type;
+    record.shot = shot;
+    record.startEpochMs = startEpochFor(sessionId);
+    record.sessionId = sessionId;
+    record.intervalMs = 1000 + sessionId;
+    record.minutes = totalShots / 60 + 1;
+    record.totalShots = totalShots;
+    journalSeal(record);
+    return record;
+}
+
+static bool sameRecord(const JournalRecord& a, const JournalRecord& b) {
+    return memcmp(&a, &b, sizeof(JournalRecord)) == 0;
+}
+
+// A power cut `cut` bytes into writing `record` over `slot`
+static void tear(JournalRecord& slot, const JournalRecord& record, uint32_t cut) {
+    memcpy(&slot, &record, cut);
+}
+
+static void flipBit(JournalRecord& slot, uint32_t bit) {
+    ((uint8_t*)&slot)[bit / 8 % sizeof(JournalRecord)] ^= 1 << (bit % 8);
+}
+
+// Hand-built rings
+
+struct Ring {
+    std::vector<JournalRecord> slots;
+    
+    explicit Ring(uint32_t capacity) : slots(capacity, JournalRecord()) {}
+    
+    JournalRecord& slot(uint32_t sequence) { return slots[sequence % slots.size()]; }
+    void put(uint32_t sequence, JournalType type, uint16_t shot, uint32_t sessionId = 1, uint16_t totalShots = 10) {
+        slot(sequence) = makeRecord(sequence, type, shot, sessionId, totalShots);
+    }
+    JournalRecovery recover() const { return journalRecover(slots.data(), slots.size()); }
+};
+
+struct Expected {
+    uint32_t nextSequence;
+    uint32_t validRecords;
+    uint32_t skippedRecords;
+    bool sessionActive;
+    uint32_t sessionId;
+    uint16_t nextShot;
+};
+
+static uint32_t expect(const char* scenario, const Ring& ring, const Expected& want) {
+    JournalRecovery got = ring.recover();
+    const char* field = nullptr;
+    if (got.nextSequence != want.nextSequence) field = "nextSequence";
+    else if (got.validRecords != want.validRecords) field = "validRecords";
+    else if (got.skippedRecords != want.skippedRecords) field = "skippedRecords";
+    else if (got.sessionActive != want.sessionActive) field = "sessionActive";
+    else if (want.sessionActive && got.sessionId != want.sessionId) field = "sessionId";
+    else if (want.sessionActive && got.nextShot != want.nextShot) field = "nextShot";
+    else if (want.sessionActive && (got.startEpochMs != startEpochFor(got.sessionId) ||
+                                    got.intervalMs != 1000 + got.sessionId)) field = "session config";
+    if (field == nullptr) return 0;
+    
+    printf("FAIL scenario %s: %s (next %lu, valid %lu, skipped %lu, active %d, session %lu, shot %u)\n", scenario,
+           field, (unsigned long)got.nextSequence, (unsigned long)got.validRecords,
+           (unsigned long)got.skippedRecords, got.sessionActive, (unsigned long)got.sessionId, got.nextShot);
+    return 1;
+}
+
+// Session 1 of 10 shots, three of them taken
+static void started(Ring& ring) {
+    ring.put(1, JOURNAL_SESSION_START, 0);
+    ring.put(2, JOURNAL_SHOT, 0);
+    ring.put(3, JOURNAL_SHOT, 1);
+    ring.put(4, JOURNAL_SHOT, 2);
+}
+
+// Session 1 of 100 shots in a ring of 8 after 12 records, checkpoints at 5
+// and 9: sequences 5..12 are left, shots 0..8 taken
+static void wrapped(Ring& ring) {
+    ring.put(1, JOURNAL_SESSION_START, 0, 1, 100);
+    for (uint16_t shot = 0; shot < 3; shot++) ring.put(2 + shot, JOURNAL_SHOT, shot, 1, 100);
+    ring.put(5, JOURNAL_CHECKPOINT, 3, 1, 100);
+    for (uint16_t shot = 3; shot < 6; shot++) ring.put(3 + shot, JOURNAL_SHOT, shot, 1, 100);
+    ring.put(9, JOURNAL_CHECKPOINT, 6, 1, 100);
+    for (uint16_t shot = 6; shot < 9; shot++) ring.put(4 + shot, JOURNAL_SHOT, shot, 1, 100);
+}
+
+static uint32_t runScenarios(uint32_t& scenarios) {
+    uint32_t failures = 0;
+    scenarios = 0;
+    
+    {
+        Ring ring(8);
+        failures += expect("empty", ring, {1, 0, 0, false, 0, 0});
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        started(ring);
+        failures += expect("resume", ring, {5, 4, 0, true, 1, 3});
+        scenarios++;
+    }
+    {
+        // Fourth shot torn 12 bytes in: sequence and type made it, CRC did not
+        Ring ring(8);
+        started(ring);
+        tear(ring.slot(5), makeRecord(5, JOURNAL_SHOT, 3, 1, 10), 12);
+        failures += expect("torn newest", ring, {5, 4, 1, true, 1, 3});
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        started(ring);
+        flipBit(ring.slot(3), 6 * 8);
+        failures += expect("corrupt shot", ring, {5, 3, 1, true, 1, 3});
+        scenarios++;
+    }
+    {
+        // Shots without their session's config resume nothing
+        Ring ring(8);
+        started(ring);
+        flipBit(ring.slot(1), 10 * 8 + 3);
+        failures += expect("corrupt start", ring, {5, 3, 1, false, 0, 0});
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        started(ring);
+        ring.put(5, JOURNAL_SESSION_END, 3);
+        failures += expect("ended", ring, {6, 5, 0, false, 0, 0});
+        scenarios++;
+    }
+    {
+        // The end never reached flash: the session still counts as running
+        Ring ring(8);
+        started(ring);
+        tear(ring.slot(5), makeRecord(5, JOURNAL_SESSION_END, 3, 1, 10), 20);
+        failures += expect("torn end", ring, {5, 4, 1, true, 1, 3});
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        started(ring);
+        ring.put(5, JOURNAL_SESSION_END, 3);
+        ring.put(6, JOURNAL_SESSION_START, 0, 6, 5);
+        ring.put(7, JOURNAL_SHOT, 0, 6, 5);
+        failures += expect("next session", ring, {8, 7, 0, true, 6, 1});
+        scenarios++;
+    }
+    {
+        // A checkpoint written behind later shots does not move the session back
+        Ring ring(8);
+        ring.put(1, JOURNAL_SESSION_START, 0);
+        ring.put(2, JOURNAL_SHOT, 0);
+        ring.put(3, JOURNAL_SHOT, 1);
+        ring.put(4, JOURNAL_CHECKPOINT, 1);
+        failures += expect("old checkpoint", ring, {5, 4, 0, true, 1, 2});
+        scenarios++;
+    }
+    {
+        // A follower or SNTP re-anchor journals the moved start as a checkpoint
+        Ring ring(8);
+        started(ring);
+        JournalRecord anchor = makeRecord(5, JOURNAL_CHECKPOINT, 3, 1, 10);
+        anchor.startEpochMs += 7;
+        journalSeal(anchor);
+        ring.slot(5) = anchor;
+        ring.put(6, JOURNAL_SHOT, 3);
+        JournalRecovery got = ring.recover();
+        if (!got.sessionActive || got.sessionId != 1 || got.nextShot != 4 ||
+            got.startEpochMs != anchor.startEpochMs) {
+            printf("FAIL scenario re-anchored: active %d, session %lu, shot %u, start %lld\n", got.sessionActive,
+                   (unsigned long)got.sessionId, got.nextShot, (long long)got.startEpochMs);
+            failures++;
+        }
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        ring.put(1, JOURNAL_SESSION_START, 0, 1, 3);
+        for (uint16_t shot = 0; shot < 3; shot++) ring.put(2 + shot, JOURNAL_SHOT, shot, 1, 3);
+        failures += expect("completed", ring, {5, 4, 0, false, 0, 0});
+        scenarios++;
+    }
+    {
+        Ring ring(8);
+        wrapped(ring);
+        failures += expect("wrapped", ring, {13, 8, 0, true, 1, 9});
+        scenarios++;
+    }
+    {
+        // Start overwritten, no checkpoint in the ring
+        Ring ring(8);
+        ring.put(1, JOURNAL_SESSION_START, 0, 1, 100);
+        for (uint16_t shot = 0; shot < 11; shot++) ring.put(2 + shot, JOURNAL_SHOT, shot, 1, 100);
+        failures += expect("wrapped, config lost", ring, {13, 8, 0, false, 0, 0});
+        scenarios++;
+    }
+    {
+        // Slot of sequence 11 still holds sequence 3 from the lap before
+        Ring ring(8);
+        wrapped(ring);
+        ring.slot(11) = makeRecord(3, JOURNAL_SHOT, 1, 1, 100);
+        failures += expect("stale slot", ring, {13, 7, 1, true, 1, 9});
+        scenarios++;
+    }
+    {
+        // Newest write lost: the lap before is intact history and replays
+        Ring ring(8);
+        wrapped(ring);
+        ring.slot(12) = makeRecord(4, JOURNAL_SHOT, 2, 1, 100);
+        failures += expect("stale newest", ring, {12, 8, 0, true, 1, 8});
+        scenarios++;
+    }
+    {
+        // Sequence 10 written into the slot of sequence 7
+        Ring ring(8);
+        wrapped(ring);
+        ring.slot(7) = makeRecord(10, JOURNAL_SHOT, 6, 1, 100);
+        failures += expect("misplaced", ring, {13, 7, 1, true, 1, 9});
+        scenarios++;
+    }
+    {
+        // A later sequence out of place must not be taken as the newest
+        Ring ring(8);
+        wrapped(ring);
+        ring.slot(7) = makeRecord(18, JOURNAL_SHOT, 14, 1, 100);
+        failures += expect("misplaced newer", ring, {13, 7, 1, true, 1, 9});
+        scenarios++;
+    }
+    {
+        // Sequence 13 torn over the checkpoint at 5, the one at 9 still has the config
+        Ring ring(8);
+        wrapped(ring);
+        tear(ring.slot(13), makeRecord(13, JOURNAL_SHOT, 9, 1, 100), 12);
+        failures += expect("torn over the lap before", ring, {13, 7, 1, true, 1, 9});
+        scenarios++;
+    }
+    return failures;
+}
+
+// Randomized runs
+
+// What the records up to a sequence say about the session
+struct Truth {
+    bool active = false;
+    uint32_t sessionId = 0;
+    uint16_t totalShots = 0;
+    uint16_t nextShot = 0;
+};
+
+static bool resumable(const Truth& truth) {
+    return truth.active && truth.nextShot < truth.totalShots;
+}
+
+// Sessions as sessionJournalOnStatus() writes them: start, shots with a
+// checkpoint once `checkpointEvery` records passed since the last config,
+// and an end unless the log stops first. log[0] and truth[0] are the
+// empty journal.
+static void writeLog(uint32_t& state, uint32_t records, uint32_t checkpointEvery, std::vector<JournalRecord>& log,
+                     std::vector<Truth>& truth) {
+    log.assign(1, JournalRecord());
+    truth.assign(1, Truth());
+    
+    Truth current;
+    uint32_t lastConfig = 0;
+    while (log.size() <= records) {
+        uint32_t sequence = log.size();
+        JournalRecord record;
+        
+        if (!current.active) {
+            current.active = true;
+            current.sessionId = sequence;
+            current.totalShots = 1 + nextRandom(state) % 150;
+            current.nextShot = 0;
+            record = makeRecord(sequence, JOURNAL_SESSION_START, 0, current.sessionId, current.totalShots);
+        } else if (sequence - lastConfig >= checkpointEvery && log.back().type == JOURNAL_SHOT) {
+            record = makeRecord(sequence, JOURNAL_CHECKPOINT, current.nextShot, current.sessionId, current.totalShots);
+        } else if (current.nextShot == current.totalShots || nextRandom(state) % 200 == 0) {
+            // Completed, or stopped early
+            record = makeRecord(sequence, JOURNAL_SESSION_END, current.nextShot, current.sessionId, current.totalShots);
+            current.active = false;
+        } else {
+            record = makeRecord(sequence, JOURNAL_SHOT, current.nextShot, current.sessionId, current.totalShots);
+            current.nextShot++;
+        }
+        
+        if (record.type != JOURNAL_SHOT && record.type != JOURNAL_SESSION_END) lastConfig = sequence;
+        log.push_back(record);
+        truth.push_back(current);
+    }
+}
+
+// Whatever replay resumes must be a session the log started, with its
+// config and no shot it did not record by `newest`
+static const char* checkSafe(const JournalRecovery& got, const std::vector<JournalRecord>& log, uint32_t newest) {
+    if (!got.sessionActive) return nullptr;
+    if (got.sessionId == 0 || got.sessionId > newest || log[got.sessionId].type != JOURNAL_SESSION_START) {
+        return "resumed a session that was never started";
+    }
+    
+    const JournalRecord& start = log[got.sessionId];
+    if (got.startEpochMs != start.startEpochMs || got.intervalMs != start.intervalMs ||
+        got.totalShots != start.totalShots || got.minutes != start.minutes) {
+        return "resumed with another session's config";
+    }
+    
+    uint16_t recorded = 0;
+    for (uint32_t sequence = got.sessionId; sequence <= newest; sequence++) {
+        if (log[sequence].sessionId == got.sessionId && log[sequence].type == JOURNAL_SHOT) {
+            recorded = log[sequence].shot + 1;
+        }
+    }
+    if (got.nextShot > recorded) return "resumed past the last recorded shot";
+    return nullptr;
+}
+
+enum FaultMode : uint8_t {
+    FAULT_NONE = 0,
+    FAULT_TORN,         // Power cut inside the last batch
+    FAULT_CORRUPT,      // Bit flips in older slots
+    FAULT_STALE,        // Writes that never reached flash
+    FAULT_MODE_COUNT
+};
+
+static const char* runOnce(uint32_t seed, uint64_t& totalRecords) {
+    uint32_t state = seed * 2654435761u + 1;
+    
+    uint32_t capacity = 8 + nextRandom(state) % 57;
+    uint32_t checkpointEvery = capacity / 8 > 2 ? capacity / 8 : 2;
+    uint32_t records = 1 + nextRandom(state) % (4 * capacity);
+    FaultMode mode = (FaultMode)(nextRandom(state) % FAULT_MODE_COUNT);
+    
+    std::vector<JournalRecord> log;
+    std::vector<Truth> truth;
+    writeLog(state, records, checkpointEvery, log, truth);
+    totalRecords += records;
+    
+    std::vector<JournalRecord> ring(capacity, JournalRecord());
+    uint32_t written = records < capacity ? records : capacity;
+    uint32_t newest = records;
+    uint32_t expectedValid = written;
+    bool exact = mode == FAULT_NONE;
+    
+    if (mode == FAULT_TORN) {
+        // Everything before the torn record made it, nothing after it
+        uint32_t first = records > JOURNAL_BATCH_RECORDS ? records - JOURNAL_BATCH_RECORDS + 1 : 1;
+        uint32_t torn = first + nextRandom(state) % (records - first + 1);
+        for (uint32_t sequence = 1; sequence < torn; sequence++) ring[sequence % capacity] = log[sequence];
+        
+        JournalRecord& slot = ring[torn % capacity];
+        tear(slot, log[torn], 1 + nextRandom(state) % (sizeof(JournalRecord) - 1));
+        newest = sameRecord(slot, log[torn]) ? torn : torn - 1;
+        
+        // Over a zeroed slot nothing older is lost and replay must be exact
+        exact = torn <= capacity;
+        expectedValid = exact ? newest : UINT32_MAX;
+    } else {
+        for (uint32_t sequence = 1; sequence <= records; sequence++) ring[sequence % capacity] = log[sequence];
+    }
+    
+    if (mode == FAULT_CORRUPT || mode == FAULT_STALE) {
+        // Distinct slots of the window other than the newest record's
+        uint32_t count = 1 + nextRandom(state) % 3;
+        if (count > written - 1) count = written - 1;
+        std::vector<uint32_t> hit;
+        while (hit.size() < count) {
+            uint32_t sequence = records - 1 - nextRandom(state) % (written - 1);
+            bool seen = false;
+            for (uint32_t s : hit) seen = seen || s == sequence;
+            if (seen) continue;
+            hit.push_back(sequence);
+            
+            if (mode == FAULT_CORRUPT) {
+                flipBit(ring[sequence % capacity], nextRandom(state) % (sizeof(JournalRecord) * 8));
+            } else {
+                ring[sequence % capacity] = sequence > capacity ? log[sequence - capacity] : JournalRecord();
+            }
+        }
+        expectedValid = written - count;
+    }
+    
+    JournalRecovery got = journalRecover(ring.data(), capacity);
+    if (got.nextSequence != newest + 1) return "nextSequence is not past the newest intact record";
+    if (expectedValid != UINT32_MAX && got.validRecords != expectedValid) return "validRecords off";
+    
+    const char* violation = checkSafe(got, log, newest);
+    if (violation != nullptr) return violation;
+    
+    if (exact) {
+        const Truth& want = truth[newest];
+        if (got.sessionActive != resumable(want)) return "resumable session not resumed, or ended one resumed";
+        if (got.sessionActive && (got.sessionId != want.sessionId || got.nextShot != want.nextShot)) {
+            return "resumed at the wrong shot";
+        }
+        if (got.skippedRecords != 0 && mode == FAULT_NONE) return "intact records skipped";
+    }
+    return nullptr;
+}
+
+// Replay time of a full ring the size of the firmware's journal
+static void timeRecovery() {
+    std::vector<JournalRecord> log;
+    std::vector<Truth> truth;
+    uint32_t state = 12345;
+    uint32_t records = JOURNAL_CAPACITY * 3 + 17;
+    writeLog(state, records, JOURNAL_CHECKPOINT_EVERY, log, truth);
+    
+    std::vector<JournalRecord> ring(JOURNAL_CAPACITY);
+    for (uint32_t sequence = 1; sequence <= records; sequence++) ring[sequence % JOURNAL_CAPACITY] = log[sequence];
+    
+    const uint32_t rounds = 200;
+    uint32_t resumed = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) {
+        resumed += journalRecover(ring.data(), JOURNAL_CAPACITY).sessionActive;
+    }
+    double recoverUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / rounds;
+    printf("journal capacity=%lu recover_us=%.1f resumed=%lu\n", (unsigned long)JOURNAL_CAPACITY, recoverUs,
+           (unsigned long)(resumed / rounds));
+}
+
+int runJournalBench(uint32_t runs, uint32_t seed) {
+    uint32_t scenarios = 0;
+    uint32_t failures = runScenarios(scenarios);
+    uint64_t records = 0;
+    auto begin = std::chrono::steady_clock::now();
+    
+    for (uint32_t r = 0; r < runs; r++) {
+        const char* violation = runOnce(seed + r, records);
+        if (violation != nullptr) {
+            failures++;
+            printf("FAIL run %lu (seed %lu): %s\n", (unsigned long)r, (unsigned long)(seed + r), violation);
+        }
+    }
+    
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    printf("journal scenarios=%lu runs=%lu failures=%lu records=%llu wall_ms=%.1f\n", (unsigned long)scenarios,
+           (unsigned long)runs, (unsigned long)failures, (unsigned long long)records, wallMs);
+    
+    timeRecovery();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+#ifndef SIM_JOURNAL_H
+#define SIM_JOURNAL_H
+
+#include <stdint.h>
+
+// Journal replay checks on the host (sim_journal.cpp). Hand-built rings
+// with torn, CRC-corrupted, stale and misplaced slots, and rings that
+// wrapped with and without a surviving checkpoint, are replayed and every
+// field journalRecover() returns is compared. Randomized runs then write
+// sessions the way session_journal.cpp does, in batches over rings of
+// varying size, tear the last batch, flip bits or drop writes, and check
+// that replay never resumes a session further or differently than the
+// intact records say.
+
+// 0 if every scenario and run gave the expected recovery
+int runJournalBench(uint32_t runs, uint32_t seed);
+
+#endif // SIM_JOURNAL_H
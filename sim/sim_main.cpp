@@ -0,0 +1,326 @@
+// AstroController session simulator
+//
+//   pio run -e native && .pio/build/native/program [options]
+//
+//   --minutes N        Session length (default 60)
+//   --sequence PHASES  Comma separated phases instead of --minutes:
+//                      fixed:N:MS  ramp:N:FROM:TO  exp:N:FROM:TO  pause:MS  burst:N:MS
+//   --profile KEY      Camera IR profile (sony, canon, nikon, ...), sets the on-air time
+//   --start-clock MS   Virtual millis() at start, e.g. 4294900000 to cross wraparound
+//   --jitter MS        Random wake-up latency per scheduler event
+//   --sleep US         Light sleep between shots, waking up to US late
+//   --stop-after MS    Stop the session after MS
+//   --burst N,SPACING,AT  Submit an N shot burst AT ms into the session
+//   --seed N           PRNG seed
+//   --csv              Print scheduled/actual time of every session shot,
+//                      with --temp-replay every filtered reading
+//   --bench N          Run N randomized sessions and check scheduling invariants
+//   --sync-nodes N     Run a leader and N-1 followers over loopback multicast instead
+//   --sync-seconds S   Length of the sync run (default 5)
+//   --sync-jitter US   Random extra network delay per beacon
+//   --temp-replay FILE Run recorded "ms,celsius" conversions through the temperature filter
+//   --temp-bench N     Run N randomized temperature streams and check the filter output
+//   --wheel-bench N    Run N randomized timer wheel runs against a reference, then time it
+//   --journal-bench N  Replay damaged journal rings, then N randomized rings with torn,
+//                      corrupted and lost writes, and check what would be resumed
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "session.h"
+#include "simulator.h"
+#include "sim_sync.h"
+#include "sim_journal.h"
+#include "sim_temperature.h"
+#include "sim_wheel.h"
+
+static uint32_t benchRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Planned session length, from the compiled sequence
+static uint32_t plannedDurationMs(const SimConfig& config) {
+    SequencePlan plan = config.plan;
+    if (plan.phaseCount == 0) sessionPlanForMinutes(plan, config.minutes);
+    
+    SequenceSummary summary;
+    sequenceCompile(plan, SESSION_START_DELAY_MS, nullptr, 0, summary);
+    return summary.durationMs;
+}
+
+// Parses the --sequence syntax; false on a malformed phase
+static bool parseSequence(const char* text, SequencePlan& plan) {
+    plan = SequencePlan();
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    
+    for (char* item = strtok(buffer, ","); item != nullptr; item = strtok(nullptr, ",")) {
+        if (plan.phaseCount >= MAX_SEQUENCE_PHASES) return false;
+        SequencePhase& phase = plan.phases[plan.phaseCount++];
+        unsigned shots = 0;
+        unsigned long a = 0;
+        unsigned long b = 0;
+        
+        if (sscanf(item, "fixed:%u:%lu", &shots, &a) == 2) {
+            phase.type = PHASE_FIXED;
+        } else if (sscanf(item, "burst:%u:%lu", &shots, &a) == 2) {
+            phase.type = PHASE_BURST;
+        } else if (sscanf(item, "ramp:%u:%lu:%lu", &shots, &a, &b) == 3) {
+            phase.type = PHASE_RAMP_LINEAR;
+        } else if (sscanf(item, "exp:%u:%lu:%lu", &shots, &a, &b) == 3) {
+            phase.type = PHASE_RAMP_EXP;
+        } else if (sscanf(item, "pause:%lu", &a) == 1) {
+            phase.type = PHASE_PAUSE;
+            phase.durationMs = a;
+            continue;
+        } else {
+            return false;
+        }
+        phase.shots = shots;
+        phase.intervalMs = a;
+        phase.endIntervalMs = b;
+    }
+    return plan.phaseCount > 0;
+}
+
+// Random mix of shot phases and pauses
+static void randomSequence(SequencePlan& plan, uint32_t& rng) {
+    plan = SequencePlan();
+    plan.phaseCount = 1 + benchRandom(rng) % MAX_SEQUENCE_PHASES;
+    
+    for (uint8_t p = 0; p < plan.phaseCount; p++) {
+        SequencePhase& phase = plan.phases[p];
+        phase.type = (PhaseType)(benchRandom(rng) % (PHASE_BURST + 1));
+        phase.shots = 1 + benchRandom(rng) % 300;
+        phase.intervalMs = MIN_SEQUENCE_INTERVAL_MS + benchRandom(rng) % 60000;
+        phase.endIntervalMs = MIN_SEQUENCE_INTERVAL_MS + benchRandom(rng) % 60000;
+        phase.durationMs = benchRandom(rng) % 600000;
+        if (phase.type == PHASE_BURST) phase.intervalMs = MIN_SEQUENCE_INTERVAL_MS + benchRandom(rng) % 2000;
+    }
+    // A pause-only plan has nothing to shoot
+    plan.phases[0].type = PHASE_FIXED;
+}
+
+static void printResult(const SimConfig& config, const SimResult& result) {
+    if (config.plan.phaseCount > 0) {
+        printf("phases=%u start_clock=%lu jitter=%lu\n", config.plan.phaseCount,
+               (unsigned long)config.startClock, (unsigned long)config.wakeJitterMs);
+    } else {
+        printf("minutes=%u start_clock=%lu jitter=%lu\n", config.minutes,
+               (unsigned long)config.startClock, (unsigned long)config.wakeJitterMs);
+    }
+    printf("shots=%u/%u missed=%lu job_shots=%lu completed=%s\n", result.sessionShots, result.expectedShots,
+           (unsigned long)result.missedShots, (unsigned long)result.jobShots, result.completed ? "yes" : "no");
+    printf("max_drift_ms=%lu p99_lateness_ms=%lu virtual_ms=%lu steps=%lu\n", (unsigned long)result.maxDriftMs,
+           (unsigned long)result.p99LatenessMs, (unsigned long)result.durationMs, (unsigned long)result.steps);
+    if (config.lightSleep) {
+        const IdleSleepStats& sleep = result.sleep;
+        printf("sleeps=%lu asleep=%.1f%% wake_latency_max_us=%lu margin_us=%lu late_wakeups=%lu avg_current_ma=%.1f\n",
+               (unsigned long)sleep.sleeps, result.durationMs ? sleep.sleptUs / 10.0 / result.durationMs : 0.0,
+               (unsigned long)sleep.wakeLatencyMaxUs, (unsigned long)sleep.marginUs,
+               (unsigned long)sleep.lateWakeups, result.avgCurrentUa / 1000.0);
+    }
+}
+
+// Checks that hold for every session; returns the first violation or nullptr
+static const char* checkInvariants(const SimConfig& config, const SimResult& result) {
+    if (config.stopAfterMs == 0) {
+        if (!result.completed) return "session did not complete";
+        if (result.sessionShots + result.missedShots != result.expectedShots) return "shot count mismatch";
+    } else if (result.sessionShots + result.missedShots > result.expectedShots) {
+        return "more shots than scheduled";
+    }
+    
+    // Wakeups within the initial margin never make a shot late
+    bool sleepOnTime = !config.lightSleep || config.sleepLatencyUs <= IDLE_WAKE_MARGIN_US;
+    if (sleepOnTime && result.sleep.lateWakeups != 0) return "woke up after the deadline";
+    
+    // A late shot must be off the air before the next deadline for these to hold
+    if (sleepOnTime && config.wakeJitterMs + MIN_SEQUENCE_INTERVAL_MS <= result.minIntervalMs) {
+        if (result.missedShots != 0) return "shots missed without overload";
+        if (result.maxDriftMs > config.wakeJitterMs) return "drift exceeds wake-up jitter";
+    }
+    
+    for (size_t i = 1; i < result.shots.size(); i++) {
+        if ((int32_t)(result.shots[i].actual - result.shots[i - 1].actual) <= 0) return "shots out of order";
+    }
+    
+    if (config.burstCount > 0 && config.stopAfterMs == 0 && result.jobShots != config.burstCount) {
+        return "burst shots lost";
+    }
+    return nullptr;
+}
+
+static int runBenchmark(uint32_t runs, uint32_t seed) {
+    uint32_t rng = seed ? seed : 1;
+    uint32_t failures = 0;
+    uint64_t virtualMs = 0;
+    uint64_t shots = 0;
+    
+    auto begin = std::chrono::steady_clock::now();
+    
+    for (uint32_t run = 0; run < runs; run++) {
+        SimConfig config;
+        config.minutes = 1 + benchRandom(rng) % MAX_SESSION_MINUTES;
+        if (benchRandom(rng) % 3 == 0) randomSequence(config.plan, rng);
+        uint32_t durationMs = plannedDurationMs(config);
+        config.startClock = benchRandom(rng);
+        config.irProfile = (IrProfileId)(benchRandom(rng) % IR_PROFILE_COUNT);
+        config.wakeJitterMs = benchRandom(rng) % 4 == 0 ? benchRandom(rng) % 50 : 0;
+        config.seed = benchRandom(rng);
+        if (benchRandom(rng) % 4 == 0) {
+            config.lightSleep = true;
+            config.sleepLatencyUs = benchRandom(rng) % (IDLE_WAKE_MARGIN_US + 1);
+        }
+        if (benchRandom(rng) % 5 == 0) {
+            config.stopAfterMs = benchRandom(rng) % durationMs;
+        }
+        if (benchRandom(rng) % 3 == 0) {
+            config.burstCount = 1 + benchRandom(rng) % 20;
+            config.burstSpacingMs = 200 + benchRandom(rng) % 2000;
+            config.burstAtMs = benchRandom(rng) % durationMs;
+        }
+        
+        SimResult result = simulateSession(config);
+        virtualMs += result.durationMs;
+        shots += result.sessionShots;
+        
+        const char* violation = checkInvariants(config, result);
+        if (violation) {
+            failures++;
+            printf("FAIL run %lu: %s\n", (unsigned long)run, violation);
+            printResult(config, result);
+        }
+    }
+    
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    printf("runs=%lu failures=%lu shots=%llu virtual_hours=%.1f wall_ms=%.1f speedup=%.0fx\n",
+           (unsigned long)runs, (unsigned long)failures, (unsigned long long)shots,
+           virtualMs / 3600000.0, wallMs, wallMs > 0 ? virtualMs / wallMs : 0.0);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    bool csv = false;
+    uint32_t benchRuns = 0;
+    SyncSimConfig syncConfig;
+    bool syncRun = false;
+    const char* tempReplay = nullptr;
+    uint32_t tempBenchRuns = 0;
+    uint32_t wheelBenchRuns = 0;
+    uint32_t journalBenchRuns = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        
+        if (strcmp(arg, "--csv") == 0) {
+            csv = true;
+        } else if (value == nullptr) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return 2;
+        } else if (strcmp(arg, "--minutes") == 0) {
+            config.minutes = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--sequence") == 0) {
+            if (!parseSequence(value, config.plan)) {
+                fprintf(stderr, "Invalid sequence %s\n", value);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--profile") == 0) {
+            if (!irProfileFind(value, config.irProfile)) {
+                fprintf(stderr, "Unknown IR profile %s\n", value);
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--start-clock") == 0) {
+            config.startClock = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--jitter") == 0) {
+            config.wakeJitterMs = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--sleep") == 0) {
+            config.lightSleep = true;
+            config.sleepLatencyUs = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--stop-after") == 0) {
+            config.stopAfterMs = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--burst") == 0) {
+            unsigned count = 0;
+            unsigned long spacing = 0;
+            unsigned long at = 0;
+            sscanf(value, "%u,%lu,%lu", &count, &spacing, &at);
+            config.burstCount = count;
+            config.burstSpacingMs = spacing;
+            config.burstAtMs = at;
+            i++;
+        } else if (strcmp(arg, "--seed") == 0) {
+            config.seed = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--sync-nodes") == 0) {
+            syncConfig.nodes = strtoul(value, nullptr, 0); i++;
+            syncRun = true;
+        } else if (strcmp(arg, "--sync-seconds") == 0) {
+            syncConfig.seconds = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--sync-jitter") == 0) {
+            syncConfig.delayJitterUs = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--bench") == 0) {
+            benchRuns = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--temp-replay") == 0) {
+            tempReplay = value; i++;
+        } else if (strcmp(arg, "--temp-bench") == 0) {
+            tempBenchRuns = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--wheel-bench") == 0) {
+            wheelBenchRuns = strtoul(value, nullptr, 0); i++;
+        } else if (strcmp(arg, "--journal-bench") == 0) {
+            journalBenchRuns = strtoul(value, nullptr, 0); i++;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            return 2;
+        }
+    }
+    
+    if (benchRuns > 0) return runBenchmark(benchRuns, config.seed);
+    if (tempBenchRuns > 0) return runTemperatureBench(tempBenchRuns, config.seed);
+    if (tempReplay != nullptr) return runTemperatureReplay(tempReplay, csv);
+    if (wheelBenchRuns > 0) return runWheelBench(wheelBenchRuns, config.seed);
+    if (journalBenchRuns > 0) return runJournalBench(journalBenchRuns, config.seed);
+    if (syncRun) {
+        syncConfig.seed = config.seed;
+        return runSyncSimulation(syncConfig);
+    }
+    
+    SequenceSummary summary;
+    if (config.plan.phaseCount > 0) {
+        SequenceError error = sequenceCompile(config.plan, SESSION_START_DELAY_MS, nullptr, 0, summary);
+        if (error != SEQUENCE_OK) {
+            fprintf(stderr, "%s\n", sequenceErrorText(error));
+            return 2;
+        }
+    } else if (config.minutes < 1 || config.minutes > MAX_SESSION_MINUTES) {
+        fprintf(stderr, "Minutes must be 1-%u\n", MAX_SESSION_MINUTES);
+        return 2;
+    }
+    
+    SimResult result = simulateSession(config);
+    
+    if (csv) {
+        printf("shot,scheduled_ms,actual_ms,late_ms\n");
+        for (size_t i = 0; i < result.shots.size(); i++) {
+            const SimShot& shot = result.shots[i];
+            printf("%lu,%lu,%lu,%lu\n", (unsigned long)i, (unsigned long)shot.scheduled,
+                   (unsigned long)shot.actual, (unsigned long)(shot.actual - shot.scheduled));
+        }
+    }
+    printResult(config, result);
+    
+    const char* violation = checkInvariants(config, result);
+    if (violation) {
+        printf("FAIL: %s\n", violation);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+// Shot telemetry for the simulator: replaces src/shot_log.cpp. Shot timing
+// is already checked through the mock IR sink, so records are dropped.
+
+#include "shot_log.h"
+
+bool shotLogBegin() {
+    return true;
+}
+
+void shotLogRecord(ShotRecord&) {
+}
+
+void shotLogRange(uint32_t& first, uint32_t& next) {
+    first = 1;
+    next = 1;
+}
+
+bool shotLogRead(uint32_t, ShotRecord&) {
+    return false;
+}
+
+uint32_t shotLogCapacity() {
+    return 0;
+}
@@ -0,0 +1,225 @@
+#include "sim_sync.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "clock_sync.h"
+#include "session.h"
+
+struct SimNode {
+    uint32_t nodeId;
+    int fd;
+    int64_t offsetUs;               // Node clock at host time 0
+    int32_t skewPpb;                // Node rate minus host rate
+    uint32_t seq;
+    ClockSync clock;
+};
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static int64_t hostUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t nodeClock(const SimNode& node, int64_t host) {
+    return node.offsetUs + host + host * node.skewPpb / 1000000000;
+}
+
+// Host time at which `node` reads `localUs`
+static int64_t hostTimeOf(const SimNode& node, int64_t localUs) {
+    return (localUs - node.offsetUs) * 1000000000 / (1000000000 + node.skewPpb);
+}
+
+static int openSocket() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(SYNC_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    
+    in_addr loopback;
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    ip_mreq membership = {};
+    memcpy(&membership.imr_multiaddr, SYNC_GROUP, 4);
+    membership.imr_interface = loopback;
+    unsigned char loop = 1;
+    
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &loopback, sizeof(loopback)) < 0 ||
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+static void sendPacket(const SimNode& node, const SyncPacket& packet) {
+    uint8_t buffer[SYNC_MAX_PACKET];
+    size_t len = syncEncode(packet, buffer, sizeof(buffer));
+    
+    sockaddr_in group = {};
+    group.sin_family = AF_INET;
+    group.sin_port = htons(SYNC_PORT);
+    memcpy(&group.sin_addr, SYNC_GROUP, 4);
+    sendto(node.fd, buffer, len, 0, (sockaddr*)&group, sizeof(group));
+}
+
+int runSyncSimulation(const SyncSimConfig& config) {
+    uint32_t rng = config.seed ? config.seed : 1;
+    std::vector<SimNode> nodes(config.nodes < 2 ? 2 : config.nodes);
+    
+    for (size_t i = 0; i < nodes.size(); i++) {
+        SimNode& node = nodes[i];
+        node.nodeId = 0x1000 + i;
+        node.fd = openSocket();
+        node.offsetUs = nextRandom(rng) % 3600000000u;
+        node.skewPpb = (int32_t)(nextRandom(rng) % 100001) - 50000;
+        node.seq = 0;
+        if (node.fd < 0) {
+            perror("Multicast socket on loopback");
+            return 2;
+        }
+    }
+    
+    // The leader starts a session with the run. One shot per second, so the
+    // checked deadline is at most a beacon period of the firmware ahead, as
+    // far as a follower ever projects its estimate.
+    SimNode& leader = nodes[0];
+    SequencePlan plan;
+    sequenceFixed(plan, 3600, 1000);
+    static uint32_t offsets[MAX_SEQUENCE_SHOTS];
+    SequenceSummary summary;
+    sequenceCompile(plan, SESSION_START_DELAY_MS, offsets, MAX_SEQUENCE_SHOTS, summary);
+    
+    int64_t begin = hostUs();
+    uint32_t leaderStartMs = (uint32_t)(nodeClock(leader, begin) / 1000);
+    int64_t leaderStartUs = syncStartUs(nodeClock(leader, begin), leaderStartMs);
+    
+    SyncFollower followers[SYNC_MAX_FOLLOWERS];
+    std::vector<pollfd> fds(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) fds[i] = {nodes[i].fd, POLLIN, 0};
+    
+    int64_t end = begin + (int64_t)config.seconds * 1000000;
+    int64_t nextBeacon = begin;
+    int64_t nextReport = begin + (int64_t)config.reportMs * 1000;
+    
+    for (int64_t now = begin; now < end; now = hostUs()) {
+        if (now >= nextBeacon) {
+            nextBeacon += (int64_t)config.beaconMs * 1000;
+            SyncPacket beacon;
+            beacon.type = SYNC_BEACON;
+            beacon.nodeId = leader.nodeId;
+            beacon.seq = ++leader.seq;
+            beacon.sessionRunning = true;
+            beacon.sessionStartUs = leaderStartUs;
+            beacon.plan = plan;
+            beacon.sentUs = nodeClock(leader, hostUs());
+            sendPacket(leader, beacon);
+        }
+        if (now >= nextReport) {
+            nextReport += (int64_t)config.reportMs * 1000;
+            for (size_t i = 1; i < nodes.size(); i++) {
+                SyncPacket report;
+                report.type = SYNC_REPORT;
+                report.nodeId = nodes[i].nodeId;
+                report.seq = ++nodes[i].seq;
+                report.leaderId = nodes[i].clock.leaderId;
+                report.offsetUs = nodes[i].clock.offsetUs;
+                report.jitterUs = nodes[i].clock.jitterUs;
+                report.skewPpb = nodes[i].clock.skewPpb;
+                report.samples = nodes[i].clock.count;
+                report.following = clockSyncReady(nodes[i].clock);
+                report.sentUs = nodeClock(nodes[i], hostUs());
+                sendPacket(nodes[i], report);
+            }
+        }
+        
+        if (poll(fds.data(), fds.size(), 1) <= 0) continue;
+        
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            
+            uint8_t buffer[SYNC_MAX_PACKET];
+            ssize_t len;
+            while ((len = recv(nodes[i].fd, buffer, sizeof(buffer), 0)) > 0) {
+                int64_t localUs = nodeClock(nodes[i], hostUs());
+                SyncPacket packet;
+                if (!syncDecode(buffer, len, packet) || packet.nodeId == nodes[i].nodeId) continue;
+                
+                if (i > 0 && packet.type == SYNC_BEACON) {
+                    if (config.delayJitterUs > 0) localUs += nextRandom(rng) % (config.delayJitterUs + 1);
+                    clockSyncAddSample(nodes[i].clock, packet.nodeId, packet.seq, packet.sentUs, localUs);
+                } else if (i == 0 && packet.type == SYNC_REPORT && packet.leaderId == leader.nodeId) {
+                    syncFollowerUpdate(followers, SYNC_MAX_FOLLOWERS, packet, (uint32_t)(localUs / 1000));
+                }
+            }
+        }
+    }
+    
+    // Next leader shot after the run, and when each follower would take it
+    int64_t now = hostUs();
+    int64_t leaderNowMs = nodeClock(leader, now) / 1000;
+    uint16_t slot = 0;
+    while (slot + 1 < summary.shots && (int32_t)(leaderStartMs + offsets[slot] - (uint32_t)leaderNowMs) <= 0) slot++;
+    int64_t leaderShotHost = hostTimeOf(leader, leaderStartUs + (int64_t)offsets[slot] * 1000);
+    
+    int result = 0;
+    printf("leader=%lx followers=%u next_shot=%u\n", (unsigned long)leader.nodeId, (unsigned)nodes.size() - 1, slot);
+    
+    for (size_t i = 1; i < nodes.size(); i++) {
+        const SimNode& node = nodes[i];
+        int64_t localNowUs = nodeClock(node, now);
+        int64_t trueOffset = nodeClock(leader, now) - localNowUs;
+        int64_t error = clockSyncOffsetAt(node.clock, localNowUs) - trueOffset;
+        
+        // Same arithmetic as the follower's CMD_SYNC_SESSION and session deadlines
+        int64_t localNowMs = localNowUs / 1000;
+        uint32_t startMs = syncLocalStartMs(node.clock, leaderStartUs, localNowUs);
+        int32_t untilShot = (int32_t)(startMs + offsets[slot] - (uint32_t)localNowMs);
+        int64_t shotHost = hostTimeOf(node, (localNowMs + untilShot) * 1000);
+        int64_t shotError = shotHost - leaderShotHost;
+        
+        double trueSkewPpm = (int64_t)(leader.skewPpb - node.skewPpb) / 1000.0;
+        printf("node=%lx samples=%u offset_us=%lld error_us=%lld jitter_us=%lu skew_ppm=%.1f true_skew_ppm=%.1f shot_error_us=%lld\n",
+               (unsigned long)node.nodeId, node.clock.count, (long long)node.clock.offsetUs, (long long)error,
+               (unsigned long)node.clock.jitterUs, node.clock.skewPpb / 1000.0, trueSkewPpm, (long long)shotError);
+        
+        if (!clockSyncReady(node.clock) || shotError > SYNC_SIM_TOLERANCE_US || shotError < -SYNC_SIM_TOLERANCE_US) {
+            printf("FAIL: node %lx is out of sync\n", (unsigned long)node.nodeId);
+            result = 1;
+        }
+    }
+    
+    // What the leader shows at /api/sync
+    for (const SyncFollower& follower : followers) {
+        if (follower.nodeId == 0) continue;
+        printf("leader_view node=%lx offset_us=%lld jitter_us=%lu samples=%u\n", (unsigned long)follower.nodeId,
+               (long long)follower.offsetUs, (unsigned long)follower.jitterUs, follower.samples);
+    }
+    
+    for (const SimNode& node : nodes) close(node.fd);
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef SIM_SYNC_H
+#define SIM_SYNC_H
+
+#include <stdint.h>
+
+// Leader/follower sync with several nodes on one Linux host (sim_sync.cpp).
+// Every node has its own clock, offset and running at a slightly different
+// rate from the host clock, and its own UDP socket in the sync multicast
+// group on loopback. Node 0 leads a session, the others follow through the
+// firmware's clock_sync.h code. Only the host knows the true clocks, so the
+// followers' estimates and shot deadlines can be checked against them.
+
+struct SyncSimConfig {
+    uint8_t nodes = 3;
+    uint32_t seconds = 5;
+    uint32_t beaconMs = 100;        // Faster than the firmware to keep runs short
+    uint32_t reportMs = 1000;
+    uint32_t delayJitterUs = 0;     // Random extra delay added to received beacons
+    uint32_t seed = 1;
+};
+
+// Prints one line per follower; 0 if every follower's next shot deadline
+// is within SYNC_SIM_TOLERANCE_US of the leader's, 2 if sockets failed
+const int64_t SYNC_SIM_TOLERANCE_US = 1000;
+int runSyncSimulation(const SyncSimConfig& config);
+
+#endif // SIM_SYNC_H
@@ -0,0 +1,246 @@
+#include "sim_temperature.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "temperature_filter.h"
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Uniform in [0, 1)
+static double uniform(uint32_t& state) {
+    return (nextRandom(state) >> 8) / 16777216.0;
+}
+
+// Roughly normal, sum of four uniforms scaled to unit variance
+static double gaussian(uint32_t& state) {
+    double sum = uniform(state) + uniform(state) + uniform(state) + uniform(state);
+    return (sum - 2.0) * sqrt(3.0);
+}
+
+static void printMinute(const TemperatureMinute& minute) {
+    printf("%lu,%.2f,%.2f,%.2f,%u\n", (unsigned long)minute.startMs, minute.meanCenti / 100.0,
+           minute.minCenti / 100.0, minute.maxCenti / 100.0, minute.readings);
+}
+
+int runTemperatureReplay(const char* path, bool csv) {
+    FILE* in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (in == nullptr) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 2;
+    }
+    
+    TemperatureFilter filter;
+    int32_t block[TEMP_OVERSAMPLE];
+    uint8_t filled = 0;
+    uint32_t dropped = 0;
+    uint32_t rejected = 0;
+    uint32_t minutes = 0;
+    
+    if (csv) printf("reading_ms,raw_c,filtered_c\n");
+    else printf("start_ms,mean_c,min_c,max_c,readings\n");
+    
+    char line[128];
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        unsigned long ms = 0;
+        double celsius = 0;
+        // Headers and comments do not parse
+        if (sscanf(line, "%lu,%lf", &ms, &celsius) != 2) continue;
+        
+        block[filled++] = (int32_t)lround(celsius * 1000.0);
+        if (filled < TEMP_OVERSAMPLE) continue;
+        filled = 0;
+        
+        uint8_t blockRejected = 0;
+        int32_t reading = temperatureOversample(block, TEMP_OVERSAMPLE, blockRejected);
+        rejected += blockRejected;
+        if (reading == TEMP_INVALID_MILLI) {
+            dropped++;
+            continue;
+        }
+        
+        TemperatureMinute minute;
+        bool closed = temperatureFilterAdd(filter, ms, reading, minute);
+        if (csv) {
+            printf("%lu,%.3f,%.3f\n", ms, reading / 1000.0, temperatureFilterValue(filter) / 1000.0);
+        } else if (closed) {
+            printMinute(minute);
+        }
+        if (closed) minutes++;
+    }
+    if (in != stdin) fclose(in);
+    
+    fprintf(stderr, "readings=%lu dropped=%lu rejected_conversions=%lu restarts=%lu minutes=%lu\n",
+            (unsigned long)filter.readings, (unsigned long)dropped, (unsigned long)rejected,
+            (unsigned long)filter.restarts, (unsigned long)minutes);
+    return 0;
+}
+
+struct TempBenchRun {
+    uint32_t startClock;
+    uint32_t readings;              // Reading slots, one per TEMP_SAMPLE_MS
+    double startC;
+    double driftCPerHour;
+    double stepC;                   // Applied at stepAt
+    uint32_t stepAt;
+    double noiseC;                  // Standard deviation per conversion
+    double spikeChance;             // Per conversion
+    double dropoutChance;           // Per conversion, sensor returns garbage
+    uint32_t gaps;                  // Planned gaps, some longer than TEMP_STALE_MS
+};
+
+// Checks one run; returns the first violation or nullptr
+static const char* benchRun(const TempBenchRun& run, uint32_t& rng, uint64_t& readingsOut, double& worstErrorC) {
+    TemperatureFilter filter;
+    int32_t block[TEMP_OVERSAMPLE];
+    
+    // Floating-point reference of the same filter
+    bool refPrimed = false;
+    double ref = 0;
+    const double alpha = 1.0 / (1 << TEMP_IIR_SHIFT);
+    const uint32_t settleReadings = 8 << TEMP_IIR_SHIFT;     // Steps decay below 0.03%
+    
+    // Gap plan: reading slots skipped
+    uint32_t gapStart[8];
+    uint32_t gapLength[8];
+    uint32_t gaps = run.gaps < 8 ? run.gaps : 8;
+    uint32_t expectedRestarts = 0;
+    for (uint32_t g = 0; g < gaps; g++) {
+        gapStart[g] = nextRandom(rng) % run.readings;
+        gapLength[g] = nextRandom(rng) % 2 ? 1 + nextRandom(rng) % 8 : 15 + nextRandom(rng) % 120;
+    }
+    
+    uint32_t sinceStart = 0;        // Readings since the filter (re)started or the step
+    bool stepped = false;
+    uint32_t lastReadingMs = 0;
+    bool anyReading = false;
+    uint32_t firstMs = 0;
+    uint32_t openMinute = 0;
+    uint32_t expectedMinutes = 0;
+    uint32_t minutes = 0;
+    uint32_t lastMinuteStart = 0;
+    uint64_t minuteReadings = 0;
+    // Noise left after the trimmed mean and the IIR (variance alpha / (2 - alpha)),
+    // plus the filter lag behind the drift and the reading quantization
+    double alphaNoise = sqrt(alpha / (2.0 - alpha) / (TEMP_OVERSAMPLE - 2 * TEMP_TRIM));
+    double lagC = fabs(run.driftCPerHour) / 3600.0 * (TEMP_SAMPLE_MS / 1000.0) * (1 << TEMP_IIR_SHIFT);
+    double bound = 0.05 + 7.0 * run.noiseC * alphaNoise + 1.5 * lagC;
+    
+    for (uint32_t slot = 0; slot < run.readings; slot++) {
+        bool skipped = false;
+        for (uint32_t g = 0; g < gaps; g++) {
+            if (slot >= gapStart[g] && slot < gapStart[g] + gapLength[g]) skipped = true;
+        }
+        if (skipped) continue;
+        
+        uint32_t now = run.startClock + slot * TEMP_SAMPLE_MS;
+        double hours = slot * (TEMP_SAMPLE_MS / 3600000.0);
+        double trueC = run.startC + run.driftCPerHour * hours + (slot >= run.stepAt ? run.stepC : 0.0);
+        
+        for (uint8_t i = 0; i < TEMP_OVERSAMPLE; i++) {
+            double value = trueC + run.noiseC * gaussian(rng);
+            if (uniform(rng) < run.spikeChance) value += uniform(rng) < 0.5 ? 5.0 : -5.0;
+            if (uniform(rng) < run.dropoutChance) value = -127.0;     // Disconnected 1-Wire style reading
+            block[i] = (int32_t)lround(value * 1000.0);
+        }
+        uint8_t rejected = 0;
+        int32_t reading = temperatureOversample(block, TEMP_OVERSAMPLE, rejected);
+        if (reading == TEMP_INVALID_MILLI) continue;
+        
+        if (anyReading && now - lastReadingMs > TEMP_STALE_MS) {
+            expectedRestarts++;
+            refPrimed = false;
+        }
+        if (!anyReading) firstMs = now;
+        if (!refPrimed) sinceStart = 0;
+        if (!stepped && slot >= run.stepAt) {
+            stepped = true;
+            sinceStart = 0;
+        }
+        
+        ref = refPrimed ? ref + (reading - ref) * alpha : reading;
+        refPrimed = true;
+        
+        // Closed minutes: every grid minute that had readings, except the open one
+        uint32_t minuteIndex = (now - firstMs) / TEMP_MINUTE_MS;
+        if (anyReading && minuteIndex != openMinute) expectedMinutes++;
+        openMinute = minuteIndex;
+        anyReading = true;
+        lastReadingMs = now;
+        
+        TemperatureMinute minute;
+        if (temperatureFilterAdd(filter, now, reading, minute)) {
+            minutes++;
+            minuteReadings += minute.readings;
+            if ((minute.startMs - firstMs) % TEMP_MINUTE_MS != 0) return "minute off the grid";
+            if (minutes > 1 && (int32_t)(minute.startMs - lastMinuteStart) <= 0) return "minutes out of order";
+            if (minute.minCenti > minute.meanCenti || minute.meanCenti > minute.maxCenti) return "minute mean outside min/max";
+            if (minute.readings > TEMP_MINUTE_MS / TEMP_SAMPLE_MS) return "too many readings in a minute";
+            lastMinuteStart = minute.startMs;
+        }
+        
+        int32_t filtered = temperatureFilterValue(filter);
+        if (fabs(filtered - ref) > 1.0) return "fixed-point filter departs from reference";
+        
+        if (++sinceStart > settleReadings) {
+            double error = fabs(filtered / 1000.0 - trueC);
+            if (error > worstErrorC) worstErrorC = error;
+            if (error > bound) return "filtered value off the true temperature";
+        }
+    }
+    
+    readingsOut += filter.readings;
+    if (minutes != expectedMinutes) return "closed minute count mismatch";
+    if (filter.restarts != expectedRestarts) return "restart count mismatch";
+    if (minuteReadings > filter.readings) return "minute readings exceed readings";
+    return nullptr;
+}
+
+int runTemperatureBench(uint32_t runs, uint32_t seed) {
+    uint32_t rng = seed ? seed : 1;
+    uint32_t failures = 0;
+    uint64_t readings = 0;
+    double worstErrorC = 0;
+    
+    auto begin = std::chrono::steady_clock::now();
+    
+    for (uint32_t r = 0; r < runs; r++) {
+        TempBenchRun run;
+        run.startClock = nextRandom(rng);
+        run.readings = 600 + nextRandom(rng) % (3 * 3600);
+        run.startC = -10.0 + uniform(rng) * 40.0;
+        run.driftCPerHour = (uniform(rng) - 0.5) * 10.0;
+        run.stepC = nextRandom(rng) % 4 == 0 ? (uniform(rng) - 0.5) * 20.0 : 0.0;
+        run.stepAt = nextRandom(rng) % run.readings;
+        run.noiseC = uniform(rng) * 0.5;
+        run.spikeChance = nextRandom(rng) % 2 ? uniform(rng) * 0.003 : 0.0;
+        run.dropoutChance = nextRandom(rng) % 4 == 0 ? uniform(rng) * 0.05 : 0.0;
+        run.gaps = nextRandom(rng) % 3 == 0 ? 1 + nextRandom(rng) % 4 : 0;
+        
+        double runWorst = 0;
+        const char* violation = benchRun(run, rng, readings, runWorst);
+        if (runWorst > worstErrorC) worstErrorC = runWorst;
+        if (violation) {
+            failures++;
+            printf("FAIL run %lu: %s\n", (unsigned long)r, violation);
+            printf("start_clock=%lu readings=%lu start_c=%.2f drift_c_per_h=%.2f step_c=%.2f@%lu noise_c=%.3f "
+                   "spikes=%.4f dropouts=%.3f gaps=%lu\n",
+                   (unsigned long)run.startClock, (unsigned long)run.readings, run.startC, run.driftCPerHour,
+                   run.stepC, (unsigned long)run.stepAt, run.noiseC, run.spikeChance, run.dropoutChance,
+                   (unsigned long)run.gaps);
+        }
+    }
+    
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    printf("temperature runs=%lu failures=%lu readings=%llu worst_error_c=%.3f wall_ms=%.1f\n",
+           (unsigned long)runs, (unsigned long)failures, (unsigned long long)readings, worstErrorC, wallMs);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+#ifndef SIM_TEMPERATURE_H
+#define SIM_TEMPERATURE_H
+
+#include <stdint.h>
+
+// Temperature filter and decimation on the host (sim_temperature.cpp).
+// Replay feeds a recorded conversion stream through temperature_filter.h
+// exactly as the sampling task would: blocks of TEMP_OVERSAMPLE
+// conversions, one reading per block. The benchmark generates noisy
+// streams with spikes, drift, steps and gaps from a known true
+// temperature and checks the output against it and against a
+// floating-point reference filter.
+
+// File of "ms,celsius" lines, one per conversion ("-" = stdin). Prints the
+// closed minutes as CSV, with --csv every reading as well.
+int runTemperatureReplay(const char* path, bool csv);
+
+// Randomized streams; 0 if every run kept the invariants
+int runTemperatureBench(uint32_t runs, uint32_t seed);
+
+#endif // SIM_TEMPERATURE_H
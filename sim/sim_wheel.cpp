@@ -0,0 +1,177 @@
+#include "sim_wheel.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#include "timer_wheel.h"
+
+static const uint16_t RUN_CAPACITY = 512;
+static const uint32_t RUN_STEPS = 4000;
+
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Delay spread over all levels: mostly near, some days out, some beyond
+// the wheel, a few already past
+static int64_t randomDelay(uint32_t& state) {
+    uint32_t pick = nextRandom(state) % 100;
+    if (pick < 5) return -(int64_t)(nextRandom(state) % 1000);
+    if (pick < 40) return nextRandom(state) % TIMER_WHEEL_SLOTS;
+    if (pick < 70) return nextRandom(state) % (1 << 18);
+    if (pick < 95) return nextRandom(state) % (1ULL << TIMER_WHEEL_SPAN_BITS);
+    return (1ULL << TIMER_WHEEL_SPAN_BITS) + nextRandom(state) % (1ULL << TIMER_WHEEL_SPAN_BITS);
+}
+
+// Mostly one tick per pass like the network task, sometimes a light sleep,
+// sometimes a long stall that crosses many rounds
+static uint64_t randomAdvance(uint32_t& state) {
+    uint32_t pick = nextRandom(state) % 100;
+    if (pick < 80) return nextRandom(state) % 3;
+    if (pick < 97) return nextRandom(state) % 3000;
+    return nextRandom(state) % (1 << 24);
+}
+
+static uint64_t expiryFor(uint64_t now, int64_t delay) {
+    if (delay < 0 && (uint64_t)-delay > now) return 0;
+    return now + delay;
+}
+
+static const char* runOnce(uint32_t seed, uint64_t& timers, uint64_t& cascaded) {
+    uint32_t state = seed * 2654435761u + 1;
+    
+    // Start anywhere, often just below a level or overflow boundary
+    uint64_t now = ((uint64_t)nextRandom(state) << 20) | nextRandom(state);
+    if (nextRandom(state) % 2) now = (now | ((1ULL << TIMER_WHEEL_SPAN_BITS) - 1)) - nextRandom(state) % 5000;
+    
+    static TimerNode nodes[RUN_CAPACITY];
+    static TimerWheel wheel;
+    timerWheelInit(wheel, nodes, RUN_CAPACITY, now);
+    
+    // Reference: expiry of every live timer, UINT64_MAX if free
+    std::vector<uint64_t> expected(RUN_CAPACITY, UINT64_MAX);
+    uint16_t live = 0;
+    
+    for (uint32_t step = 0; step < RUN_STEPS; step++) {
+        uint32_t op = nextRandom(state) % 100;
+        
+        if (op < 45) {
+            uint64_t expires = expiryFor(now, randomDelay(state));
+            uint16_t timer = timerWheelAdd(wheel, expires);
+            if (timer == TIMER_NONE) {
+                if (live < RUN_CAPACITY) return "add failed with free nodes";
+                continue;
+            }
+            if (expected[timer] != UINT64_MAX) return "add returned a live node";
+            expected[timer] = expires;
+            live++;
+            timers++;
+        } else if (op < 55 && live > 0) {
+            uint16_t timer = nextRandom(state) % RUN_CAPACITY;
+            bool wasLive = expected[timer] != UINT64_MAX;
+            if (timerWheelCancel(wheel, timer) != wasLive) return "cancel disagrees with the reference";
+            if (wasLive) {
+                expected[timer] = UINT64_MAX;
+                live--;
+            }
+        } else if (op < 60 && live > 0) {
+            // Clock step: every live timer moves by the same amount
+            int64_t shift = (int64_t)(nextRandom(state) % 20000) - 10000;
+            for (uint16_t timer = 0; timer < RUN_CAPACITY; timer++) {
+                if (expected[timer] == UINT64_MAX) continue;
+                expected[timer] = expiryFor(expected[timer], shift);
+                timerWheelMove(wheel, timer, expected[timer]);
+            }
+        } else {
+            uint64_t lowest = UINT64_MAX;
+            for (uint16_t timer = 0; timer < RUN_CAPACITY; timer++) {
+                if (expected[timer] < lowest) lowest = expected[timer];
+            }
+            // Timers added in the past are due at the next tick
+            if (lowest < wheel.now) lowest = wheel.now;
+            if (timerWheelNextExpiry(wheel) > lowest) return "next expiry later than a live timer";
+            
+            now += randomAdvance(state);
+            timerWheelAdvance(wheel, now);
+            
+            uint16_t timer;
+            while ((timer = timerWheelPop(wheel)) != TIMER_NONE) {
+                if (expected[timer] == UINT64_MAX) return "popped a dead timer";
+                if (expected[timer] > now) return "popped a timer early";
+                expected[timer] = UINT64_MAX;
+                live--;
+            }
+            for (uint16_t i = 0; i < RUN_CAPACITY; i++) {
+                if (expected[i] <= now) return "due timer not popped";
+            }
+            if (live > 0 && timerWheelNextExpiry(wheel) <= now) return "next expiry in the past";
+        }
+        
+        if (wheel.pending != live) return "pending count drifted";
+    }
+    
+    cascaded += wheel.cascaded;
+    return nullptr;
+}
+
+// Mean cost of one add+cancel and of a one-tick advance with `pending`
+// timers spread over the wheel
+static void timeScaling(uint16_t pending) {
+    std::vector<TimerNode> nodes(pending + 1);
+    static TimerWheel wheel;
+    uint32_t state = 12345;
+    uint64_t now = 1000;
+    timerWheelInit(wheel, nodes.data(), pending + 1, now);
+    for (uint16_t i = 0; i < pending; i++) {
+        timerWheelAdd(wheel, now + 1 + nextRandom(state) % (1ULL << TIMER_WHEEL_SPAN_BITS));
+    }
+    
+    const uint32_t rounds = 200000;
+    auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) {
+        uint16_t timer = timerWheelAdd(wheel, now + 1 + nextRandom(state) % (1ULL << TIMER_WHEEL_SPAN_BITS));
+        timerWheelCancel(wheel, timer);
+    }
+    double addNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / rounds;
+    
+    // Advances pop whatever falls due on the way, like the network task
+    uint64_t popped = 0;
+    begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) {
+        timerWheelAdvance(wheel, ++now);
+        while (timerWheelPop(wheel) != TIMER_NONE) popped++;
+    }
+    double advanceNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / rounds;
+    
+    printf("wheel pending=%u add_cancel_ns=%.1f advance_ns=%.1f popped=%llu\n",
+           pending, addNs, advanceNs, (unsigned long long)popped);
+}
+
+int runWheelBench(uint32_t runs, uint32_t seed) {
+    uint32_t failures = 0;
+    uint64_t timers = 0;
+    uint64_t cascaded = 0;
+    auto begin = std::chrono::steady_clock::now();
+    
+    for (uint32_t r = 0; r < runs; r++) {
+        const char* violation = runOnce(seed + r, timers, cascaded);
+        if (violation != nullptr) {
+            failures++;
+            printf("FAIL run %lu (seed %lu): %s\n", (unsigned long)r, (unsigned long)(seed + r), violation);
+        }
+    }
+    
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    printf("wheel runs=%lu failures=%lu timers=%llu cascaded=%llu wall_ms=%.1f\n",
+           (unsigned long)runs, (unsigned long)failures, (unsigned long long)timers,
+           (unsigned long long)cascaded, wallMs);
+    
+    for (uint16_t pending : {16, 256, 4096, 32768}) {
+        timeScaling(pending);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+#ifndef SIM_WHEEL_H
+#define SIM_WHEEL_H
+
+#include <stdint.h>
+
+// Timer wheel checks on the host (sim_wheel.cpp). Randomized runs add,
+// cancel and move timers across every level and the overflow list, step
+// the clock by single ticks and by long jumps, and compare everything that
+// becomes due against a plain list of the same timers. Afterwards the cost
+// of an add and of an advance with nothing due is timed for growing
+// numbers of pending timers, which should stay flat.
+
+// 0 if every run kept the invariants
+int runWheelBench(uint32_t runs, uint32_t seed);
+
+#endif // SIM_WHEEL_H
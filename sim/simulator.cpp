@@ -0,0 +1,136 @@
+#include "simulator.h"
+
+#include "ir_transmitter.h"
+#include "rt_task.h"
+#include "session.h"
+#include "sim_ir.h"
+
+// Small deterministic PRNG so runs are reproducible from the seed
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+SimResult simulateSession(const SimConfig& config) {
+    SimResult result;
+    uint32_t rng = config.seed ? config.seed : 1;
+    uint32_t now = config.startClock;
+    
+    // Same shutter train as the firmware, so busy times match the real sender
+    simIrReset(now, 0);
+    sessionBegin(config.irProfile);
+    
+    // Leave whatever a previous run left behind
+    ControlCommand stop;
+    stop.type = CMD_STOP_SESSION;
+    sessionApplyCommand(stop, now);
+    
+    StatusSnapshot before;
+    sessionFillSnapshot(before);
+    
+    ControlCommand start;
+    start.type = CMD_START_SESSION;
+    if (config.plan.phaseCount > 0) {
+        start.plan = config.plan;
+    } else {
+        sessionPlanForMinutes(start.plan, config.minutes);
+    }
+    sessionApplyCommand(start, now);
+    
+    StatusSnapshot status;
+    sessionFillSnapshot(status);
+    result.expectedShots = status.session.totalShots;
+    result.minIntervalMs = status.session.durationMs;
+    for (uint16_t slot = 1; slot < result.expectedShots; slot++) {
+        uint32_t gap = sessionShotDeadline(slot) - sessionShotDeadline(slot - 1);
+        if (gap < result.minIntervalMs) result.minIntervalMs = gap;
+    }
+    
+    uint32_t sessionStart = now;
+    bool stopSent = false;
+    bool burstSent = config.burstCount == 0;
+    uint32_t lastLatenessCount = 0;
+    uint64_t sleepRemainderUs = 0;
+    
+    for (;;) {
+        uint32_t elapsed = now - sessionStart;
+        
+        // Commands arrive between scheduler wake-ups, as from the web side
+        if (!burstSent && elapsed >= config.burstAtMs) {
+            ControlCommand burst;
+            burst.type = CMD_SHOT_JOB;
+            burst.count = config.burstCount;
+            burst.spacingMs = config.burstSpacingMs;
+            burst.jobId = before.lastJobId + 1000;
+            sessionApplyCommand(burst, now);
+            burstSent = true;
+        }
+        if (!stopSent && config.stopAfterMs > 0 && elapsed >= config.stopAfterMs) {
+            sessionApplyCommand(stop, now);
+            stopSent = true;
+        }
+        
+        simIrSetTime(now);
+        sessionPoll(now);
+        sessionFillSnapshot(status);
+        result.steps++;
+        
+        // A new lateness sample means a session shot went out at `now`
+        if (status.lateness.count != lastLatenessCount) {
+            lastLatenessCount = status.lateness.count;
+            SimShot shot;
+            shot.scheduled = sessionShotDeadline(status.session.currentShot - 1);
+            shot.actual = now;
+            uint32_t drift = shot.actual - shot.scheduled;
+            if (drift > result.maxDriftMs) result.maxDriftMs = drift;
+            result.shots.push_back(shot);
+        }
+        
+        bool sessionDone = status.session.state != STATE_RUNNING;
+        if (sessionDone && status.jobsPending == 0 && burstSent) break;
+        
+        // Warp to the next event, plus the simulated wake-up latency
+        uint32_t wait = sessionTimeToNextEvent(now, config.lightSleep ? IDLE_SLEEP_MAX_MS : RT_MAX_SLEEP_MS);
+        if (!stopSent && config.stopAfterMs > 0 && config.stopAfterMs - elapsed < wait) {
+            wait = config.stopAfterMs - elapsed;
+        }
+        if (!burstSent && config.burstAtMs - elapsed < wait) {
+            wait = config.burstAtMs - elapsed;
+        }
+        
+        // Light sleep on the virtual clock; what is left is waited out as usual.
+        // Same checks as the shot task: never while a frame is on air.
+        bool irBusy = irTransmitterBusy();
+        if (config.lightSleep && !sessionDone && !irBusy && wait >= IDLE_SLEEP_MIN_MS) {
+            uint32_t sleepUs = idleSleepPlanUs(result.sleep, wait);
+            if (sleepUs > 0) {
+                uint32_t actualUs = sleepUs;
+                if (config.sleepLatencyUs > 0) actualUs += nextRandom(rng) % (config.sleepLatencyUs + 1);
+                idleSleepRecord(result.sleep, sleepUs, actualUs, wait);
+                idleSleepAddAsleep(result.sleep, actualUs);
+                
+                // Sub-millisecond parts carry over to the next sleep
+                sleepRemainderUs += actualUs;
+                now += sleepRemainderUs / 1000;
+                sleepRemainderUs %= 1000;
+                continue;
+            }
+        }
+        if (wait > RT_MAX_SLEEP_MS) wait = RT_MAX_SLEEP_MS;
+        if (wait > RT_IR_POLL_MS && config.lightSleep && irBusy) wait = RT_IR_POLL_MS;
+        if (wait == 0) wait = 1;
+        if (config.wakeJitterMs > 0) wait += nextRandom(rng) % (config.wakeJitterMs + 1);
+        now += wait;
+    }
+    
+    result.sessionShots = result.shots.size();
+    result.jobShots = status.jobShotsFired - before.jobShotsFired;
+    result.missedShots = status.lateness.missed;
+    result.p99LatenessMs = latenessPercentileMs(status.lateness, 99);
+    result.durationMs = now - sessionStart;
+    result.completed = status.session.state == STATE_COMPLETED;
+    result.avgCurrentUa = idleSleepAverageCurrentUa(result.sleep, (uint64_t)result.durationMs * 1000);
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdint.h>
+#include <vector>
+#include "idle_sleep.h"
+#include "ir_profiles.h"
+#include "shot_sequence.h"
+
+// Host-native time-warp simulator for whole sessions.
+// Runs the real session logic (src/session.cpp) against a virtual millis()
+// clock and a mock IR sink. Instead of sleeping, the clock jumps straight to
+// the next deadline reported by sessionTimeToNextEvent(), like the
+// real-time task does, so an 8 hour session completes in milliseconds.
+// With light sleep enabled, long waits go through the idle sleep planner and
+// a virtual sleep clock that wakes up late by a random latency.
+
+struct SimConfig {
+    uint16_t minutes = 60;
+    SequencePlan plan;              // Replaces `minutes` when it has phases
+    IrProfileId irProfile = IR_PROFILE_DEFAULT;
+    uint32_t startClock = 0;        // Virtual millis() at session start, use to exercise wraparound
+    uint32_t wakeJitterMs = 0;      // Random extra wake-up latency per event, 0..wakeJitterMs
+    uint32_t stopAfterMs = 0;       // Send a stop command after this long, 0 = never
+    uint16_t burstCount = 0;        // Burst job submitted during the session, 0 = none
+    uint32_t burstSpacingMs = 1000;
+    uint32_t burstAtMs = 0;
+    bool lightSleep = false;        // Sleep between session shots like the firmware's field mode
+    uint32_t sleepLatencyUs = 0;    // Random wakeup latency per light sleep, 0..sleepLatencyUs
+    uint32_t seed = 1;
+};
+
+struct SimShot {
+    uint32_t scheduled;             // Ideal deadline: start + compiled offset
+    uint32_t actual;                // Virtual time the IR frame went out
+};
+
+struct SimResult {
+    uint16_t expectedShots = 0;
+    uint32_t minIntervalMs = 0;     // Shortest gap in the compiled schedule
+    uint16_t sessionShots = 0;
+    uint32_t jobShots = 0;
+    uint32_t missedShots = 0;
+    uint32_t maxDriftMs = 0;        // Largest actual - scheduled over all session shots
+    uint32_t durationMs = 0;        // Virtual session length
+    uint32_t steps = 0;             // Scheduler wake-ups
+    uint32_t p99LatenessMs = 0;     // As reported by the session's own statistics
+    bool completed = false;
+    IdleSleepStats sleep;
+    uint32_t avgCurrentUa = 0;      // Estimated from the sleep duty cycle
+    std::vector<SimShot> shots;
+};
+
+SimResult simulateSession(const SimConfig& config);
+
+#endif // SIMULATOR_H
@@ -0,0 +1,227 @@
+#include "clock_sync.h"
+
+#include <string.h>
+
+static const uint32_t SYNC_MAGIC = 0x4E595341;     // "ASYN"
+static const uint8_t SYNC_VERSION = 1;
+
+// Bounds-checked little-endian cursor over a packet buffer
+struct SyncCursor {
+    uint8_t* out;
+    const uint8_t* in;
+    size_t size;
+    size_t pos;
+    bool ok;
+};
+
+static void putBytes(SyncCursor& c, uint64_t value, uint8_t bytes) {
+    if (c.pos + bytes > c.size) {
+        c.ok = false;
+        return;
+    }
+    for (uint8_t i = 0; i < bytes; i++) c.out[c.pos++] = (uint8_t)(value >> (8 * i));
+}
+
+static uint64_t getBytes(SyncCursor& c, uint8_t bytes) {
+    if (c.pos + bytes > c.size) {
+        c.ok = false;
+        return 0;
+    }
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) value |= (uint64_t)c.in[c.pos++] << (8 * i);
+    return value;
+}
+
+size_t syncEncode(const SyncPacket& packet, uint8_t* buffer, size_t size) {
+    SyncCursor c = {buffer, nullptr, size, 0, true};
+    putBytes(c, SYNC_MAGIC, 4);
+    putBytes(c, SYNC_VERSION, 1);
+    putBytes(c, packet.type, 1);
+    putBytes(c, packet.nodeId, 4);
+    putBytes(c, packet.seq, 4);
+    putBytes(c, (uint64_t)packet.sentUs, 8);
+    
+    if (packet.type == SYNC_BEACON) {
+        putBytes(c, packet.sessionRunning ? 1 : 0, 1);
+        putBytes(c, (uint64_t)packet.sessionStartUs, 8);
+        putBytes(c, packet.plan.phaseCount, 1);
+        for (uint8_t i = 0; i < packet.plan.phaseCount && i < MAX_SEQUENCE_PHASES; i++) {
+            const SequencePhase& phase = packet.plan.phases[i];
+            putBytes(c, phase.type, 1);
+            putBytes(c, phase.shots, 2);
+            putBytes(c, phase.intervalMs, 4);
+            putBytes(c, phase.endIntervalMs, 4);
+            putBytes(c, phase.durationMs, 4);
+        }
+    } else {
+        putBytes(c, packet.leaderId, 4);
+        putBytes(c, (uint64_t)packet.offsetUs, 8);
+        putBytes(c, packet.jitterUs, 4);
+        putBytes(c, (uint32_t)packet.skewPpb, 4);
+        putBytes(c, packet.samples, 1);
+        putBytes(c, packet.following ? 1 : 0, 1);
+        putBytes(c, packet.currentShot, 2);
+    }
+    return c.ok ? c.pos : 0;
+}
+
+bool syncDecode(const uint8_t* data, size_t len, SyncPacket& packet) {
+    SyncCursor c = {nullptr, data, len, 0, true};
+    if (getBytes(c, 4) != SYNC_MAGIC || getBytes(c, 1) != SYNC_VERSION) return false;
+    
+    packet = SyncPacket();
+    uint8_t type = getBytes(c, 1);
+    if (type != SYNC_BEACON && type != SYNC_REPORT) return false;
+    packet.type = (SyncPacketType)type;
+    packet.nodeId = getBytes(c, 4);
+    packet.seq = getBytes(c, 4);
+    packet.sentUs = (int64_t)getBytes(c, 8);
+    
+    if (packet.type == SYNC_BEACON) {
+        packet.sessionRunning = getBytes(c, 1) != 0;
+        packet.sessionStartUs = (int64_t)getBytes(c, 8);
+        packet.plan.phaseCount = getBytes(c, 1);
+        if (packet.plan.phaseCount > MAX_SEQUENCE_PHASES) return false;
+        for (uint8_t i = 0; i < packet.plan.phaseCount; i++) {
+            SequencePhase& phase = packet.plan.phases[i];
+            uint8_t phaseType = getBytes(c, 1);
+            if (phaseType > PHASE_AT) return false;
+            phase.type = (PhaseType)phaseType;
+            phase.shots = getBytes(c, 2);
+            phase.intervalMs = getBytes(c, 4);
+            phase.endIntervalMs = getBytes(c, 4);
+            phase.durationMs = getBytes(c, 4);
+        }
+    } else {
+        packet.leaderId = getBytes(c, 4);
+        packet.offsetUs = (int64_t)getBytes(c, 8);
+        packet.jitterUs = getBytes(c, 4);
+        packet.skewPpb = (int32_t)getBytes(c, 4);
+        packet.samples = getBytes(c, 1);
+        packet.following = getBytes(c, 1) != 0;
+        packet.currentShot = getBytes(c, 2);
+    }
+    return c.ok && packet.nodeId != 0;
+}
+
+void clockSyncReset(ClockSync& sync, uint32_t leaderId) {
+    uint32_t resets = sync.resets;
+    sync = ClockSync();
+    sync.leaderId = leaderId;
+    sync.resets = resets;
+}
+
+// Sample `k` in arrival order, 0 = oldest
+static const ClockSyncSample& sampleAt(const ClockSync& sync, uint8_t k) {
+    return sync.samples[(sync.next + SYNC_WINDOW - sync.count + k) % SYNC_WINDOW];
+}
+
+static uint8_t leastDelayed(const ClockSync& sync, uint8_t from, uint8_t to) {
+    uint8_t best = from;
+    for (uint8_t k = from + 1; k < to; k++) {
+        if (sampleAt(sync, k).offsetUs > sampleAt(sync, best).offsetUs) best = k;
+    }
+    return best;
+}
+
+// Least delayed sample of a range, projected to `localUs` with `skewPpb`
+static int64_t bestOffset(const ClockSync& sync, uint8_t from, uint8_t to, int64_t localUs, int32_t skewPpb) {
+    int64_t best = INT64_MIN;
+    for (uint8_t k = from; k < to; k++) {
+        const ClockSyncSample& sample = sampleAt(sync, k);
+        int64_t projected = sample.offsetUs + (localUs - sample.localUs) * skewPpb / 1000000000;
+        if (projected > best) best = projected;
+    }
+    return best;
+}
+
+void clockSyncAddSample(ClockSync& sync, uint32_t leaderId, uint32_t seq, int64_t leaderUs, int64_t localUs) {
+    int64_t offset = leaderUs - localUs;
+    
+    // Delay only makes samples smaller; a jump up means the leader clock or
+    // the leader itself changed, and a new leader restarts its sequence
+    if (sync.count > 0 && (leaderId != sync.leaderId || (int32_t)(seq - sync.lastSeq) <= 0 ||
+                           offset - clockSyncOffsetAt(sync, localUs) > SYNC_STEP_US)) {
+        clockSyncReset(sync, leaderId);
+        sync.resets++;
+    }
+    sync.leaderId = leaderId;
+    sync.lastSeq = seq;
+    sync.samples[sync.next] = {localUs, offset};
+    sync.next = (sync.next + 1) % SYNC_WINDOW;
+    if (sync.count < SYNC_WINDOW) sync.count++;
+    sync.anchorUs = localUs;
+    
+    // Skew between the least delayed sample of the older and of the newer
+    // half, which unlike a least-squares fit ignores delayed beacons
+    sync.skewPpb = 0;
+    if (sync.count >= SYNC_MIN_SAMPLES) {
+        uint8_t half = sync.count / 2;
+        const ClockSyncSample& older = sampleAt(sync, leastDelayed(sync, 0, half));
+        const ClockSyncSample& newer = sampleAt(sync, leastDelayed(sync, half, sync.count));
+        int64_t spanUs = newer.localUs - older.localUs;
+        if (spanUs > 0) {
+            int64_t skew = (newer.offsetUs - older.offsetUs) * 1000000000 / spanUs;
+            if (skew > SYNC_MAX_SKEW_PPB) skew = SYNC_MAX_SKEW_PPB;
+            if (skew < -SYNC_MAX_SKEW_PPB) skew = -SYNC_MAX_SKEW_PPB;
+            sync.skewPpb = (int32_t)skew;
+        }
+    }
+    
+    sync.offsetUs = bestOffset(sync, 0, sync.count, localUs, sync.skewPpb);
+    
+    uint64_t spread = 0;
+    for (uint8_t k = 0; k < sync.count; k++) {
+        const ClockSyncSample& sample = sampleAt(sync, k);
+        spread += sync.offsetUs - (sample.offsetUs + (localUs - sample.localUs) * sync.skewPpb / 1000000000);
+    }
+    sync.jitterUs = spread / sync.count;
+}
+
+bool clockSyncReady(const ClockSync& sync) {
+    return sync.count >= SYNC_MIN_SAMPLES;
+}
+
+int64_t clockSyncOffsetAt(const ClockSync& sync, int64_t localUs) {
+    return sync.offsetUs + (localUs - sync.anchorUs) * sync.skewPpb / 1000000000;
+}
+
+int64_t syncStartUs(int64_t nowUs, uint32_t startMs) {
+    // millis() is the low 32 bits of the 64-bit millisecond count
+    int64_t nowMs = nowUs / 1000;
+    uint32_t elapsedMs = (uint32_t)nowMs - startMs;
+    return (nowMs - elapsedMs) * 1000;
+}
+
+uint32_t syncLocalStartMs(const ClockSync& sync, int64_t leaderStartUs, int64_t localNowUs) {
+    // Nearest millisecond, the start may predate this boot
+    int64_t localUs = leaderStartUs - clockSyncOffsetAt(sync, localNowUs) + 500;
+    int64_t ms = localUs / 1000;
+    if (localUs % 1000 < 0) ms--;
+    return (uint32_t)ms;
+}
+
+void syncFollowerUpdate(SyncFollower* table, uint8_t size, const SyncPacket& report, uint32_t nowMs) {
+    SyncFollower* slot = nullptr;
+    for (uint8_t i = 0; i < size && slot == nullptr; i++) {
+        if (table[i].nodeId == report.nodeId) slot = &table[i];
+    }
+    for (uint8_t i = 0; i < size && slot == nullptr; i++) {
+        if (table[i].nodeId == 0) slot = &table[i];
+    }
+    if (slot == nullptr) {
+        slot = &table[0];
+        for (uint8_t i = 1; i < size; i++) {
+            if (nowMs - table[i].lastSeenMs > nowMs - slot->lastSeenMs) slot = &table[i];
+        }
+    }
+    
+    slot->nodeId = report.nodeId;
+    slot->lastSeenMs = nowMs;
+    slot->offsetUs = report.offsetUs;
+    slot->jitterUs = report.jitterUs;
+    slot->skewPpb = report.skewPpb;
+    slot->samples = report.samples;
+    slot->following = report.following;
+    slot->currentShot = report.currentShot;
+}
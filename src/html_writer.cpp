@@ -0,0 +1,64 @@
+#include "html_writer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+HtmlWriter::HtmlWriter(char* buffer, size_t size, HtmlSink sink, void* context)
+    : buffer(buffer), size(size), sink(sink), context(context) {
+}
+
+void HtmlWriter::print(const char* text) {
+    write(text, strlen(text));
+}
+
+void HtmlWriter::write(const char* data, size_t len) {
+    while (len > 0) {
+        if (used == size) flush();
+        
+        size_t n = size - used;
+        if (n > len) n = len;
+        memcpy(buffer + used, data, n);
+        used += n;
+        total += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void HtmlWriter::printf(const char* format, ...) {
+    va_list args;
+    
+    // Format straight into the free part of the buffer
+    va_start(args, format);
+    int n = vsnprintf(buffer + used, size - used, format, args);
+    va_end(args);
+    if (n < 0) return;
+    
+    if ((size_t)n < size - used) {
+        used += n;
+        total += n;
+        return;
+    }
+    
+    // Did not fit: flush and format again into the empty buffer,
+    // output longer than the whole buffer is truncated
+    flush();
+    va_start(args, format);
+    n = vsnprintf(buffer, size, format, args);
+    va_end(args);
+    if (n < 0) return;
+    
+    if ((size_t)n >= size) {
+        n = size - 1;
+        truncations++;
+    }
+    used = n;
+    total += n;
+}
+
+void HtmlWriter::flush() {
+    if (used == 0) return;
+    sink(buffer, used, context);
+    used = 0;
+    flushes++;
+}
@@ -0,0 +1,41 @@
+#include "idle_sleep.h"
+
+uint32_t idleSleepPlanUs(const IdleSleepStats& stats, uint32_t untilEventMs) {
+    if (untilEventMs < IDLE_SLEEP_MIN_MS) return 0;
+    if (untilEventMs > IDLE_SLEEP_MAX_MS) untilEventMs = IDLE_SLEEP_MAX_MS;
+    
+    // The slow clock error grows with the sleep length, the latency does not
+    uint32_t guardUs = stats.marginUs + untilEventMs * IDLE_SLEEP_CLOCK_PPM / 1000;
+    uint32_t availableUs = untilEventMs * 1000;
+    if (availableUs < guardUs + IDLE_SLEEP_MIN_MS * 1000) return 0;
+    return availableUs - guardUs;
+}
+
+void idleSleepRecord(IdleSleepStats& stats, uint32_t requestedUs, uint32_t actualUs, uint32_t untilEventMs) {
+    uint32_t latencyUs = actualUs > requestedUs ? actualUs - requestedUs : 0;
+    
+    stats.wakeLatencyUs = latencyUs;
+    if (latencyUs > stats.wakeLatencyMaxUs) stats.wakeLatencyMaxUs = latencyUs;
+    if (actualUs > (uint64_t)untilEventMs * 1000) stats.lateWakeups++;
+    
+    // Jump up to a new worst case at once, forget it slowly
+    uint32_t decayed = stats.latencyPeakUs - stats.latencyPeakUs / 16;
+    stats.latencyPeakUs = latencyUs > decayed ? latencyUs : decayed;
+    
+    uint32_t margin = stats.latencyPeakUs * 2;
+    stats.marginUs = margin > IDLE_WAKE_MARGIN_US ? margin : IDLE_WAKE_MARGIN_US;
+}
+
+void idleSleepAddAsleep(IdleSleepStats& stats, uint32_t asleepUs) {
+    if (asleepUs == 0) return;
+    stats.sleeps++;
+    stats.sleptUs += asleepUs;
+}
+
+uint32_t idleSleepAverageCurrentUa(const IdleSleepStats& stats, uint64_t elapsedUs) {
+    if (elapsedUs == 0) return IDLE_ACTIVE_CURRENT_UA;
+    
+    uint64_t sleptUs = stats.sleptUs < elapsedUs ? stats.sleptUs : elapsedUs;
+    uint64_t charge = sleptUs * IDLE_SLEEP_CURRENT_UA + (elapsedUs - sleptUs) * IDLE_ACTIVE_CURRENT_UA;
+    return (uint32_t)(charge / elapsedUs);
+}
@@ -0,0 +1,90 @@
+#include "ir_profiles.h"
+
+#include <string.h>
+
+const IrProfile IR_PROFILES[IR_PROFILE_COUNT] = {
+    {"sony", "Sony (SIRC 20 bit)", &IrProfileTrain<IR_PROFILE_SONY>::train},
+    {"sony-2s", "Sony, 2 s delay", &IrProfileTrain<IR_PROFILE_SONY_2S>::train},
+    {"canon", "Canon RC-1/RC-6", &IrProfileTrain<IR_PROFILE_CANON>::train},
+    {"canon-2s", "Canon RC-1/RC-6, 2 s delay", &IrProfileTrain<IR_PROFILE_CANON_2S>::train},
+    {"nikon", "Nikon ML-L3", &IrProfileTrain<IR_PROFILE_NIKON>::train},
+    {"pentax", "Pentax", &IrProfileTrain<IR_PROFILE_PENTAX>::train},
+    {"olympus", "Olympus RM-1", &IrProfileTrain<IR_PROFILE_OLYMPUS>::train},
+};
+
+bool irProfileFind(const char* key, IrProfileId& id) {
+    for (uint8_t i = 0; i < IR_PROFILE_COUNT; i++) {
+        if (strcmp(IR_PROFILES[i].key, key) == 0) {
+            id = (IrProfileId)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reference timings, checked by the compiler on every device and native build
+
+// Pulse by pulse against IRremote's sendSony(): per frame a 2400/600 header,
+// then every bit LSB first as a 1200 (one) or 600 (zero) mark and a 600
+// space, except that the space after the last bit runs out the 45 ms
+// repeat period; the final frame ends on its last mark
+constexpr bool irMatchesIrremoteSony(const IrPulseTrain& train, uint16_t address, uint8_t command,
+                                     uint8_t bits, uint8_t repeats) {
+    const uint16_t perFrame = 2 + 2 * bits;
+    if (train.carrierKhz != 40 || train.count != perFrame * (repeats + 1) - 1) return false;
+    
+    uint32_t data = ((uint32_t)address << 7) | (command & 0x7F);
+    uint32_t frameUs = 0;
+    for (uint16_t i = 0; i < train.count; i++) {
+        uint16_t position = i % perFrame;
+        if (position == 0) frameUs = 0;
+        
+        uint32_t expected = 600;
+        if (position == 0) {
+            expected = 2400;
+        } else if (position >= 2 && position % 2 == 0) {
+            expected = (data >> ((position - 2) / 2)) & 1 ? 1200 : 600;
+        } else if (position == perFrame - 1) {
+            expected = 45000 - frameUs;
+        }
+        if (train.durations[i] != expected) return false;
+        frameUs += expected;
+    }
+    return true;
+}
+
+static_assert(irMatchesIrremoteSony(IrProfileTrain<IR_PROFILE_SONY>::train, SONY_ADDRESS, SONY_COMMAND,
+                                    SONY_BITS, SONY_REPEATS), "Sony train differs from IRremote sendSony()");
+static_assert(irMatchesIrremoteSony(IrProfileTrain<IR_PROFILE_SONY_2S>::train, SONY_ADDRESS, SONY_COMMAND_2S,
+                                    SONY_BITS, SONY_REPEATS), "Sony 2 s train differs from IRremote sendSony()");
+
+// Sony: 4 frames of header + 20 bits, 45 ms apart; 0x2D/0x1E3A has 12 one bits
+static_assert(IrProfileTrain<IR_PROFILE_SONY>::train.count == 167, "Sony pulse count");
+static_assert(IrProfileTrain<IR_PROFILE_SONY>::train.durations[0] == 2400, "Sony header mark");
+static_assert(IrProfileTrain<IR_PROFILE_SONY>::train.durations[2] == 1200 &&
+              IrProfileTrain<IR_PROFILE_SONY>::train.durations[4] == 600, "Sony command bits");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_SONY>::train) == 3 * 45000 + 33600, "Sony duration");
+static_assert(IrProfileTrain<IR_PROFILE_SONY_2S>::train.count == 167, "Sony 2 s pulse count");
+static_assert(IrProfileTrain<IR_PROFILE_SONY_2S>::train.durations[2] == 1200 &&
+              IrProfileTrain<IR_PROFILE_SONY_2S>::train.durations[8] == 600, "Sony 2 s command bits");
+
+// Canon: 485 us burst, 7.33 ms (5.36 ms for 2 s) gap, 485 us burst
+static_assert(IrProfileTrain<IR_PROFILE_CANON>::train.count == 3, "Canon pulse count");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_CANON>::train) == 8300, "Canon duration");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_CANON_2S>::train) == 6330, "Canon 2 s duration");
+static_assert(IrProfileTrain<IR_PROFILE_CANON>::train.carrierKhz == 33, "Canon carrier");
+
+// Nikon: two 36.19 ms frames, 63.2 ms apart
+static_assert(IrProfileTrain<IR_PROFILE_NIKON>::train.count == 15, "Nikon pulse count");
+static_assert(IrProfileTrain<IR_PROFILE_NIKON>::train.durations[7] == 63200 - 36190, "Nikon frame gap");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_NIKON>::train) == 63200 + 36190, "Nikon duration");
+
+// Pentax: 13 ms header, 3 ms space, seven 1 ms marks
+static_assert(IrProfileTrain<IR_PROFILE_PENTAX>::train.count == 15, "Pentax pulse count");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_PENTAX>::train) == 29000, "Pentax duration");
+
+// Olympus: 8972/4384 header, 32 bits (16 ones), closing mark
+static_assert(IrProfileTrain<IR_PROFILE_OLYMPUS>::train.count == 67, "Olympus pulse count");
+static_assert(IrProfileTrain<IR_PROFILE_OLYMPUS>::train.durations[3] == 488 &&
+              IrProfileTrain<IR_PROFILE_OLYMPUS>::train.durations[5] == 1600, "Olympus first bits");
+static_assert(irTrainDurationUs(IrProfileTrain<IR_PROFILE_OLYMPUS>::train) == 66564, "Olympus duration");
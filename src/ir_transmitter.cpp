@@ -0,0 +1,90 @@
+#include "ir_transmitter.h"
+
+#include <Arduino.h>
+#include "driver/rmt.h"
+
+// RMT runs at 1 us per tick (80 MHz APB / 80)
+static const rmt_channel_t IR_RMT_CHANNEL = RMT_CHANNEL_0;
+static const uint8_t IR_RMT_CLK_DIV = 80;
+static const uint32_t IR_RMT_MAX_TICKS = 32767;
+static const uint8_t IR_CARRIER_DUTY_PERCENT = 33;
+
+// Two memory blocks (128 items) hold a full Sony frame set, the longest
+// profile, without refills
+static const uint8_t IR_RMT_MEM_BLOCKS = 2;
+
+static rmt_item32_t irItems[IR_MAX_PULSES];
+static size_t irItemCount = 0;
+static bool irReady = false;
+
+// Append one level/duration half to the item table
+static bool appendHalf(size_t& half, uint32_t ticks, uint32_t level) {
+    size_t index = half / 2;
+    if (index >= IR_MAX_PULSES) return false;
+    
+    if (half % 2 == 0) {
+        irItems[index].val = 0;
+        irItems[index].duration0 = ticks;
+        irItems[index].level0 = level;
+    } else {
+        irItems[index].duration1 = ticks;
+        irItems[index].level1 = level;
+    }
+    half++;
+    return true;
+}
+
+bool irTransmitterBegin(uint8_t pin) {
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, IR_RMT_CHANNEL);
+    config.clk_div = IR_RMT_CLK_DIV;
+    config.mem_block_num = IR_RMT_MEM_BLOCKS;
+    config.tx_config.carrier_en = true;
+    config.tx_config.carrier_freq_hz = SONY_CARRIER_KHZ * 1000;   // Set per train in irTransmitterLoad()
+    config.tx_config.carrier_duty_percent = IR_CARRIER_DUTY_PERCENT;
+    config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+    
+    if (rmt_config(&config) != ESP_OK) return false;
+    if (rmt_driver_install(IR_RMT_CHANNEL, 0, 0) != ESP_OK) return false;
+    return true;
+}
+
+bool irTransmitterLoad(const IrPulseTrain& train) {
+    if (irTransmitterBusy()) return false;
+    irReady = false;
+    
+    // Split durations longer than one RMT half-item into several halves
+    size_t half = 0;
+    for (uint16_t i = 0; i < train.count; i++) {
+        uint32_t level = (i % 2 == 0) ? 1 : 0;
+        uint32_t remaining = train.durations[i];
+        while (remaining > 0) {
+            uint32_t ticks = remaining > IR_RMT_MAX_TICKS ? IR_RMT_MAX_TICKS : remaining;
+            if (!appendHalf(half, ticks, level)) return false;
+            remaining -= ticks;
+        }
+    }
+    
+    // Zero duration terminates the transmission
+    if (!appendHalf(half, 0, 0)) return false;
+    if (half % 2 != 0 && !appendHalf(half, 0, 0)) return false;
+    irItemCount = half / 2;
+    
+    // Carrier period in APB cycles, split by duty cycle
+    uint32_t period = 80000000UL / (train.carrierKhz * 1000UL);
+    uint32_t high = period * IR_CARRIER_DUTY_PERCENT / 100;
+    rmt_set_tx_carrier(IR_RMT_CHANNEL, true, high, period - high, RMT_CARRIER_LEVEL_HIGH);
+    
+    irReady = true;
+    return true;
+}
+
+bool irTransmitterSend() {
+    if (!irReady || irTransmitterBusy()) return false;
+    return rmt_write_items(IR_RMT_CHANNEL, irItems, irItemCount, false) == ESP_OK;
+}
+
+bool irTransmitterBusy() {
+    return rmt_wait_tx_done(IR_RMT_CHANNEL, 0) != ESP_OK;
+}
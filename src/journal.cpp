@@ -0,0 +1,89 @@
+#include "journal.h"
+
+#include <stddef.h>
+
+uint32_t journalCrc32(const uint8_t* data, size_t len) {
+    // Bitwise CRC-32 (IEEE), records are small and written rarely
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+void journalSeal(JournalRecord& record) {
+    record.crc = journalCrc32((const uint8_t*)&record, offsetof(JournalRecord, crc));
+}
+
+bool journalRecordValid(const JournalRecord& record) {
+    if (record.sequence == 0) return false;
+    if (record.type < JOURNAL_SESSION_START || record.type > JOURNAL_SESSION_END) return false;
+    return record.crc == journalCrc32((const uint8_t*)&record, offsetof(JournalRecord, crc));
+}
+
+JournalRecovery journalRecover(const JournalRecord* records, uint32_t capacity) {
+    JournalRecovery recovery;
+    if (capacity == 0) return recovery;
+    
+    // Newest valid record, and sanity of its ring position
+    uint32_t newest = 0;
+    uint32_t written = 0;
+    bool found = false;
+    for (uint32_t i = 0; i < capacity; i++) {
+        const JournalRecord& record = records[i];
+        if (record.sequence != 0) written++;
+        if (!journalRecordValid(record) || record.sequence % capacity != i) continue;
+        if (!found || record.sequence > newest) newest = record.sequence;
+        found = true;
+    }
+    if (!found) {
+        recovery.skippedRecords = written;
+        return recovery;
+    }
+    
+    // Replay oldest to newest. A slot holding anything but the expected
+    // sequence (torn write, older lap) is skipped, the rest is still valid
+    uint32_t oldest = newest >= capacity ? newest - capacity + 1 : 1;
+    for (uint32_t seq = oldest; seq <= newest; seq++) {
+        const JournalRecord& record = records[seq % capacity];
+        if (!journalRecordValid(record) || record.sequence != seq) continue;
+        recovery.validRecords++;
+        
+        switch (record.type) {
+            case JOURNAL_SESSION_START:
+            case JOURNAL_CHECKPOINT:
+                if (record.type == JOURNAL_CHECKPOINT && recovery.sessionActive &&
+                    record.sessionId == recovery.sessionId && recovery.nextShot > record.shot) {
+                    break; // Already know about later shots
+                }
+                recovery.sessionActive = true;
+                recovery.sessionId = record.sessionId;
+                recovery.startEpochMs = record.startEpochMs;
+                recovery.intervalMs = record.intervalMs;
+                recovery.minutes = record.minutes;
+                recovery.totalShots = record.totalShots;
+                recovery.nextShot = record.shot;
+                break;
+            case JOURNAL_SHOT:
+                if (recovery.sessionActive && record.sessionId == recovery.sessionId &&
+                    record.shot >= recovery.nextShot) {
+                    recovery.nextShot = record.shot + 1;
+                }
+                break;
+            case JOURNAL_SESSION_END:
+                if (record.sessionId == recovery.sessionId) recovery.sessionActive = false;
+                break;
+        }
+    }
+    
+    // The session config was overwritten: nothing to resume
+    if (recovery.sessionActive && recovery.totalShots == 0) recovery.sessionActive = false;
+    if (recovery.nextShot >= recovery.totalShots) recovery.sessionActive = false;
+    
+    recovery.skippedRecords = written - recovery.validRecords;
+    recovery.nextSequence = newest + 1;
+    return recovery;
+}
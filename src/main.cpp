@@ -2,75 +2,129 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <ArduinoJson.h>
-#include <IRremote.hpp>
+#include <Preferences.h>
+#include <esp_timer.h>
 #include <time.h>
-#include "esp_sntp.h"
-
-// Include WiFi credentials (copy secrets_template.h to secrets.h and configure)
-#include "secrets.h"
+#include "config.h"
+#include "html_writer.h"
+#include "ir_profiles.h"
+#include "ir_transmitter.h"
+#include "metrics.h"
+#include "network_manager.h"
+#include "request_arena.h"
+#include "rt_task.h"
+#include "session.h"
+#include "session_journal.h"
+#include "session_schedule.h"
+#include "shot_jobs.h"
+#include "shot_log.h"
+#include "shot_scheduler.h"
+#include "status_events.h"
+#include "sync_link.h"
+#include "temperature_sensor.h"
+#include "trigger_socket.h"
+#include "wall_clock.h"
+#include "web_assets.h"
 
 // Hardware pins
-#define IR_SEND_PIN 4
 #define LED_PIN LED_BUILTIN
 
-// WiFi Configuration from secrets.h
-const char* WIFI_SSID_CONFIG = WIFI_SSID;
-const char* WIFI_PASSWORD_CONFIG = WIFI_PASSWORD;
-const char* AP_SSID_CONFIG = AP_SSID;
-const char* AP_PASSWORD_CONFIG = AP_PASSWORD;
-const unsigned long WIFI_TIMEOUT = 10000;
-
 // Global objects
 WebServer server(80);
 
-// NTP Configuration
-const char* ntpServer = "pool.ntp.org";
-const long gmtOffset_sec = 3600;     // GMT+1 for Germany
-const int daylightOffset_sec = 3600; // Daylight saving time offset
-bool ntpSynced = false;
-
-// Session states
-enum SessionState {
-    STATE_IDLE = 0,
-    STATE_RUNNING = 1,
-    STATE_PAUSED = 2,
-    STATE_COMPLETED = 3
+// Network side copy of the real-time task status, refreshed on every change
+StatusSnapshot status;
+const SessionData& session = status.session;
+uint32_t statusVersion = 0;
+
+// Change tracking for /api/events
+uint32_t publishedStatusVersion = 0;
+int16_t publishedTemperature = TEMP_UNKNOWN_CENTI;
+const int16_t EVENT_TEMPERATURE_STEP_CENTI = 10;    // Push temperature changes of 0.1 °C
+char statusEventBuffer[128];
+
+// Session resumed on a restored clock that may lag (CLOCK_NVS) or drift
+// (CLOCK_RTC); moved to its real start once SNTP has the time. Network task only.
+struct ProvisionalResume {
+    bool pending = false;
+    bool seenRunning = false;       // The real-time task has taken it over
+    SequencePlan plan;
+    uint32_t durationMs = 0;
+    int64_t startEpochMs = 0;       // Journaled wall-clock start
+    uint32_t startTime = 0;         // millis() start it was resumed with
 };
+ProvisionalResume provisionalResume;
+const int32_t RESUME_STEP_TOLERANCE_MS = 5;     // Smaller corrections are left alone
+
+// Network task on core 0, the shot task runs on core 1 (see rt_task.h)
+const uint8_t NETWORK_TASK_CORE = 0;
+const uint32_t NETWORK_TASK_STACK = 8192;
 
-// Session management
-struct SessionData {
-    SessionState state = STATE_IDLE;
-    uint16_t totalMinutes = 0;
-    uint16_t totalShots = 0;
-    uint16_t currentShot = 0;
-    unsigned long sessionStartTime = 0;
-    unsigned long nextShotTime = 0;
-    uint32_t intervalMs = 60000;
-    float lastTemperature = 20.0;
-} session;
-
-// Constants
-const uint16_t MAX_SESSION_MINUTES = 480;
+// Pass interval while the chip may light-sleep; web requests wait this long
+const uint32_t NETWORK_SLEEP_POLL_MS = 250;
+
+// No light sleep this close to a scheduled entry, two slow passes ahead
+const uint32_t SCHEDULE_AWAKE_AHEAD_MS = 2 * NETWORK_SLEEP_POLL_MS;
+
+// JSON document sizes, all taken from the request arena (request_arena.h)
+const size_t JSON_SMALL_CAPACITY = JSON_OBJECT_SIZE(4);
+const size_t JSON_STATUS_CAPACITY = JSON_OBJECT_SIZE(10) + JSON_OBJECT_SIZE(6);
+const size_t JSON_START_CAPACITY = JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(MAX_SEQUENCE_PHASES) +
+                                   MAX_SEQUENCE_PHASES * JSON_OBJECT_SIZE(6);
+const size_t JSON_SCHEDULE_CAPACITY = JSON_START_CAPACITY + JSON_OBJECT_SIZE(6);
+const size_t JSON_POWER_CAPACITY = JSON_OBJECT_SIZE(10);
+const size_t JSON_SYNC_CAPACITY = JSON_OBJECT_SIZE(14) + JSON_ARRAY_SIZE(SYNC_MAX_FOLLOWERS) +
+                                  SYNC_MAX_FOLLOWERS * JSON_OBJECT_SIZE(8);
+const size_t JSON_PROFILES_CAPACITY = JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(IR_PROFILE_COUNT) +
+                                      IR_PROFILE_COUNT * JSON_OBJECT_SIZE(4);
 
 // Function declarations
-bool connectToWiFi();
-void setupWiFiAP();
 void setupWebServer();
 void setupHardware();
-void setupNTP();
-void syncTimeCallback(struct timeval *tv);
 void handleWebServerClient();
-void updateSession();
-void executeShot();
+void noteRequest();
+void networkTask(void* parameter);
+void refreshStatus();
+void logStatusChanges(const StatusSnapshot& previous);
+void resumeJournaledSession(const JournalRecovery& recovery);
+void reanchorResumedSession();
 void handleRoot();
 void handleAPI();
+void sendJson(int code, const JsonDocument& doc);
+void sendJsonText(int code, const char* json);
+char* requestBody(size_t& len);
+uint32_t queryNumber(const char* name, uint32_t fallback);
+bool parseRequestBody(JsonDocument& doc);
+void handleEvents();
+void handleTriggerSocket();
+void publishStatusEvents();
+size_t formatStatusEvent(char* buffer, size_t size);
+uint32_t remainingMinutes();
+void sendHtmlChunk(const char* data, size_t len, void* context);
+void finishHtml(HtmlWriter& out);
 void handleStart();
+const char* parseSessionPlan(JsonObject body, SequencePlan& plan, int64_t startEpochMs);
 void handleStop();
 void handleSingleShot();
 void handleBurstShot();
+void queueShotJob(uint16_t count, uint32_t spacingMs);
 void handleSystemOverview();
-uint16_t calculateTotalShots(uint16_t minutes);
-uint32_t calculateIntervalMs(uint16_t minutes);
+void handleMetrics();
+void handleShots();
+void handleTemperature();
+const char* formatCenti(char* buffer, size_t size, int16_t centi, const char* unknown);
+void handleIrProfiles();
+void handleSetIrProfile();
+IrProfileId loadIrProfileSetting();
+void handlePower();
+void handleSetPower();
+void handleSync();
+void handleSetSync();
+SyncMode loadSyncSetting();
+void handleSchedule();
+void handleAddSchedule();
+void handleCancelSchedule();
+bool parseScheduleTime(JsonVariant value, int64_t afterEpochMs, int64_t& epochMs);
 
 void setup() {
     Serial.begin(115200);
@@ -79,406 +133,1234 @@ void setup() {
     // Initialize hardware
     setupHardware();
     
-    // Try to connect to local WiFi first, fallback to AP mode
-    if (!connectToWiFi()) {
-        Serial.println("Failed to connect to local WiFi, starting Access Point...");
-        setupWiFiAP();
-    } else {
-        // Setup NTP client if connected to internet
-        setupNTP();
+    // Last known wall-clock time until SNTP catches up
+    wallClockRestore();
+    Serial.printf("Wall clock restored from: %s\n", wallClockSourceName());
+    scheduleBegin();
+    
+    // Pick up a session that was running when we lost power
+    JournalRecovery recovery;
+    if (sessionJournalBegin(recovery)) {
+        resumeJournaledSession(recovery);
     }
     
+    // Start connecting to local WiFi, AP fallback and NTP follow in the background
+    networkBegin();
+    syncBegin(loadSyncSetting());
+    
     // Setup web server
     setupWebServer();
     
-    Serial.println("ESP32 initialization complete");
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.print("Connected to WiFi. Local IP: ");
-        Serial.println(WiFi.localIP());
-    } else {
-        Serial.print("Access Point IP: ");
-        Serial.println(WiFi.softAPIP());
+    // Shots on core 1, web server and status push on core 0
+    if (!rtTaskStart()) {
+        Serial.println("Failed to start real-time shot task!");
     }
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr, 1, nullptr, NETWORK_TASK_CORE);
+    
+    bootTiming.webReadyMs = millis();
+    Serial.printf("ESP32 initialization complete after %lu ms\n", (unsigned long)bootTiming.webReadyMs);
 }
 
 void loop() {
-    // Handle web server
-    handleWebServerClient();
-    
-    // Update session logic
-    updateSession();
-    
-    delay(100); // Small delay to prevent watchdog issues
+    // All work happens in networkTask and the real-time shot task
+    vTaskDelete(NULL);
 }
 
-void setupHardware() {
-    // Initialize IR sender using IRremote library
-    IrSender.begin(IR_SEND_PIN);
-    Serial.println("IR sender initialized on pin " + String(IR_SEND_PIN));
+void networkTask(void* parameter) {
+    for (;;) {
+        // WiFi connect / AP fallback / SNTP state machine
+        networkUpdate();
+        
+        // Light sleep would drop the access point and stall the connect,
+        // and a sleeping leader or follower misses beacons
+        if (networkState() != NET_STATION || syncMode() != SYNC_OFF) rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+        
+        refreshStatus();
+        
+        // A session resumed before SNTP moves to its real start once synced
+        reanchorResumedSession();
+        
+        // Manual triggers first, they are the latency-sensitive part;
+        // an open trigger page also keeps the chip out of light sleep
+        triggerSocketUpdate(status);
+        if (triggerSocketClientCount() > 0) rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+        
+        syncUpdate(status);
+        
+        // Wall-clock starts, stops and shots; stay awake for the next one
+        scheduleUpdate(status);
+        if (scheduleTimeToNext(SCHEDULE_AWAKE_AHEAD_MS) < SCHEDULE_AWAKE_AHEAD_MS) rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+        
+        sessionJournalMaintain();
+        
+        // Handle web server, then drop everything the request used
+        handleWebServerClient();
+        requestArenaReset();
+        
+        // Push session changes to /api/events subscribers, who would
+        // otherwise get them a sleep late
+        publishStatusEvents();
+        if (statusEventsClientCount() > 0) rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+        
+        // A 1 ms pass is too short for the idle task to light-sleep
+        delay(rtLightSleepPermitted() ? NETWORK_SLEEP_POLL_MS : 1);
+    }
 }
 
-bool connectToWiFi() {
-    Serial.printf("Connecting to WiFi: %s\n", WIFI_SSID_CONFIG);
-
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID_CONFIG, WIFI_PASSWORD_CONFIG);
-    
-    unsigned long startTime = millis();
-    while (WiFi.status() != WL_CONNECTED && millis() - startTime < WIFI_TIMEOUT) {
-        delay(500);
-        Serial.print(".");
+void setupHardware() {
+    // Profiles are encoded at compile time, the RMT peripheral only replays them
+    IrProfileId profile = loadIrProfileSetting();
+    if (irTransmitterBegin(IR_SEND_PIN) && sessionBegin(profile)) {
+        const IrPulseTrain& train = *IR_PROFILES[profile].train;
+        Serial.printf("IR sender initialized on pin %d: %s (%d pulses, %lu us)\n",
+                      IR_SEND_PIN, IR_PROFILES[profile].name, train.count,
+                      (unsigned long)irTrainDurationUs(train));
+    } else {
+        Serial.println("Failed to initialize RMT IR sender!");
     }
-    Serial.println();
     
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("WiFi connected successfully!");
-        Serial.print("IP Address: ");
-        Serial.println(WiFi.localIP());
-        Serial.print("Signal strength: ");
-        Serial.print(WiFi.RSSI());
-        Serial.println(" dBm");
-        return true;
+    // Sampled in the background from here on, shots only read the result
+    if (temperatureSensorBegin()) {
+        Serial.printf("Temperature sampling started: %s sensor\n", temperatureSensorName());
     } else {
-        Serial.printf("WiFi connection failed. Status: %d\n", WiFi.status());
-        return false;
+        Serial.println("Failed to start temperature sampling!");
     }
-}
-
-void setupWiFiAP() {
-    WiFi.mode(WIFI_AP);
-    delay(100);
     
-    IPAddress local_IP(192, 168, 4, 1);
-    IPAddress gateway(192, 168, 4, 1);
-    IPAddress subnet(255, 255, 255, 0);
-    WiFi.softAPConfig(local_IP, gateway, subnet);
-    
-    bool result = WiFi.softAP(AP_SSID_CONFIG, AP_PASSWORD_CONFIG);
-    delay(1000);
-
-    if (result) {
-        Serial.printf("Access Point '%s' started successfully\n", AP_SSID_CONFIG);
-        Serial.print("AP IP Address: ");
-        Serial.println(WiFi.softAPIP());
-        Serial.printf("AP Password: %s\n", AP_PASSWORD_CONFIG);
-        Serial.println("Connect to AstroController WiFi and go to http://192.168.4.1");
+    if (shotLogBegin()) {
+        Serial.printf("Shot telemetry: %lu records\n", (unsigned long)shotLogCapacity());
     } else {
-        Serial.println("Failed to start Access Point!");
+        Serial.println("Failed to allocate shot telemetry ring!");
     }
-}
-
-void syncTimeCallback(struct timeval *tv) {
-    ntpSynced = true;
-    Serial.println("NTP time synchronized successfully!");
     
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-        Serial.printf("Current time: %04d-%02d-%02d %02d:%02d:%02d\n",
-                     timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
-                     timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+    // Field mode chosen through /api/power, kept in NVS
+    Preferences prefs;
+    if (prefs.begin("power", true)) {
+        rtSetIdleSleep(prefs.getBool("sleep", false));
+        prefs.end();
     }
+    if (rtIdleSleepEnabled()) Serial.println("Light sleep between shots enabled");
 }
 
-void setupNTP() {
-    Serial.println("Setting up NTP client...");
-    
-    // Set time sync notification callback
-    sntp_set_time_sync_notification_cb(syncTimeCallback);
-    
-    // Configure SNTP
-    esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
-    esp_sntp_setservername(0, ntpServer);
-    esp_sntp_set_sync_mode(SNTP_SYNC_MODE_IMMED);
-    esp_sntp_init();
-    
-    // Set timezone
-    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
-    tzset();
-    
-    Serial.printf("NTP server: %s\n", ntpServer);
-    Serial.println("Waiting for time synchronization...");
-    
-    // Wait for time sync (with timeout)
-    int timeout = 30; // 30 seconds timeout
-    while (!ntpSynced && timeout > 0) {
-        delay(1000);
-        timeout--;
-        Serial.print(".");
-    }
-    Serial.println();
-    
-    if (ntpSynced) {
-        Serial.println("NTP synchronization successful!");
-    } else {
-        Serial.println("NTP synchronization timeout - continuing without sync");
+// Camera profile chosen through /api/ir, kept in NVS
+IrProfileId loadIrProfileSetting() {
+    IrProfileId profile = IR_PROFILE_DEFAULT;
+    Preferences prefs;
+    if (prefs.begin("ir", true)) {
+        char key[16] = "";
+        prefs.getString("profile", key, sizeof(key));
+        prefs.end();
+        irProfileFind(key, profile);
     }
+    return profile;
 }
 
 void setupWebServer() {
+    // Needed for ETag revalidation of the static page and the trigger upgrade
+    static const char* headerKeys[] = {"If-None-Match", "Upgrade", "Sec-WebSocket-Key"};
+    server.collectHeaders(headerKeys, 3);
+    
     server.on("/", handleRoot);
     server.on("/api/status", handleAPI);
+    server.on("/api/events", HTTP_GET, handleEvents);
+    server.on("/api/trigger", HTTP_GET, handleTriggerSocket);
     server.on("/start", HTTP_POST, handleStart);
     server.on("/stop", HTTP_POST, handleStop);
     server.on("/shot", HTTP_POST, handleSingleShot);
     server.on("/burst", HTTP_POST, handleBurstShot);
     server.on("/system", handleSystemOverview);
+    server.on("/api/metrics", HTTP_GET, handleMetrics);
+    server.on("/api/shots", HTTP_GET, handleShots);
+    server.on("/api/temperature", HTTP_GET, handleTemperature);
+    server.on("/api/ir", HTTP_GET, handleIrProfiles);
+    server.on("/api/ir", HTTP_POST, handleSetIrProfile);
+    server.on("/api/power", HTTP_GET, handlePower);
+    server.on("/api/power", HTTP_POST, handleSetPower);
+    server.on("/api/sync", HTTP_GET, handleSync);
+    server.on("/api/sync", HTTP_POST, handleSetSync);
+    server.on("/api/schedule", HTTP_GET, handleSchedule);
+    server.on("/api/schedule", HTTP_POST, handleAddSchedule);
+    server.on("/api/schedule", HTTP_DELETE, handleCancelSchedule);
     
     server.begin();
     Serial.println("Web server started on port 80");
 }
 
+// Boot timing: first HTTP request after reset. Someone is using the web
+// side, so the shot task stays out of light sleep for a while.
+void noteRequest() {
+    rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+    
+    if (bootTiming.firstRequestMs == 0) {
+        bootTiming.firstRequestMs = millis();
+        Serial.printf("First HTTP request %lu ms after reset\n", (unsigned long)bootTiming.firstRequestMs);
+    }
+}
+
 void handleWebServerClient() {
+    METRIC_TIME_SCOPE(METRIC_HANDLE_CLIENT);
     server.handleClient();
 }
 
-void updateSession() {
-    if (session.state != STATE_RUNNING) return;
+void refreshStatus() {
+    uint32_t version = rtStatusVersion();
+    if (version == statusVersion) return;
     
-    // Check if it's time for next shot
-    if (millis() >= session.nextShotTime) {
-        executeShot();
-        
-        session.currentShot++;
-        session.nextShotTime = millis() + session.intervalMs;
-        
-        // Check if session is complete
-        if (session.currentShot >= session.totalShots) {
-            session.state = STATE_COMPLETED;
-            Serial.println("Session completed!");
-        }
-    }
+    StatusSnapshot previous = status;
+    rtReadStatus(status);
+    statusVersion = version;
+    logStatusChanges(previous);
+    sessionJournalOnStatus(previous, status);
 }
 
-void executeShot() {
-    Serial.printf("Taking shot %d/%d\n", session.currentShot + 1, session.totalShots);
+// Maps the journaled wall-clock start onto this boot's millis() and queues
+// the session for the real-time task. Needs a restored wall clock; unless
+// it came from SNTP the resume is provisional, see reanchorResumedSession().
+void resumeJournaledSession(const JournalRecovery& recovery) {
+    if (!recovery.sessionActive) return;
     
-    // Send Sony SIRC command using IRremote library
-    IrSender.sendSony(0x1E3A, 0x2D, 3, 20);
+    if (wallClockSource() == CLOCK_NONE) {
+        Serial.println("Interrupted session found, but no wall-clock time to resume it");
+        return;
+    }
     
-    Serial.printf("Sent Sony IR: Address=0x%X, Command=0x%X, Bits=20, Repeats=3\n", 0x1E3A, 0x2D);
+    ControlCommand command;
+    command.type = CMD_RESUME_SESSION;
+    SequenceSummary summary;
+    if (!sessionJournalLoadPlan(command.plan) ||
+        sequenceCompile(command.plan, SESSION_START_DELAY_MS, nullptr, 0, summary) != SEQUENCE_OK ||
+        summary.shots != recovery.totalShots) {
+        Serial.println("Interrupted session found, but its sequence is missing or does not match");
+        return;
+    }
+    
+    // The flash clock only lags, so a session it calls expired is expired;
+    // a start after it is the time lost since its last save
+    WallClockSource source = wallClockSource();
+    int64_t elapsedMs = wallClockEpochMs() - recovery.startEpochMs;
+    if (elapsedMs < 0 && source == CLOCK_NVS) elapsedMs = 0;
+    if (elapsedMs < 0 || elapsedMs >= summary.durationMs) {
+        Serial.println("Interrupted session has already expired, not resuming");
+        return;
+    }
     
-    delay(100);
+    command.startTime = millis() - (uint32_t)elapsedMs;
+    command.nextShot = recovery.nextShot;
+    if (!rtSubmit(command)) return;
+    
+    if (source != CLOCK_NTP) {
+        provisionalResume.pending = true;
+        provisionalResume.seenRunning = false;
+        provisionalResume.plan = command.plan;
+        provisionalResume.durationMs = summary.durationMs;
+        provisionalResume.startEpochMs = recovery.startEpochMs;
+        provisionalResume.startTime = command.startTime;
+    }
+    
+    Serial.printf("Resuming session %lu at shot %d/%d, started %lu s ago (%s clock)\n",
+                  (unsigned long)recovery.sessionId, recovery.nextShot, recovery.totalShots,
+                  (unsigned long)(elapsedMs / 1000), wallClockSourceName());
 }
 
-uint16_t calculateTotalShots(uint16_t minutes) {
-    // Calculate shots based on interval (10 seconds for testing)
-    return (minutes * 60) / 10;
+// The restored clock was behind by up to the power-off time, so the resumed
+// session runs late. Once SNTP steps the clock, its start moves back to the
+// journaled wall-clock start like a follower's does (CMD_SYNC_SESSION):
+// overdue slots are skipped, or the session ends if it ran out meanwhile.
+void reanchorResumedSession() {
+    if (!provisionalResume.pending) return;
+    
+    // Stopped, completed or replaced by another session in the meantime
+    bool ours = session.state == STATE_RUNNING && session.sessionStartTime == provisionalResume.startTime;
+    if (ours) provisionalResume.seenRunning = true;
+    if (!ours && (provisionalResume.seenRunning || session.state == STATE_RUNNING)) {
+        provisionalResume.pending = false;
+        return;
+    }
+    if (!ours || wallClockSource() != CLOCK_NTP) return;
+    
+    ControlCommand command;
+    int64_t elapsedMs = wallClockEpochMs() - provisionalResume.startEpochMs;
+    if (elapsedMs >= provisionalResume.durationMs) {
+        command.type = CMD_STOP_SESSION;
+    } else {
+        command.type = CMD_SYNC_SESSION;
+        command.plan = provisionalResume.plan;
+        command.startTime = millis() - (uint32_t)(elapsedMs > 0 ? elapsedMs : 0);
+        int32_t shiftMs = (int32_t)(provisionalResume.startTime - command.startTime);
+        if (shiftMs > -RESUME_STEP_TOLERANCE_MS && shiftMs < RESUME_STEP_TOLERANCE_MS) {
+            provisionalResume.pending = false;
+            return;
+        }
+    }
+    
+    // Command queue full: try again on the next pass
+    if (!rtSubmit(command)) return;
+    provisionalResume.pending = false;
+    
+    if (command.type == CMD_STOP_SESSION) {
+        Serial.println("Resumed session had already expired by SNTP time, stopped");
+    } else {
+        Serial.printf("Resumed session moved %ld ms earlier after SNTP sync\n",
+                      (long)(int32_t)(provisionalResume.startTime - command.startTime));
+    }
 }
 
-uint32_t calculateIntervalMs(uint16_t minutes) {
-    // Fixed 10 second interval for testing
-    return 10000;
+// Serial logging happens here on the network core, never in the shot task
+void logStatusChanges(const StatusSnapshot& previous) {
+    if (session.state == STATE_RUNNING && previous.session.state != STATE_RUNNING) {
+        Serial.printf("Session started: %d minutes, %d shots\n", session.totalMinutes, session.totalShots);
+    }
+    if (status.lateness.missed > previous.lateness.missed) {
+        Serial.printf("Skipped %lu overdue shots\n", (unsigned long)(status.lateness.missed - previous.lateness.missed));
+    }
+    if (status.lateness.count > previous.lateness.count) {
+        Serial.printf("Taking shot %d/%d\n", session.currentShot, session.totalShots);
+    }
+    if (status.jobShotsFired > previous.jobShotsFired) {
+        Serial.printf("Job %lu shot sent\n", (unsigned long)status.lastJobId);
+    }
+    if (status.jobsRejected > previous.jobsRejected) {
+        Serial.println("Job queue full, job dropped");
+    }
+    if (session.state == STATE_IDLE && previous.session.state == STATE_RUNNING) {
+        Serial.println("Session stopped");
+    }
+    if (session.state == STATE_COMPLETED && previous.session.state != STATE_COMPLETED) {
+        Serial.printf("Session completed! Lateness min/mean/p99/max: %lu/%lu/%lu/%lu ms\n",
+                      (unsigned long)status.lateness.minMs, (unsigned long)latenessMeanMs(status.lateness),
+                      (unsigned long)latenessPercentileMs(status.lateness, 99), (unsigned long)status.lateness.maxMs);
+    }
 }
 
 // Web server handlers
 void handleRoot() {
-    String html = "<!DOCTYPE html><html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">";
-    html += "<title>AstroController Rev 1</title>";
-    html += "<style>body { background: #1a1a1a; color: #ff6b6b; font-family: monospace; margin: 0; padding: 20px; }";
-    html += ".container { max-width: 400px; margin: 0 auto; } h1 { text-align: center; color: #ff6b6b; }";
-    html += ".status { background: #2a2a2a; padding: 15px; border-radius: 8px; margin: 20px 0; }";
-    html += "button { background: #ff6b6b; color: #000; padding: 15px 20px; border: none; margin: 5px; border-radius: 4px; cursor: pointer; }";
-    html += "input[type=\"number\"] { background: #2a2a2a; color: #fff; border: 1px solid #444; padding: 10px; width: 100%; }";
-    html += "</style></head><body><div class=\"container\">";
-    html += "<h1>AstroController Rev 1</h1>";
-    html += "<div class=\"status\" id=\"status\">System ready</div>";
-    html += "<div><label>Total time (minutes):</label>";
-    html += "<input type=\"number\" id=\"minutes\" value=\"60\" min=\"1\" max=\"480\" onchange=\"updateCalculation()\">";
-    html += "<div id=\"calculation\" style=\"margin: 10px 0; color: #ccc;\"></div>";
-    html += "<button onclick=\"startSession()\">Start Session</button>";
-    html += "<button onclick=\"stopSession()\">Stop</button>";
-    html += "<button onclick=\"takeSingleShot()\" style=\"background: #4CAF50;\">Single Shot</button>";
-    html += "<button onclick=\"takeBurstShot()\" style=\"background: #FF9800;\">10 Shot Burst</button>";
-    html += "<br><a href=\"/system\" style=\"color: #ff6b6b; text-decoration: none;\">System Overview</a></div>";
-    html += "<div id=\"progress\"></div></div><script>";
-    html += "function calculateShots(minutes) { return Math.floor((minutes * 60) / 10); }";
-    html += "function calculateInterval(minutes) { return 10; }";
-    html += "function updateCalculation() { const minutes = parseInt(document.getElementById('minutes').value) || 60; ";
-    html += "const shots = calculateShots(minutes); const interval = calculateInterval(minutes); ";
-    html += "document.getElementById('calculation').innerHTML = shots + ' shots, every ' + interval + 's'; }";
-    html += "function startSession() { const minutes = parseInt(document.getElementById('minutes').value); ";
-    html += "fetch('/start', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({minutes: minutes}) });";
-    html += "} function stopSession() { fetch('/stop', {method: 'POST'}); }";
-    html += "function takeSingleShot() { fetch('/shot', {method: 'POST'}); }";
-    html += "function takeBurstShot() { fetch('/burst', {method: 'POST'}); }";
-    html += "function updateStatus() { fetch('/api/status').then(r => r.json()).then(data => {";
-    html += "const statusEl = document.getElementById('status'); const progressEl = document.getElementById('progress');";
-    html += "if (data.state === 1) { statusEl.innerHTML = 'Session active - Photo ' + data.current + '/' + data.total; ";
-    html += "progressEl.innerHTML = data.remaining + ' minutes remaining<br>Temp: ' + data.temperature.toFixed(1) + '°C'; }";
-    html += "else if (data.state === 3) { statusEl.innerHTML = 'Session completed!'; progressEl.innerHTML = data.total + ' photos taken'; }";
-    html += "else { statusEl.innerHTML = 'System ready'; progressEl.innerHTML = 'Temp: ' + data.temperature.toFixed(1) + '°C'; }";
-    html += "}); } setInterval(updateStatus, 5000); updateStatus(); updateCalculation(); </script></body></html>";
-    
-    server.send(200, "text/html", html);
+    METRIC_TIME_SCOPE(METRIC_HTTP_ROOT);
+    noteRequest();
+    
+    // The page is a gzip-compressed flash array generated from web/index.html
+    server.sendHeader("ETag", INDEX_HTML_ETAG);
+    server.sendHeader("Cache-Control", "no-cache");
+    
+    // Browser already has this revision of the page
+    if (server.header("If-None-Match") == INDEX_HTML_ETAG) {
+        server.send(304);
+        return;
+    }
+    
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, "text/html", (const char*)INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
+}
+
+uint32_t remainingMinutes() {
+    if (session.state != STATE_RUNNING || session.totalShots == 0) return 0;
+    
+    // Sequences vary the interval, go by the planned end instead
+    uint32_t elapsed = millis() - session.sessionStartTime;
+    if (elapsed >= session.durationMs) return 0;
+    return (session.durationMs - elapsed) / 60000;
+}
+
+// "21.37" from 1/100 °C, `unknown` without a reading
+const char* formatCenti(char* buffer, size_t size, int16_t centi, const char* unknown) {
+    if (centi == TEMP_UNKNOWN_CENTI) return unknown;
+    int magnitude = abs(centi);
+    snprintf(buffer, size, "%s%d.%02d", centi < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+    return buffer;
+}
+
+// Compact status for /api/events, same field names as /api/status
+size_t formatStatusEvent(char* buffer, size_t size) {
+    char temperature[8];
+    int len = snprintf(buffer, size,
+                       "{\"state\":%d,\"current\":%u,\"total\":%u,\"remaining\":%lu,\"temperature\":%s}",
+                       session.state, session.currentShot, session.totalShots, (unsigned long)remainingMinutes(),
+                       formatCenti(temperature, sizeof(temperature), temperatureLatestCenti(), "null"));
+    if (len < 0) return 0;
+    return (size_t)len < size ? len : size - 1;
+}
+
+void publishStatusEvents() {
+    // statusVersion follows the real-time task via refreshStatus(); the
+    // temperature is not part of it and goes out when it moved visibly
+    int16_t temperature = temperatureLatestCenti();
+    bool temperatureMoved = abs(temperature - publishedTemperature) >= EVENT_TEMPERATURE_STEP_CENTI;
+    if (statusVersion != publishedStatusVersion || temperatureMoved) {
+        publishedStatusVersion = statusVersion;
+        publishedTemperature = temperature;
+        size_t len = formatStatusEvent(statusEventBuffer, sizeof(statusEventBuffer));
+        statusEventsPublish(statusEventBuffer, len);
+    }
+    statusEventsMaintain();
+}
+
+void handleEvents() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_EVENTS);
+    noteRequest();
+    
+    // The socket stays open as an SSE stream after this handler returns
+    size_t len = formatStatusEvent(statusEventBuffer, sizeof(statusEventBuffer));
+    WiFiClient client = server.client();
+    if (!statusEventsSubscribe(client, statusEventBuffer, len)) {
+        sendJsonText(503, "{\"error\":\"Too many event clients\"}");
+    }
+}
+
+void handleTriggerSocket() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_TRIGGER);
+    noteRequest();
+    
+    if (!server.header("Upgrade").equalsIgnoreCase("websocket")) {
+        sendJsonText(426, "{\"error\":\"WebSocket upgrade required\"}");
+        return;
+    }
+    
+    // The socket stays open as a WebSocket after this handler returns
+    WiFiClient client = server.client();
+    if (!triggerSocketAccept(client, server.header("Sec-WebSocket-Key").c_str())) {
+        sendJsonText(400, "{\"error\":\"Invalid WebSocket key\"}");
+    }
 }
 
 void handleAPI() {
-    DynamicJsonDocument doc(512);
+    METRIC_TIME_SCOPE(METRIC_HTTP_STATUS);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_STATUS_CAPACITY);
     
     doc["state"] = session.state;
     doc["current"] = session.currentShot;
     doc["total"] = session.totalShots;
-    doc["remaining"] = 0;
+    doc["remaining"] = remainingMinutes();
+    int16_t temperature = temperatureLatestCenti();
+    if (temperature != TEMP_UNKNOWN_CENTI) {
+        doc["temperature"] = temperature / 100.0f;
+    } else {
+        doc["temperature"] = nullptr;
+    }
+    doc["jobs"] = status.jobsPending;
+    doc["clock"] = wallClockSourceName();
+    doc["ir_profile"] = IR_PROFILES[status.irProfile].key;
+    
+    // Shot lateness against the absolute schedule, in milliseconds
+    JsonObject lateness = doc.createNestedObject("lateness");
+    lateness["count"] = status.lateness.count;
+    lateness["min"] = status.lateness.minMs;
+    lateness["max"] = status.lateness.maxMs;
+    lateness["mean"] = latenessMeanMs(status.lateness);
+    lateness["p99"] = latenessPercentileMs(status.lateness, 99);
+    lateness["missed"] = status.lateness.missed;
     
-    if (session.state == STATE_RUNNING && session.totalShots > 0) {
-        uint16_t remainingShots = session.totalShots - session.currentShot;
-        doc["remaining"] = (remainingShots * session.intervalMs) / 60000;
+    sendJson(200, doc);
+}
+
+// Serializes into the request arena and sends it as one block
+void sendJson(int code, const JsonDocument& doc) {
+    if (doc.overflowed()) {
+        sendJsonText(500, "{\"error\":\"Response too large\"}");
+        return;
     }
     
-    doc["temperature"] = session.lastTemperature;
+    size_t len = measureJson(doc);
+    char* buffer = (char*)requestArenaAllocate(len + 1);
+    if (buffer == nullptr) {
+        sendJsonText(500, "{\"error\":\"Out of request memory\"}");
+        return;
+    }
+    serializeJson(doc, buffer, len + 1);
+    server.send_P(code, "application/json", buffer, len);
+}
+
+// send_P takes the body as is, send() would copy it into a String
+void sendJsonText(int code, const char* json) {
+    server.send_P(code, "application/json", json, strlen(json));
+}
+
+// Request body copied into the arena, nullptr if missing or too large.
+// server.arg() returns the body by value: every call is one more heap
+// String copy of it next to the library's own. That copy is freed when
+// this returns, before parsing; ArduinoJson works on the arena copy.
+char* requestBody(size_t& len) {
+    if (!server.hasArg("plain")) return nullptr;
     
-    String response;
-    serializeJson(doc, response);
-    server.send(200, "application/json", response);
+    String body = server.arg("plain");
+    len = body.length();
+    if (len > MAX_REQUEST_BODY) return nullptr;
+    return requestArenaCopy(body.c_str(), len);
+}
+
+// Numeric query parameter, `fallback` if absent. Like any server.arg(),
+// this makes a String copy of the value; short values fit into the String
+// itself, longer ones are a heap allocation freed on return.
+uint32_t queryNumber(const char* name, uint32_t fallback) {
+    if (!server.hasArg(name)) return fallback;
+    return strtoul(server.arg(name).c_str(), nullptr, 10);
+}
+
+// Parses the body in place: strings in `doc` point into the arena copy.
+// Sends the error response itself and returns false on failure.
+bool parseRequestBody(JsonDocument& doc) {
+    size_t len = 0;
+    char* body = requestBody(len);
+    if (body == nullptr) {
+        sendJsonText(413, "{\"error\":\"Missing or oversized body\"}");
+        return false;
+    }
+    DeserializationError error = deserializeJson(doc, body, len);
+    if (error == DeserializationError::NoMemory) {
+        sendJsonText(413, "{\"error\":\"Request too complex\"}");
+        return false;
+    }
+    if (error) {
+        sendJsonText(400, "{\"error\":\"Invalid JSON\"}");
+        return false;
+    }
+    return true;
 }
 
 void handleStart() {
-    if (session.state != STATE_IDLE) {
-        server.send(400, "application/json", "{\"error\":\"Session already running\"}");
+    METRIC_TIME_SCOPE(METRIC_HTTP_START);
+    noteRequest();
+    
+    if (session.state == STATE_RUNNING) {
+        sendJsonText(400, "{\"error\":\"Session already running\"}");
         return;
     }
+    if (syncMode() == SYNC_FOLLOWER) {
+        sendJsonText(409, "{\"error\":\"Following a leader, start the session there\"}");
+        return;
+    }
+    
+    ArenaJsonDocument doc(JSON_START_CAPACITY);
+    if (!parseRequestBody(doc)) return;
     
-    DynamicJsonDocument doc(256);
-    deserializeJson(doc, server.arg("plain"));
+    ControlCommand command;
+    command.type = CMD_START_SESSION;
+    const char* error = parseSessionPlan(doc.as<JsonObject>(), command.plan, wallClockEpochMs());
+    
+    // Compile once here to validate, the real-time task compiles again into its table
+    SequenceSummary summary;
+    if (error == nullptr) {
+        SequenceError result = sequenceCompile(command.plan, SESSION_START_DELAY_MS, nullptr, 0, summary);
+        if (result != SEQUENCE_OK) error = sequenceErrorText(result);
+    }
+    if (error != nullptr) {
+        char body[128];
+        snprintf(body, sizeof(body), "{\"error\":\"%s\"}", error);
+        sendJsonText(400, body);
+        return;
+    }
     
-    uint16_t minutes = doc["minutes"];
-    if (minutes < 1 || minutes > MAX_SESSION_MINUTES) {
-        server.send(400, "application/json", "{\"error\":\"Invalid duration\"}");
+    // Start session, the real-time task takes over from here
+    if (!rtSubmit(command)) {
+        sendJsonText(503, "{\"error\":\"Command queue full\"}");
         return;
     }
     
-    // Start session
-    session.totalMinutes = minutes;
-    session.totalShots = calculateTotalShots(minutes);
-    session.intervalMs = calculateIntervalMs(minutes);
-    session.currentShot = 0;
-    session.sessionStartTime = millis();
-    session.nextShotTime = millis() + 5000; // 5s delay
-    session.state = STATE_RUNNING;
+    // Kept for resuming after a reset; only once the start is queued, a
+    // refused one must not replace the plan on flash
+    sessionJournalSavePlan(command.plan);
     
-    Serial.printf("Session started: %d minutes, %d shots\n", minutes, session.totalShots);
+    char body[96];
+    snprintf(body, sizeof(body), "{\"success\":true,\"shots\":%u,\"duration\":%lu}",
+             summary.shots, (unsigned long)summary.durationMs);
+    sendJsonText(200, body);
+}
+
+// Reads {"minutes": N} or {"phases": [...]} into `plan`; returns an error
+// message or nullptr. Absolute start times are converted to offsets from
+// the session start at `startEpochMs`.
+const char* parseSessionPlan(JsonObject body, SequencePlan& plan, int64_t startEpochMs) {
+    JsonArray phases = body["phases"];
+    if (phases.isNull()) {
+        uint16_t minutes = body["minutes"] | 0;
+        if (minutes < 1 || minutes > MAX_SESSION_MINUTES) return "Invalid duration";
+        sessionPlanForMinutes(plan, minutes);
+        return nullptr;
+    }
     
-    server.send(200, "application/json", "{\"success\":true}");
+    if (phases.size() == 0 || phases.size() > MAX_SEQUENCE_PHASES) return sequenceErrorText(SEQUENCE_NO_PHASES);
+    
+    plan = SequencePlan();
+    for (JsonObject item : phases) {
+        SequencePhase& phase = plan.phases[plan.phaseCount++];
+        const char* type = item["type"] | "fixed";
+        
+        if (strcmp(type, "fixed") == 0 || strcmp(type, "burst") == 0) {
+            phase.type = type[0] == 'f' ? PHASE_FIXED : PHASE_BURST;
+            phase.shots = item["shots"] | 0;
+            phase.intervalMs = item["interval"] | 0;
+        } else if (strcmp(type, "ramp") == 0) {
+            const char* curve = item["curve"] | "linear";
+            if (strcmp(curve, "linear") != 0 && strcmp(curve, "exp") != 0) return "Ramp curve must be linear or exp";
+            phase.type = curve[0] == 'e' ? PHASE_RAMP_EXP : PHASE_RAMP_LINEAR;
+            phase.shots = item["shots"] | 0;
+            phase.intervalMs = item["from"] | 0;
+            phase.endIntervalMs = item["to"] | 0;
+        } else if (strcmp(type, "pause") == 0) {
+            phase.type = PHASE_PAUSE;
+            phase.durationMs = item["duration"] | 0;
+        } else if (strcmp(type, "at") == 0) {
+            if (wallClockSource() == CLOCK_NONE) return "Start times need the wall clock, not synchronized yet";
+            int64_t offsetMs = (int64_t)(item["time"] | 0LL) * 1000 - startEpochMs;
+            if (offsetMs < 0) return sequenceErrorText(SEQUENCE_AT_IN_PAST);
+            if (offsetMs > MAX_SEQUENCE_DURATION_MS) return sequenceErrorText(SEQUENCE_TOO_LONG);
+            phase.type = PHASE_AT;
+            phase.durationMs = (uint32_t)offsetMs;
+        } else {
+            return sequenceErrorText(SEQUENCE_BAD_PHASE);
+        }
+    }
+    return nullptr;
 }
 
 void handleStop() {
-    if (session.state == STATE_RUNNING) {
-        session.state = STATE_IDLE;
-        Serial.println("Session stopped");
+    METRIC_TIME_SCOPE(METRIC_HTTP_STOP);
+    noteRequest();
+    
+    ControlCommand command;
+    command.type = CMD_STOP_SESSION;
+    if (!rtSubmit(command)) {
+        sendJsonText(503, "{\"error\":\"Command queue full\"}");
+        return;
     }
     
-    server.send(200, "application/json", "{\"success\":true}");
+    sendJsonText(200, "{\"success\":true}");
+}
+
+void queueShotJob(uint16_t count, uint32_t spacingMs) {
+    uint32_t id = rtSubmitShotJob(count, spacingMs);
+    if (id == 0) {
+        sendJsonText(503, "{\"error\":\"Command queue full\"}");
+        return;
+    }
+    
+    Serial.printf("Job %lu queued: %d shots, %lu ms apart\n", (unsigned long)id, count, (unsigned long)spacingMs);
+    
+    char response[48];
+    snprintf(response, sizeof(response), "{\"success\":true,\"job\":%lu}", (unsigned long)id);
+    sendJsonText(202, response);
 }
 
 void handleSingleShot() {
-    Serial.println("Single shot triggered");
-    executeShot();
-    server.send(200, "application/json", "{\"success\":true}");
+    METRIC_TIME_SCOPE(METRIC_HTTP_SHOT);
+    noteRequest();
+    
+    queueShotJob(1, 0);
 }
 
 void handleBurstShot() {
-    Serial.println("10-shot burst triggered");
+    METRIC_TIME_SCOPE(METRIC_HTTP_BURST);
+    noteRequest();
     
-    for (int i = 0; i < 10; i++) {
-        Serial.printf("Burst shot %d/10\n", i + 1);
-        executeShot();
-        
-        if (i < 9) {
-            delay(1000); // 1 second delay between burst shots
-        }
+    uint16_t count = DEFAULT_BURST_COUNT;
+    uint32_t spacingMs = DEFAULT_BURST_SPACING_MS;
+    
+    // Optional {"count": n, "spacing": ms}, defaults to the classic 10 shot burst
+    if (server.hasArg("plain")) {
+        ArenaJsonDocument doc(JSON_SMALL_CAPACITY);
+        if (!parseRequestBody(doc)) return;
+        count = doc["count"] | count;
+        spacingMs = doc["spacing"] | spacingMs;
     }
     
-    Serial.println("Burst sequence completed");
-    server.send(200, "application/json", "{\"success\":true}");
+    if (count < 1 || count > MAX_BURST_COUNT ||
+        spacingMs < MIN_BURST_SPACING_MS || spacingMs > MAX_BURST_SPACING_MS) {
+        sendJsonText(400, "{\"error\":\"Invalid burst parameters\"}");
+        return;
+    }
+    
+    queueShotJob(count, spacingMs);
+}
+
+// Sends each filled HtmlWriter buffer as one HTTP chunk
+void sendHtmlChunk(const char* data, size_t len, void* context) {
+    server.sendContent(data, len);
+}
+
+// Last partial buffer, then the terminating zero-length chunk
+void finishHtml(HtmlWriter& out) {
+    out.flush();
+    server.sendContent("");
+    if (out.truncationCount() > 0) {
+        METRIC_COUNT(METRIC_HTML_TRUNCATED);
+        Serial.printf("%s: %u printf outputs cut at the chunk buffer size\n", server.uri().c_str(),
+                      (unsigned)out.truncationCount());
+    }
 }
 
 void handleSystemOverview() {
-    String html = "<!DOCTYPE html><html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">";
-    html += "<title>AstroController Rev 1 - System Overview</title>";
-    html += "<style>body { background: #1a1a1a; color: #ff6b6b; font-family: monospace; margin: 0; padding: 20px; }";
-    html += ".container { max-width: 800px; margin: 0 auto; } h1, h2 { color: #ff6b6b; }";
-    html += ".component { background: #2a2a2a; padding: 15px; border-radius: 8px; margin: 15px 0; }";
-    html += ".status-ok { color: #4CAF50; } .status-warn { color: #FFC107; } .status-err { color: #F44336; }";
-    html += ".back { color: #ff6b6b; text-decoration: none; }";
-    html += "</style></head><body><div class=\"container\">";
-    
-    html += "<h1>AstroController Rev 1 System</h1>";
-    html += "<a href=\"/\" class=\"back\">← Back to Control</a>";
-    
-    html += "<h2>System Architecture</h2>";
-    html += "<div class=\"component\">";
-    html += "<h3>ESP32 D32 Pro (Standalone)</h3>";
-    html += "<p><strong>Function:</strong> IR sender for camera, session management, web interface</p>";
-    html += "<p><strong>Hardware:</strong> IR LED on GPIO 4, WiFi, HTTP API</p>";
-    html += "<p><strong>Status:</strong> <span class=\"status-ok\">Online</span></p>";
-    html += "<p><strong>IP:</strong> " + WiFi.localIP().toString() + "</p>";
-    html += "<p><strong>Memory:</strong> " + String(ESP.getFreeHeap() / 1024) + " KB free</p>";
-    html += "</div>";
-    
-    html += "<h2>Current Session</h2>";
-    html += "<div class=\"component\">";
-    html += "<p><strong>Status:</strong> ";
+    METRIC_TIME_SCOPE(METRIC_HTTP_SYSTEM);
+    noteRequest();
+    
+    // Rendered in chunks through a fixed stack buffer, no String building
+    char buffer[512];
+    HtmlWriter html(buffer, sizeof(buffer), sendHtmlChunk);
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/html", "");
+    
+    html.print("<!DOCTYPE html><html><head><meta name=\"viewport\" content=\"width=device-width, initial-scale=1\">");
+    html.print("<title>AstroController Rev 1 - System Overview</title>");
+    html.print("<style>body { background: #1a1a1a; color: #ff6b6b; font-family: monospace; margin: 0; padding: 20px; }");
+    html.print(".container { max-width: 800px; margin: 0 auto; } h1, h2 { color: #ff6b6b; }");
+    html.print(".component { background: #2a2a2a; padding: 15px; border-radius: 8px; margin: 15px 0; }");
+    html.print(".status-ok { color: #4CAF50; } .status-warn { color: #FFC107; } .status-err { color: #F44336; }");
+    html.print(".back { color: #ff6b6b; text-decoration: none; }");
+    html.print("</style></head><body><div class=\"container\">");
+    
+    html.print("<h1>AstroController Rev 1 System</h1>");
+    html.print("<a href=\"/\" class=\"back\">← Back to Control</a>");
+    
+    IPAddress ip = WiFi.localIP();
+    html.print("<h2>System Architecture</h2>");
+    html.print("<div class=\"component\">");
+    html.print("<h3>ESP32 D32 Pro (Standalone)</h3>");
+    html.print("<p><strong>Function:</strong> IR sender for camera, session management, web interface</p>");
+    html.print("<p><strong>Hardware:</strong> IR LED on GPIO 4, WiFi, HTTP API</p>");
+    html.print("<p><strong>Status:</strong> <span class=\"status-ok\">Online</span></p>");
+    html.printf("<p><strong>IP:</strong> %u.%u.%u.%u</p>", ip[0], ip[1], ip[2], ip[3]);
+    html.printf("<p><strong>Memory:</strong> %lu KB free</p>", (unsigned long)(ESP.getFreeHeap() / 1024));
+    html.print("</div>");
+    
+    html.print("<h2>Current Session</h2>");
+    html.print("<div class=\"component\">");
+    html.print("<p><strong>Status:</strong> ");
     
     switch(session.state) {
         case STATE_IDLE:
-            html += "<span class=\"status-ok\">Ready</span>";
+            html.print("<span class=\"status-ok\">Ready</span>");
             break;
         case STATE_RUNNING:
-            html += "<span class=\"status-warn\">Running</span>";
+            html.print("<span class=\"status-warn\">Running</span>");
             break;
         case STATE_COMPLETED:
-            html += "<span class=\"status-ok\">Completed</span>";
+            html.print("<span class=\"status-ok\">Completed</span>");
             break;
         default:
-            html += "<span class=\"status-err\">Unknown</span>";
+            html.print("<span class=\"status-err\">Unknown</span>");
     }
     
-    html += "</p>";
-    html += "<p><strong>Photo Interval:</strong> " + String(calculateIntervalMs(1)/1000) + " seconds</p>";
-    html += "<p><strong>Photos Taken:</strong> " + String(session.currentShot) + " / " + String(session.totalShots) + "</p>";
-    html += "<p><strong>Runtime:</strong> " + String((millis() - session.sessionStartTime) / 1000) + " seconds</p>";
-    html += "<p><strong>Temperature:</strong> " + String(session.lastTemperature, 1) + "°C (simulated)</p>";
-    html += "</div>";
+    html.print("</p>");
+    uint32_t intervalMs = session.state == STATE_RUNNING ? session.intervalMs : calculateIntervalMs();
+    html.printf("<p><strong>Photo Interval:</strong> %.1f seconds</p>", intervalMs / 1000.0f);
+    html.printf("<p><strong>Photos Taken:</strong> %u / %u</p>", session.currentShot, session.totalShots);
+    html.printf("<p><strong>Runtime:</strong> %lu seconds</p>", (millis() - session.sessionStartTime) / 1000);
+    char temperature[8];
+    html.printf("<p><strong>Temperature:</strong> %s°C</p>",
+                formatCenti(temperature, sizeof(temperature), temperatureLatestCenti(), "--"));
+    html.print("</div>");
     
-    html += "<h2>Hardware Status</h2>";
-    html += "<div class=\"component\">";
-    html += "<p><strong>IR Sender:</strong> <span class=\"status-ok\">Ready (Sony SIRC 20-bit)</span></p>";
-    html += "<p><strong>WiFi:</strong> <span class=\"status-ok\">Connected</span> (RSSI: " + String(WiFi.RSSI()) + " dBm)</p>";
-    html += "<p><strong>Web Server:</strong> <span class=\"status-ok\">Running on Port 80</span></p>";
+    html.print("<h2>Hardware Status</h2>");
+    html.print("<div class=\"component\">");
+    html.printf("<p><strong>IR Sender:</strong> <span class=\"status-ok\">Ready (%s)</span></p>",
+                IR_PROFILES[status.irProfile].name);
+    html.printf("<p><strong>WiFi:</strong> <span class=\"status-ok\">Connected</span> (RSSI: %d dBm)</p>", WiFi.RSSI());
+    html.print("<p><strong>Web Server:</strong> <span class=\"status-ok\">Running on Port 80</span></p>");
+    
+    TemperatureStatus sensor;
+    temperatureReadStatus(sensor);
+    html.printf("<p><strong>Temperature Sensor:</strong> <span class=\"%s\">%s</span> (%s, %lu readings, %lu dropped)</p>",
+                sensor.valid ? "status-ok" : "status-err", sensor.valid ? "Reading" : "No data",
+                temperatureSensorName(), (unsigned long)sensor.readings, (unsigned long)sensor.dropped);
     
     // Add NTP status
-    if (WiFi.status() == WL_CONNECTED) {
-        if (ntpSynced) {
+    if (networkState() == NET_STATION) {
+        if (networkTimeSynced()) {
             struct tm timeinfo;
             if (getLocalTime(&timeinfo)) {
                 char timeStr[64];
                 strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-                html += "<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span> (" + String(timeStr) + ")</p>";
+                html.printf("<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span> (%s)</p>", timeStr);
             } else {
-                html += "<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span></p>";
+                html.print("<p><strong>NTP Sync:</strong> <span class=\"status-ok\">Synchronized</span></p>");
             }
         } else {
-            html += "<p><strong>NTP Sync:</strong> <span class=\"status-warn\">Not Synchronized</span></p>";
+            html.print("<p><strong>NTP Sync:</strong> <span class=\"status-warn\">Not Synchronized</span></p>");
         }
+    } else if (networkState() == NET_CONNECTING) {
+        html.print("<p><strong>NTP Sync:</strong> <span class=\"status-warn\">Connecting to WiFi</span></p>");
     } else {
-        html += "<p><strong>NTP Sync:</strong> <span class=\"status-warn\">AP Mode - No Internet</span></p>";
+        html.print("<p><strong>NTP Sync:</strong> <span class=\"status-warn\">AP Mode - No Internet</span></p>");
     }
-    html += "</div>";
+    html.printf("<p><strong>Clock Source:</strong> %s</p>", wallClockSourceName());
+    html.print("</div>");
+    
+    html.print("<h2>Usage</h2>");
+    html.print("<div class=\"component\">");
+    html.print("<p><strong>1. Start Session:</strong> Enter time → Start Session</p>");
+    html.print("<p><strong>2. Single Shot:</strong> Single Shot button</p>");
+    html.print("<p><strong>3. Automated:</strong> ESP32 handles timing automatically</p>");
+    html.print("<p><strong>4. Network:</strong> Web interface via WiFi</p>");
+    html.print("</div>");
+    
+    html.print("<p style=\"text-align: center; margin-top: 30px; color: #666;\">");
+    html.printf("AstroController Rev 1 | ESP32 Standalone | Uptime: %lus", millis() / 1000);
+    html.print("</p>");
     
-    html += "<h2>Usage</h2>";
-    html += "<div class=\"component\">";
-    html += "<p><strong>1. Start Session:</strong> Enter time → Start Session</p>";
-    html += "<p><strong>2. Single Shot:</strong> Single Shot button</p>";
-    html += "<p><strong>3. Automated:</strong> ESP32 handles timing automatically</p>";
-    html += "<p><strong>4. Network:</strong> Web interface via WiFi</p>";
-    html += "</div>";
+    html.print("</div></body></html>");
     
-    html += "<p style=\"text-align: center; margin-top: 30px; color: #666;\">";
-    html += "AstroController Rev 1 | ESP32 Standalone | Uptime: " + String(millis() / 1000) + "s";
-    html += "</p>";
+    finishHtml(html);
+}
+
+void handleMetrics() {
+    noteRequest();
     
-    html += "</div></body></html>";
+#ifdef ENABLE_METRICS
+    METRIC_TIME_SCOPE(METRIC_HTTP_METRICS);
     
-    server.send(200, "text/html", html);
-}
\ No newline at end of file
+    // Prometheus text exposition, streamed like /system
+    char buffer[512];
+    HtmlWriter out(buffer, sizeof(buffer), sendHtmlChunk);
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4", "");
+    metricsWritePrometheus(out);
+    
+    out.print("# HELP astro_boot_milliseconds Milliseconds after reset until each boot stage, 0 = not yet\n");
+    out.print("# TYPE astro_boot_milliseconds gauge\n");
+    out.printf("astro_boot_milliseconds{stage=\"web_ready\"} %lu\n", (unsigned long)bootTiming.webReadyMs);
+    out.printf("astro_boot_milliseconds{stage=\"first_request\"} %lu\n", (unsigned long)bootTiming.firstRequestMs);
+    out.printf("astro_boot_milliseconds{stage=\"network_ready\"} %lu\n", (unsigned long)bootTiming.networkReadyMs);
+    out.printf("astro_boot_milliseconds{stage=\"time_sync\"} %lu\n", (unsigned long)bootTiming.timeSyncMs);
+    
+    out.print("# HELP astro_request_arena_high_water_bytes Most request arena memory used by one request\n");
+    out.print("# TYPE astro_request_arena_high_water_bytes gauge\n");
+    out.printf("astro_request_arena_high_water_bytes %lu\n", (unsigned long)requestArenaHighWater());
+    out.print("# TYPE astro_request_arena_failures_total counter\n");
+    out.printf("astro_request_arena_failures_total %lu\n", (unsigned long)requestArenaFailures());
+    finishHtml(out);
+#else
+    sendJsonText(404, "{\"error\":\"Metrics disabled at compile time\"}");
+#endif
+}
+
+// Streams shot telemetry as CSV or packed 32 byte records (?format=bin).
+// ?from= and ?to= select a sequence range, `to` exclusive; both default to
+// everything still held in the ring.
+void handleShots() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SHOTS);
+    noteRequest();
+    
+    uint32_t first;
+    uint32_t next;
+    shotLogRange(first, next);
+    
+    uint32_t from = queryNumber("from", first);
+    uint32_t to = queryNumber("to", next);
+    if (from < first) from = first;
+    if (to > next) to = next;
+    if (to < from) to = from;
+    bool binary = server.arg("format") == "bin";     // A String copy, see queryNumber()
+    
+    // Lets clients page through the ring and notice overwritten ranges
+    char value[12];
+    snprintf(value, sizeof(value), "%lu", (unsigned long)first);
+    server.sendHeader("X-Shots-First", value);
+    snprintf(value, sizeof(value), "%lu", (unsigned long)next);
+    server.sendHeader("X-Shots-Next", value);
+    
+    char buffer[1024];
+    HtmlWriter out(buffer, sizeof(buffer), sendHtmlChunk);
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, binary ? "application/octet-stream" : "text/csv", "");
+    
+    if (!binary) {
+        out.print("sequence,kind,index,job,scheduled_ms,actual_ms,late_ms,epoch_ms,temperature_c,free_heap\n");
+    }
+    
+    ShotRecord record;
+    for (uint32_t sequence = from; sequence < to; sequence++) {
+        // Overwritten while streaming: skip rather than send a torn record
+        if (!shotLogRead(sequence, record)) continue;
+        
+        if (binary) {
+            out.write((const char*)&record, sizeof(record));
+        } else {
+            char temperature[8];
+            out.printf("%lu,%s,%u,%u,%lu,%lu,%ld,%lld,%s,%lu\n",
+                       (unsigned long)record.sequence,
+                       record.kind == SHOT_JOB ? "job" : "session",
+                       record.index, record.jobId,
+                       (unsigned long)record.scheduledMs, (unsigned long)record.actualMs,
+                       (long)(int32_t)(record.actualMs - record.scheduledMs),
+                       (long long)record.epochMs,
+                       formatCenti(temperature, sizeof(temperature), record.temperatureCenti, ""),
+                       (unsigned long)record.freeHeap);
+        }
+    }
+    finishHtml(out);
+}
+
+// Streams the per-minute temperature history as CSV, oldest first.
+// ?from= and ?to= select a minute sequence range like /api/shots.
+void handleTemperature() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_TEMPERATURE);
+    noteRequest();
+    
+    uint32_t first;
+    uint32_t next;
+    temperatureHistoryRange(first, next);
+    
+    uint32_t from = queryNumber("from", first);
+    uint32_t to = queryNumber("to", next);
+    if (from < first) from = first;
+    if (to > next) to = next;
+    if (to < from) to = from;
+    
+    char value[12];
+    snprintf(value, sizeof(value), "%lu", (unsigned long)first);
+    server.sendHeader("X-Minutes-First", value);
+    snprintf(value, sizeof(value), "%lu", (unsigned long)next);
+    server.sendHeader("X-Minutes-Next", value);
+    server.sendHeader("X-Temperature-Sensor", temperatureSensorName());
+    
+    char buffer[1024];
+    HtmlWriter out(buffer, sizeof(buffer), sendHtmlChunk);
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/csv", "");
+    out.print("sequence,start_ms,epoch_ms,mean_c,min_c,max_c,readings\n");
+    
+    // Minutes are stamped in millis(), the wall clock is mapped back from now
+    uint32_t now = millis();
+    int64_t epochNow = wallClockSource() != CLOCK_NONE ? wallClockEpochMs() : 0;
+    
+    TemperatureMinute minute;
+    for (uint32_t sequence = from; sequence < to; sequence++) {
+        if (!temperatureHistoryRead(sequence, minute)) continue;
+        
+        char mean[8];
+        char low[8];
+        char high[8];
+        out.printf("%lu,%lu,%lld,%s,%s,%s,%u\n", (unsigned long)sequence, (unsigned long)minute.startMs,
+                   (long long)(epochNow != 0 ? epochNow - (now - minute.startMs) : 0),
+                   formatCenti(mean, sizeof(mean), minute.meanCenti, ""),
+                   formatCenti(low, sizeof(low), minute.minCenti, ""),
+                   formatCenti(high, sizeof(high), minute.maxCenti, ""),
+                   minute.readings);
+    }
+    finishHtml(out);
+}
+
+void handleIrProfiles() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_IR);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_PROFILES_CAPACITY);
+    doc["active"] = IR_PROFILES[status.irProfile].key;
+    JsonArray profiles = doc.createNestedArray("profiles");
+    for (uint8_t i = 0; i < IR_PROFILE_COUNT; i++) {
+        JsonObject profile = profiles.createNestedObject();
+        profile["key"] = IR_PROFILES[i].key;
+        profile["name"] = IR_PROFILES[i].name;
+        profile["carrier_khz"] = IR_PROFILES[i].train->carrierKhz;
+        profile["duration_us"] = irTrainDurationUs(*IR_PROFILES[i].train);
+    }
+    
+    sendJson(200, doc);
+}
+
+// {"profile": "canon"}; takes effect before the next shot
+void handleSetIrProfile() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_IR);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_SMALL_CAPACITY);
+    if (!parseRequestBody(doc)) return;
+    
+    IrProfileId profile;
+    if (!irProfileFind(doc["profile"] | "", profile)) {
+        sendJsonText(400, "{\"error\":\"Unknown IR profile\"}");
+        return;
+    }
+    
+    ControlCommand command;
+    command.type = CMD_SET_IR_PROFILE;
+    command.irProfile = profile;
+    if (!rtSubmit(command)) {
+        sendJsonText(503, "{\"error\":\"Command queue full\"}");
+        return;
+    }
+    
+    Preferences prefs;
+    if (prefs.begin("ir", false)) {
+        prefs.putString("profile", IR_PROFILES[profile].key);
+        prefs.end();
+    }
+    sendJsonText(200, "{\"success\":true}");
+}
+
+// Light sleep statistics; the current is estimated from the measured time asleep
+void handlePower() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_POWER);
+    noteRequest();
+    
+    IdleSleepStats stats;
+    rtReadIdleSleepStats(stats);
+    uint64_t elapsedUs = esp_timer_get_time() - stats.sinceUs;
+    
+    ArenaJsonDocument doc(JSON_POWER_CAPACITY);
+    doc["light_sleep"] = rtIdleSleepEnabled();
+    doc["sleeps"] = stats.sleeps;
+    doc["slept_ms"] = stats.sleptUs / 1000;
+    doc["elapsed_ms"] = elapsedUs / 1000;
+    doc["wake_latency_us"] = stats.wakeLatencyUs;
+    doc["wake_latency_max_us"] = stats.wakeLatencyMaxUs;
+    doc["wake_margin_us"] = stats.marginUs;
+    doc["late_wakeups"] = stats.lateWakeups;
+    doc["avg_current_ma"] = idleSleepAverageCurrentUa(stats, elapsedUs) / 1000.0;
+    
+    sendJson(200, doc);
+}
+
+// {"light_sleep": true}; only sleeps while a session runs and the web side is quiet
+void handleSetPower() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_POWER);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_SMALL_CAPACITY);
+    if (!parseRequestBody(doc)) return;
+    
+    if (!doc["light_sleep"].is<bool>()) {
+        sendJsonText(400, "{\"error\":\"light_sleep must be true or false\"}");
+        return;
+    }
+    bool enabled = doc["light_sleep"];
+    if (rtSetIdleSleep(enabled) != enabled) {
+        sendJsonText(501, "{\"error\":\"Light sleep needs the esp32-field build\"}");
+        return;
+    }
+    
+    Preferences prefs;
+    if (prefs.begin("power", false)) {
+        prefs.putBool("sleep", enabled);
+        prefs.end();
+    }
+    sendJsonText(200, "{\"success\":true}");
+}
+
+// Leader/follower mode chosen through /api/sync, kept in NVS
+SyncMode loadSyncSetting() {
+    SyncMode mode = SYNC_OFF;
+    Preferences prefs;
+    if (prefs.begin("sync", true)) {
+        uint8_t stored = prefs.getUChar("mode", SYNC_OFF);
+        prefs.end();
+        if (stored <= SYNC_FOLLOWER) mode = (SyncMode)stored;
+    }
+    return mode;
+}
+
+// Follower: clock estimate against the leader. Leader: the estimate and
+// sync error each follower last reported.
+void handleSync() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SYNC);
+    noteRequest();
+    
+    SyncStatus sync;
+    syncReadStatus(sync);
+    
+    ArenaJsonDocument doc(JSON_SYNC_CAPACITY);
+    doc["mode"] = syncModeName(sync.mode);
+    doc["node"] = sync.nodeId;
+    doc["link"] = sync.linkUp;
+    
+    if (sync.mode == SYNC_FOLLOWER) {
+        doc["leader"] = sync.clock.leaderId;
+        doc["locked"] = sync.locked;
+        doc["following"] = sync.following;
+        doc["offset_ms"] = sync.clock.offsetUs / 1000.0;
+        doc["jitter_us"] = sync.clock.jitterUs;
+        doc["skew_ppm"] = sync.clock.skewPpb / 1000.0;
+        doc["samples"] = sync.clock.count;
+        doc["resets"] = sync.clock.resets;
+        doc["beacons"] = sync.beaconsReceived;
+        doc["beacon_age_ms"] = sync.beaconAgeMs;
+    } else if (sync.mode == SYNC_LEADER) {
+        doc["beacons"] = sync.beaconsSent;
+        JsonArray list = doc.createNestedArray("followers");
+        const SyncFollower* followers = syncFollowers();
+        uint32_t now = millis();
+        for (uint8_t i = 0; i < SYNC_MAX_FOLLOWERS; i++) {
+            if (followers[i].nodeId == 0) continue;
+            JsonObject follower = list.createNestedObject();
+            follower["node"] = followers[i].nodeId;
+            follower["offset_ms"] = followers[i].offsetUs / 1000.0;
+            follower["jitter_us"] = followers[i].jitterUs;
+            follower["skew_ppm"] = followers[i].skewPpb / 1000.0;
+            follower["samples"] = followers[i].samples;
+            follower["following"] = followers[i].following;
+            follower["shot"] = followers[i].currentShot;
+            follower["age_ms"] = now - followers[i].lastSeenMs;
+        }
+    }
+    
+    sendJson(200, doc);
+}
+
+// {"mode": "leader" | "follower" | "off"}
+void handleSetSync() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SYNC);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_SMALL_CAPACITY);
+    if (!parseRequestBody(doc)) return;
+    
+    SyncMode mode;
+    if (!syncModeFind(doc["mode"] | "", mode)) {
+        sendJsonText(400, "{\"error\":\"Mode must be leader, follower or off\"}");
+        return;
+    }
+    syncSetMode(mode);
+    
+    Preferences prefs;
+    if (prefs.begin("sync", false)) {
+        prefs.putUChar("mode", mode);
+        prefs.end();
+    }
+    sendJsonText(200, "{\"success\":true}");
+}
+
+// Pending wall-clock entries, earliest first, and the scheduler counters
+void handleSchedule() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SCHEDULE);
+    noteRequest();
+    
+    ScheduleStats stats;
+    scheduleReadStats(stats);
+    uint16_t order[SCHEDULE_CAPACITY];
+    uint16_t count = scheduleList(order, SCHEDULE_CAPACITY);
+    int64_t nowMs = wallClockEpochMs();
+    
+    char buffer[1024];
+    HtmlWriter out(buffer, sizeof(buffer), sendHtmlChunk);
+    
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    
+    out.printf("{\"clock\":\"%s\",\"now\":%lld,\"pending\":%u,\"fired\":%lu,\"missed\":%lu,\"skipped\":%lu,"
+               "\"steps\":%lu,\"last_step_ms\":%lld,\"cascaded\":%lu,\"entries\":[",
+               wallClockSourceName(), (long long)(nowMs / 1000), stats.pending,
+               (unsigned long)stats.fired, (unsigned long)stats.missed, (unsigned long)stats.skipped,
+               (unsigned long)stats.steps, (long long)stats.lastStepMs, (unsigned long)stats.cascaded);
+    
+    for (uint16_t i = 0; i < count; i++) {
+        const ScheduleEntry& entry = scheduleEntry(order[i]);
+        time_t seconds = entry.epochMs / 1000;
+        struct tm local;
+        localtime_r(&seconds, &local);
+        char text[24];
+        strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &local);
+        
+        out.printf("%s{\"id\":%lu,\"action\":\"%s\",\"time\":%lld,\"local\":\"%s\",\"in_s\":%lld",
+                   i > 0 ? "," : "", (unsigned long)entry.id, scheduleActionName(entry.type),
+                   (long long)seconds, text, (long long)((entry.epochMs - nowMs) / 1000));
+        if (entry.type == CMD_SHOT_JOB) {
+            out.printf(",\"count\":%u,\"spacing\":%lu", entry.count, (unsigned long)entry.spacingMs);
+        }
+        out.print("}");
+    }
+    out.print("]}\n");
+    finishHtml(out);
+}
+
+// {"action": "start", "time": T, "stop": T, "minutes": N | "phases": [...]},
+// {"action": "stop", "time": T} or {"action": "shot", "time": T, "count": N, "spacing": ms}.
+// A start's time is that of its first shot, "stop" optionally queues the
+// matching stop. Times as in parseScheduleTime.
+void handleAddSchedule() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SCHEDULE);
+    noteRequest();
+    
+    ArenaJsonDocument doc(JSON_SCHEDULE_CAPACITY);
+    if (!parseRequestBody(doc)) return;
+    JsonObject body = doc.as<JsonObject>();
+    
+    ControlCommand command;
+    const char* action = body["action"] | "start";
+    int64_t epochMs = 0;
+    int64_t stopEpochMs = 0;
+    const char* error = nullptr;
+    
+    if (!parseScheduleTime(body["time"], wallClockEpochMs(), epochMs)) {
+        error = "Missing or invalid time";
+    } else if (strcmp(action, "start") == 0) {
+        command.type = CMD_START_SESSION;
+        error = parseSessionPlan(body, command.plan, epochMs - SESSION_START_DELAY_MS);
+        SequenceSummary summary;
+        if (error == nullptr) {
+            SequenceError result = sequenceCompile(command.plan, SESSION_START_DELAY_MS, nullptr, 0, summary);
+            if (result != SEQUENCE_OK) error = sequenceErrorText(result);
+        }
+        if (error == nullptr && !body["stop"].isNull() &&
+            !parseScheduleTime(body["stop"], epochMs, stopEpochMs)) {
+            error = "Invalid stop time";
+        }
+        if (error == nullptr && stopEpochMs != 0 && stopEpochMs <= epochMs) error = "Stop must be after the start";
+    } else if (strcmp(action, "stop") == 0) {
+        command.type = CMD_STOP_SESSION;
+    } else if (strcmp(action, "shot") == 0) {
+        command.type = CMD_SHOT_JOB;
+        command.count = body["count"] | 1;
+        command.spacingMs = body["spacing"] | DEFAULT_BURST_SPACING_MS;
+        if (command.count < 1 || command.count > MAX_BURST_COUNT ||
+            command.spacingMs < MIN_BURST_SPACING_MS || command.spacingMs > MAX_BURST_SPACING_MS) {
+            error = "Invalid burst parameters";
+        }
+    } else {
+        error = "Action must be start, stop or shot";
+    }
+    
+    uint32_t id = 0;
+    uint32_t stopId = 0;
+    if (error == nullptr) error = scheduleAdd(command, epochMs, id);
+    if (error == nullptr && stopEpochMs != 0) {
+        ControlCommand stop;
+        stop.type = CMD_STOP_SESSION;
+        error = scheduleAdd(stop, stopEpochMs, stopId);
+        if (error != nullptr) scheduleCancel(id);
+    }
+    if (error != nullptr) {
+        char response[128];
+        snprintf(response, sizeof(response), "{\"error\":\"%s\"}", error);
+        sendJsonText(400, response);
+        return;
+    }
+    
+    Serial.printf("Scheduled %s %lu in %lld s\n", action, (unsigned long)id,
+                  (long long)((epochMs - wallClockEpochMs()) / 1000));
+    
+    char response[96];
+    if (stopId != 0) {
+        snprintf(response, sizeof(response), "{\"success\":true,\"id\":%lu,\"stop_id\":%lu,\"time\":%lld}",
+                 (unsigned long)id, (unsigned long)stopId, (long long)(epochMs / 1000));
+    } else {
+        snprintf(response, sizeof(response), "{\"success\":true,\"id\":%lu,\"time\":%lld}",
+                 (unsigned long)id, (long long)(epochMs / 1000));
+    }
+    sendJsonText(200, response);
+}
+
+// ?id=N
+void handleCancelSchedule() {
+    METRIC_TIME_SCOPE(METRIC_HTTP_SCHEDULE);
+    noteRequest();
+    
+    uint32_t id = queryNumber("id", 0);
+    if (!scheduleCancel(id)) {
+        sendJsonText(404, "{\"error\":\"No such entry\"}");
+        return;
+    }
+    sendJsonText(200, "{\"success\":true}");
+}
+
+// Unix seconds, or a local time string for scheduleParseTime: "21:43" is
+// the next 21:43 after `afterEpochMs`
+bool parseScheduleTime(JsonVariant value, int64_t afterEpochMs, int64_t& epochMs) {
+    if (value.is<const char*>()) return scheduleParseTime(value.as<const char*>(), afterEpochMs, epochMs);
+    
+    double seconds = value | 0.0;
+    if (seconds <= 0) return false;
+    epochMs = (int64_t)(seconds * 1000 + 0.5);
+    return true;
+}
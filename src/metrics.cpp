@@ -0,0 +1,115 @@
+#include "metrics.h"
+
+#ifdef ENABLE_METRICS
+
+#include <atomic>
+#include "html_writer.h"
+
+// Bucket i holds durations below 2^i us; the last bucket is +Inf
+static const uint8_t METRIC_BUCKETS = 22;
+
+struct MetricHistogram {
+    std::atomic<uint32_t> buckets[METRIC_BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sumUsLow;     // 64 bit sum split in two words, no 64 bit atomics on Xtensa
+    std::atomic<uint32_t> sumUsHigh;
+};
+
+static MetricHistogram histograms[METRIC_TIMER_COUNT];
+static std::atomic<uint32_t> counters[METRIC_COUNTER_COUNT];
+
+static const char* const TIMER_NAMES[METRIC_TIMER_COUNT] = {
+    "handle_client",
+    "http_root",
+    "http_status",
+    "http_events",
+    "http_start",
+    "http_stop",
+    "http_shot",
+    "http_burst",
+    "http_system",
+    "http_metrics",
+    "http_shots",
+    "http_ir",
+    "http_power",
+    "http_sync",
+    "http_temperature",
+    "http_schedule",
+    "http_trigger",
+    "trigger_frame",
+    "session_poll",
+    "ir_send",
+};
+
+void metricsRecordUs(MetricTimer timer, uint32_t us) {
+    MetricHistogram& h = histograms[timer];
+    
+    // Smallest i with us < 2^i
+    uint8_t bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+    if (bucket >= METRIC_BUCKETS) bucket = METRIC_BUCKETS - 1;
+    
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    uint32_t low = h.sumUsLow.fetch_add(us, std::memory_order_relaxed);
+    if (low + us < low) h.sumUsHigh.fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metricsCount(MetricCounter counter) {
+    counters[counter].fetch_add(1, std::memory_order_relaxed);
+}
+
+static uint64_t readSumUs(const MetricHistogram& h) {
+    uint32_t high;
+    uint32_t low;
+    do {
+        high = h.sumUsHigh.load(std::memory_order_relaxed);
+        low = h.sumUsLow.load(std::memory_order_relaxed);
+    } while (high != h.sumUsHigh.load(std::memory_order_relaxed));
+    return ((uint64_t)high << 32) | low;
+}
+
+void metricsWritePrometheus(HtmlWriter& out) {
+    out.print("# HELP astro_section_duration_seconds Time spent in instrumented hot-path sections\n");
+    out.print("# TYPE astro_section_duration_seconds histogram\n");
+    
+    uint32_t requests = 0;
+    for (uint8_t t = 0; t < METRIC_TIMER_COUNT; t++) {
+        const MetricHistogram& h = histograms[t];
+        uint32_t cumulative = 0;
+        
+        for (uint8_t b = 0; b < METRIC_BUCKETS - 1; b++) {
+            cumulative += h.buckets[b].load(std::memory_order_relaxed);
+            out.printf("astro_section_duration_seconds_bucket{section=\"%s\",le=\"%g\"} %lu\n",
+                       TIMER_NAMES[t], (double)(1UL << b) / 1e6, (unsigned long)cumulative);
+        }
+        cumulative += h.buckets[METRIC_BUCKETS - 1].load(std::memory_order_relaxed);
+        out.printf("astro_section_duration_seconds_bucket{section=\"%s\",le=\"+Inf\"} %lu\n",
+                   TIMER_NAMES[t], (unsigned long)cumulative);
+        out.printf("astro_section_duration_seconds_sum{section=\"%s\"} %.6f\n",
+                   TIMER_NAMES[t], readSumUs(h) / 1e6);
+        out.printf("astro_section_duration_seconds_count{section=\"%s\"} %lu\n",
+                   TIMER_NAMES[t], (unsigned long)cumulative);
+        
+        if (t >= METRIC_HTTP_ROOT && t <= METRIC_HTTP_TRIGGER) requests += cumulative;
+    }
+    
+    out.print("# TYPE astro_http_requests_total counter\n");
+    out.printf("astro_http_requests_total %lu\n", (unsigned long)requests);
+    out.print("# TYPE astro_shots_sent_total counter\n");
+    out.printf("astro_shots_sent_total %lu\n", (unsigned long)counters[METRIC_SHOTS_SENT].load(std::memory_order_relaxed));
+    out.print("# TYPE astro_shots_late_total counter\n");
+    out.printf("astro_shots_late_total %lu\n", (unsigned long)counters[METRIC_SHOTS_LATE].load(std::memory_order_relaxed));
+    out.print("# TYPE astro_ir_busy_total counter\n");
+    out.printf("astro_ir_busy_total %lu\n", (unsigned long)counters[METRIC_IR_BUSY].load(std::memory_order_relaxed));
+    out.print("# TYPE astro_html_truncated_total counter\n");
+    out.printf("astro_html_truncated_total %lu\n", (unsigned long)counters[METRIC_HTML_TRUNCATED].load(std::memory_order_relaxed));
+    
+    out.print("# TYPE astro_heap_free_bytes gauge\n");
+    out.printf("astro_heap_free_bytes %lu\n", (unsigned long)ESP.getFreeHeap());
+    out.print("# TYPE astro_heap_min_free_bytes gauge\n");
+    out.printf("astro_heap_min_free_bytes %lu\n", (unsigned long)ESP.getMinFreeHeap());
+    out.print("# TYPE astro_heap_largest_free_block_bytes gauge\n");
+    out.printf("astro_heap_largest_free_block_bytes %lu\n", (unsigned long)ESP.getMaxAllocHeap());
+}
+
+#endif // ENABLE_METRICS
@@ -0,0 +1,155 @@
+#include "network_manager.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <atomic>
+#include "esp_sntp.h"
+#include "config.h"
+#include "wall_clock.h"
+
+// Include WiFi credentials (copy secrets_template.h to secrets.h and configure)
+#include "secrets.h"
+
+// WiFi Configuration from secrets.h
+static const char* WIFI_SSID_CONFIG = WIFI_SSID;
+static const char* WIFI_PASSWORD_CONFIG = WIFI_PASSWORD;
+static const char* AP_SSID_CONFIG = AP_SSID;
+static const char* AP_PASSWORD_CONFIG = AP_PASSWORD;
+
+// NTP Configuration
+static const char* ntpServer = "pool.ntp.org";
+
+BootTiming bootTiming;
+
+static NetworkState state = NET_CONNECTING;
+static unsigned long connectStart = 0;
+static bool timeSynced = false;
+
+// Set from the WiFi event and SNTP callbacks, consumed by networkUpdate()
+static std::atomic<bool> gotIp{false};
+static std::atomic<bool> lostConnection{false};
+static std::atomic<bool> ntpEvent{false};
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        gotIp = true;
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        lostConnection = true;
+    }
+}
+
+static void syncTimeCallback(struct timeval *tv) {
+    ntpEvent = true;
+}
+
+static void startNTP() {
+    Serial.println("Setting up NTP client...");
+    
+    // Set time sync notification callback
+    sntp_set_time_sync_notification_cb(syncTimeCallback);
+    
+    // Configure SNTP, sync completes in the background
+    esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
+    esp_sntp_setservername(0, ntpServer);
+    esp_sntp_set_sync_mode(SNTP_SYNC_MODE_IMMED);
+    esp_sntp_init();
+    
+    Serial.printf("NTP server: %s\n", ntpServer);
+}
+
+static void startAccessPoint() {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_AP);
+    
+    IPAddress local_IP(192, 168, 4, 1);
+    IPAddress gateway(192, 168, 4, 1);
+    IPAddress subnet(255, 255, 255, 0);
+    WiFi.softAPConfig(local_IP, gateway, subnet);
+    
+    if (WiFi.softAP(AP_SSID_CONFIG, AP_PASSWORD_CONFIG)) {
+        Serial.printf("Access Point '%s' started successfully\n", AP_SSID_CONFIG);
+        Serial.print("AP IP Address: ");
+        Serial.println(WiFi.softAPIP());
+        Serial.printf("AP Password: %s\n", AP_PASSWORD_CONFIG);
+        Serial.println("Connect to AstroController WiFi and go to http://192.168.4.1");
+    } else {
+        Serial.println("Failed to start Access Point!");
+    }
+}
+
+void networkBegin() {
+    Serial.printf("Connecting to WiFi: %s\n", WIFI_SSID_CONFIG);
+    
+    WiFi.onEvent(onWiFiEvent);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(true);
+    // Modem sleep keeps the association through idle light sleep (idle_sleep.h)
+    WiFi.setSleep(true);
+    WiFi.begin(WIFI_SSID_CONFIG, WIFI_PASSWORD_CONFIG);
+    
+    state = NET_CONNECTING;
+    connectStart = millis();
+}
+
+void networkUpdate() {
+    switch (state) {
+        case NET_CONNECTING:
+            if (gotIp.exchange(false)) {
+                state = NET_STATION;
+                lostConnection = false;
+                bootTiming.networkReadyMs = millis();
+                Serial.println("WiFi connected successfully!");
+                Serial.print("IP Address: ");
+                Serial.println(WiFi.localIP());
+                Serial.printf("Signal strength: %d dBm\n", WiFi.RSSI());
+                
+                // Setup NTP client if connected to internet
+                startNTP();
+            } else if (millis() - connectStart >= WIFI_TIMEOUT) {
+                Serial.printf("WiFi connection failed. Status: %d\n", WiFi.status());
+                Serial.println("Failed to connect to local WiFi, starting Access Point...");
+                startAccessPoint();
+                state = NET_ACCESS_POINT;
+                bootTiming.networkReadyMs = millis();
+            }
+            break;
+            
+        case NET_STATION:
+            // The WiFi driver reconnects on its own, just report it
+            if (lostConnection.exchange(false)) {
+                Serial.println("WiFi connection lost, reconnecting...");
+            }
+            if (gotIp.exchange(false)) {
+                Serial.print("WiFi reconnected. IP Address: ");
+                Serial.println(WiFi.localIP());
+            }
+            break;
+            
+        case NET_ACCESS_POINT:
+            break;
+    }
+    
+    if (ntpEvent.exchange(false)) {
+        if (!timeSynced) bootTiming.timeSyncMs = millis();
+        timeSynced = true;
+        wallClockSynced();
+        Serial.println("NTP time synchronized successfully!");
+        
+        struct tm timeinfo;
+        if (getLocalTime(&timeinfo, 0)) {
+            Serial.printf("Current time: %04d-%02d-%02d %02d:%02d:%02d\n",
+                         timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                         timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+        }
+    }
+    
+    wallClockMaintain();
+}
+
+NetworkState networkState() {
+    return state;
+}
+
+bool networkTimeSynced() {
+    return timeSynced;
+}
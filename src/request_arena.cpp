@@ -0,0 +1,42 @@
+#include "request_arena.h"
+
+#include <string.h>
+
+alignas(8) static uint8_t arena[REQUEST_ARENA_SIZE];
+static size_t arenaUsed = 0;
+static size_t arenaHighWater = 0;
+static uint32_t arenaFailures = 0;
+
+void* requestArenaAllocate(size_t size) {
+    size_t aligned = (size + 3) & ~(size_t)3;
+    if (aligned > REQUEST_ARENA_SIZE - arenaUsed) {
+        arenaFailures++;
+        return nullptr;
+    }
+    
+    void* block = arena + arenaUsed;
+    arenaUsed += aligned;
+    if (arenaUsed > arenaHighWater) arenaHighWater = arenaUsed;
+    return block;
+}
+
+void requestArenaReset() {
+    arenaUsed = 0;
+}
+
+char* requestArenaCopy(const char* data, size_t len) {
+    char* copy = (char*)requestArenaAllocate(len + 1);
+    if (copy == nullptr) return nullptr;
+    
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+size_t requestArenaHighWater() {
+    return arenaHighWater;
+}
+
+uint32_t requestArenaFailures() {
+    return arenaFailures;
+}
@@ -0,0 +1,213 @@
+#include "rt_task.h"
+
+#include <Arduino.h>
+#include <esp_freertos_hooks.h>
+#include <esp_pm.h>
+#include <esp_timer.h>
+#include "ir_transmitter.h"
+#include "metrics.h"
+#include "seqlock.h"
+#include "spsc_ring.h"
+
+static SpscRing<ControlCommand, RT_COMMAND_QUEUE_SIZE> commandRing;
+static SeqLock<StatusSnapshot> statusLock;
+static StatusSnapshot rtSnapshot;
+static TaskHandle_t rtTaskHandle = nullptr;
+
+// Idle light sleep; the statistics and the lock are handled by the shot task only
+static std::atomic<bool> idleSleepEnabled{false};
+static std::atomic<bool> sleepPermitted{false};
+static std::atomic<uint32_t> awakeUntil{0};
+static IdleSleepStats sleepStats;
+static SeqLock<IdleSleepStats> sleepStatsLock;
+static bool sleepWasEnabled = false;
+static esp_pm_lock_handle_t awakeLock = nullptr;
+static bool awakeLockHeld = false;
+
+// Tick interrupts taken on core 0; tickless idle steps the tick count over
+// a light sleep without them (idle_sleep.h)
+static volatile uint32_t tickInterrupts = 0;
+
+static void IRAM_ATTR countTickInterrupt() {
+    tickInterrupts++;
+}
+
+static void publishStatus() {
+    sessionFillSnapshot(rtSnapshot);
+    statusLock.write(rtSnapshot);
+}
+
+static bool idleSleepAllowed(uint32_t now) {
+    bool enabled = idleSleepEnabled.load(std::memory_order_relaxed);
+    if (enabled != sleepWasEnabled) {
+        // Fresh statistics every time it is switched on
+        sleepWasEnabled = enabled;
+        sleepStats = IdleSleepStats();
+        sleepStats.sinceUs = esp_timer_get_time();
+        sleepStatsLock.write(sleepStats);
+    }
+    if (!enabled || rtSnapshot.session.state != STATE_RUNNING) return false;
+    // Light sleep stops the RMT clock mid-frame
+    if (!commandRing.empty() || irTransmitterBusy()) return false;
+    return timeReached(now, awakeUntil.load(std::memory_order_relaxed));
+}
+
+// The power management lock keeps automatic light sleep out whenever the
+// shot task or the web side needs the chip awake
+static void holdAwakeLock(bool hold) {
+    sleepPermitted.store(!hold, std::memory_order_relaxed);
+    if (hold == awakeLockHeld || awakeLock == nullptr) return;
+    
+    if (hold) {
+        esp_pm_lock_acquire(awakeLock);
+    } else {
+        esp_pm_lock_release(awakeLock);
+    }
+    awakeLockHeld = hold;
+}
+
+// Blocks until shortly before the next event while the idle task may
+// light-sleep; false if it was too close. The tick count is corrected
+// after each sleep, so the wait measures the wakeup latency.
+static bool idleWait(uint32_t untilEventMs) {
+    uint32_t sleepUs = idleSleepPlanUs(sleepStats, untilEventMs);
+    if (sleepUs == 0) return false;
+    
+    holdAwakeLock(false);
+    int64_t before = esp_timer_get_time();
+    TickType_t ticksBefore = xTaskGetTickCount();
+    uint32_t interruptsBefore = tickInterrupts;
+    bool woken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepUs / 1000)) != 0;
+    uint32_t ticks = xTaskGetTickCount() - ticksBefore;
+    uint32_t interrupts = tickInterrupts - interruptsBefore;
+    uint32_t actualUs = esp_timer_get_time() - before;
+    holdAwakeLock(true);
+    
+    // A command or a hold-awake cut the wait short, it says nothing about latency
+    if (!woken) idleSleepRecord(sleepStats, sleepUs / 1000 * 1000, actualUs, untilEventMs);
+    if (ticks > interrupts) idleSleepAddAsleep(sleepStats, (ticks - interrupts) * portTICK_PERIOD_MS * 1000);
+    sleepStatsLock.write(sleepStats);
+    return true;
+}
+
+static void rtTask(void* parameter) {
+    holdAwakeLock(true);
+    publishStatus();
+    
+    for (;;) {
+        bool changed = false;
+        
+        ControlCommand command;
+        while (commandRing.pop(command)) {
+            sessionApplyCommand(command, millis());
+            changed = true;
+        }
+        
+        {
+            METRIC_TIME_SCOPE(METRIC_SESSION_POLL);
+            changed |= sessionPoll(millis());
+        }
+        if (changed) publishStatus();
+        
+        uint32_t now = millis();
+        uint32_t wait = sessionTimeToNextEvent(now, IDLE_SLEEP_MAX_MS);
+        if (wait >= IDLE_SLEEP_MIN_MS && idleSleepAllowed(now) && idleWait(wait)) continue;
+        if (wait > RT_MAX_SLEEP_MS) wait = RT_MAX_SLEEP_MS;
+        // Catch the end of a frame so the chip can sleep right after it
+        if (wait > RT_IR_POLL_MS && sleepWasEnabled && irTransmitterBusy()) wait = RT_IR_POLL_MS;
+        
+        if (wait > 1) {
+            // Sleep until one tick before the deadline or until a command arrives
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait - 1));
+        } else if (wait == 1) {
+            // Tick granularity is too coarse for the last millisecond, spin
+            uint32_t target = millis() + 1;
+            while ((int32_t)(millis() - target) < 0) {
+            }
+        } else if (!changed) {
+            // Due but blocked (IR busy or yielding to a session shot)
+            vTaskDelay(1);
+        }
+    }
+}
+
+bool rtTaskStart() {
+    // Fails without CONFIG_PM_ENABLE; light sleep cannot be enabled then either
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "rt_awake", &awakeLock) != ESP_OK) awakeLock = nullptr;
+    esp_register_freertos_tick_hook_for_cpu(countTickInterrupt, 0);
+    
+    BaseType_t result = xTaskCreatePinnedToCore(rtTask, "rt_shots", RT_TASK_STACK, nullptr,
+                                                RT_TASK_PRIORITY, &rtTaskHandle, RT_TASK_CORE);
+    return result == pdPASS;
+}
+
+bool rtSubmit(const ControlCommand& command) {
+    if (!commandRing.push(command)) return false;
+    if (rtTaskHandle != nullptr) xTaskNotifyGive(rtTaskHandle);
+    return true;
+}
+
+uint32_t rtSubmitShotJob(uint16_t count, uint32_t spacingMs) {
+    static uint32_t nextJobId = 1;
+    
+    ControlCommand command;
+    command.type = CMD_SHOT_JOB;
+    command.count = count;
+    command.spacingMs = spacingMs;
+    command.jobId = nextJobId;
+    if (!rtSubmit(command)) return 0;
+    
+    uint32_t id = nextJobId++;
+    if (nextJobId == 0) nextJobId = 1;
+    return id;
+}
+
+void rtReadStatus(StatusSnapshot& snapshot) {
+    statusLock.read(snapshot);
+}
+
+uint32_t rtStatusVersion() {
+    return statusLock.version();
+}
+
+bool rtSetIdleSleep(bool enabled) {
+    // APB stays at 80 MHz down to the lowest CPU clock, so RMT timing holds;
+    // switched off, the CPU stays at full clock as before
+    esp_pm_config_esp32_t config = {};
+    config.max_freq_mhz = 240;
+    config.min_freq_mhz = enabled ? 80 : 240;
+    config.light_sleep_enable = enabled;
+    esp_err_t result = esp_pm_configure(&config);
+    if (result != ESP_OK && enabled) {
+        Serial.printf("Automatic light sleep unavailable (error 0x%x): needs the esp32-field "
+                      "build with power management and tickless idle\n", result);
+        enabled = false;
+    }
+    
+    idleSleepEnabled.store(enabled, std::memory_order_relaxed);
+    if (rtTaskHandle != nullptr) xTaskNotifyGive(rtTaskHandle);
+    return enabled;
+}
+
+bool rtIdleSleepEnabled() {
+    return idleSleepEnabled.load(std::memory_order_relaxed);
+}
+
+bool rtLightSleepPermitted() {
+    return sleepPermitted.load(std::memory_order_relaxed);
+}
+
+void rtHoldAwake(uint32_t ms) {
+    uint32_t now = millis();
+    bool expired = timeReached(now, awakeUntil.load(std::memory_order_relaxed));
+    awakeUntil.store(now + ms, std::memory_order_relaxed);
+    
+    // The shot task may be waiting without the lock, wake it to take it
+    if (expired && sleepPermitted.load(std::memory_order_relaxed) && rtTaskHandle != nullptr) {
+        xTaskNotifyGive(rtTaskHandle);
+    }
+}
+
+void rtReadIdleSleepStats(IdleSleepStats& stats) {
+    sleepStatsLock.read(stats);
+}
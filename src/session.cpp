@@ -0,0 +1,264 @@
+#include "session.h"
+
+#include "config.h"
+#include "ir_transmitter.h"
+#include "metrics.h"
+#include "shot_jobs.h"
+#include "shot_log.h"
+
+static SessionData session;
+
+// Compiled schedule of the current session: deadline = start + offset
+static uint32_t scheduleOffsets[MAX_SEQUENCE_SHOTS];
+
+// Shot timing statistics of the current session
+static LatenessStats shotLateness;
+
+static IrProfileId irProfile = IR_PROFILE_DEFAULT;
+static IrProfileId pendingIrProfile = IR_PROFILE_DEFAULT;
+static bool irProfilePending = false;
+static uint32_t shutterDurationMs = 0;     // On-air time of the profile's train
+static uint32_t lastJobId = 0;
+static uint32_t jobShotsFired = 0;
+static uint32_t jobsRejected = 0;
+
+static bool executeShot() {
+    // Replay the profile's precomputed frames, the RMT peripheral does the timing.
+    // Fails while the previous shot is still on air; callers retry.
+    METRIC_TIME_SCOPE(METRIC_IR_SEND);
+    if (!irTransmitterSend()) {
+        METRIC_COUNT(METRIC_IR_BUSY);
+        return false;
+    }
+    METRIC_COUNT(METRIC_SHOTS_SENT);
+    return true;
+}
+
+// Telemetry record for /api/shots
+static void logShot(ShotKind kind, uint16_t index, uint32_t jobId, uint32_t scheduled, uint32_t now) {
+    ShotRecord record = {};
+    record.kind = kind;
+    record.index = index;
+    record.jobId = (uint16_t)jobId;
+    record.scheduledMs = scheduled;
+    record.actualMs = now;
+    shotLogRecord(record);
+}
+
+// Time from shot `slot` to the next one, or to the end of the session
+static uint32_t gapAfter(uint16_t slot) {
+    if (slot + 1 < session.totalShots) return scheduleOffsets[slot + 1] - scheduleOffsets[slot];
+    return session.durationMs - scheduleOffsets[slot];
+}
+
+// A resumed session keeps its original start time and first untaken slot
+static void startSession(const SequencePlan& plan, uint32_t startTime, uint16_t firstShot) {
+    if (session.state == STATE_RUNNING) return;
+    
+    // Validated on the web side already, the hot path below only reads the table
+    SequenceSummary summary;
+    if (sequenceCompile(plan, SESSION_START_DELAY_MS, scheduleOffsets, MAX_SEQUENCE_SHOTS, summary) != SEQUENCE_OK) {
+        return;
+    }
+    
+    session.sessionNumber++;
+    session.totalShots = summary.shots;
+    session.durationMs = summary.durationMs;
+    session.totalMinutes = (summary.durationMs + 59999) / 60000;
+    session.currentShot = firstShot;
+    session.sessionStartTime = startTime;
+    if (firstShot < session.totalShots) {
+        session.nextShotTime = sessionShotDeadline(firstShot);
+        session.intervalMs = gapAfter(firstShot);
+        session.state = STATE_RUNNING;
+    } else {
+        session.state = STATE_COMPLETED;
+    }
+    latenessReset(shotLateness);
+}
+
+// Follower: join the leader's session, skipping slots that are already
+// over, or move a running one to a corrected start time
+static void syncSession(const SequencePlan& plan, uint32_t startTime, uint32_t now) {
+    if (session.state != STATE_RUNNING) {
+        startSession(plan, startTime, 0);
+        if (session.state != STATE_RUNNING) return;
+        
+        while (session.currentShot < session.totalShots &&
+               (int32_t)(now - sessionShotDeadline(session.currentShot)) > 0) {
+            session.currentShot++;
+        }
+        if (session.currentShot >= session.totalShots) {
+            session.state = STATE_COMPLETED;
+            return;
+        }
+    }
+    
+    session.sessionStartTime = startTime;
+    session.nextShotTime = sessionShotDeadline(session.currentShot);
+    session.intervalMs = gapAfter(session.currentShot);
+}
+
+static void stopSession() {
+    if (session.state == STATE_RUNNING) {
+        session.state = STATE_IDLE;
+    }
+}
+
+static bool updateSession(uint32_t now) {
+    if (session.state != STATE_RUNNING) return false;
+    
+    // Check if it's time for next shot
+    if (!timeReached(now, session.nextShotTime)) return false;
+    
+    // If we fell behind by more than one interval, fire the latest due slot
+    // instead of replaying the missed ones back to back
+    uint16_t slot = dueScheduleSlot(now, session.sessionStartTime, scheduleOffsets,
+                                    session.totalShots, session.currentShot);
+    if (slot > session.currentShot) {
+        shotLateness.missed += slot - session.currentShot;
+        session.currentShot = slot;
+    }
+    
+    // A job shot still on air delays us until the next poll
+    if (!executeShot()) return false;
+    
+    uint32_t deadline = sessionShotDeadline(session.currentShot);
+    latenessRecord(shotLateness, now - deadline);
+    logShot(SHOT_SESSION, session.currentShot, 0, deadline, now);
+    if (now - deadline >= LATE_SHOT_THRESHOLD_MS) METRIC_COUNT(METRIC_SHOTS_LATE);
+    
+    session.currentShot++;
+    
+    // Check if session is complete
+    if (session.currentShot >= session.totalShots) {
+        session.state = STATE_COMPLETED;
+    } else {
+        session.nextShotTime = sessionShotDeadline(session.currentShot);
+        session.intervalMs = gapAfter(session.currentShot);
+    }
+    return true;
+}
+
+static bool updateJobs(uint32_t now) {
+    ShotJob* job = shotJobsDue(now);
+    if (job == nullptr) return false;
+    
+    // Session shots have priority: don't start a job shot that would
+    // still be on air at the next session deadline
+    if (session.state == STATE_RUNNING && timeReached(now + shutterDurationMs, session.nextShotTime)) {
+        return false;
+    }
+    
+    if (!executeShot()) return false;
+    
+    logShot(SHOT_JOB, job->fired, job->id, shotDeadline(job->startTime, 0, job->spacingMs, job->fired), now);
+    lastJobId = job->id;
+    jobShotsFired++;
+    shotJobsShotFired(job);
+    return true;
+}
+
+static bool loadIrProfile(IrProfileId profile) {
+    const IrPulseTrain& train = *IR_PROFILES[profile].train;
+    if (!irTransmitterLoad(train)) return false;
+    
+    irProfile = profile;
+    shutterDurationMs = irTrainDurationUs(train) / 1000 + 1;
+    return true;
+}
+
+// Switch profiles between shots only, never under a running transmission
+static bool updateIrProfile() {
+    if (!irProfilePending || irTransmitterBusy()) return false;
+    
+    irProfilePending = false;
+    return loadIrProfile(pendingIrProfile);
+}
+
+bool sessionBegin(IrProfileId profile) {
+    return loadIrProfile(profile);
+}
+
+void sessionApplyCommand(const ControlCommand& command, uint32_t now) {
+    switch (command.type) {
+        case CMD_START_SESSION:
+            startSession(command.plan, now, 0);
+            break;
+        case CMD_RESUME_SESSION:
+            startSession(command.plan, command.startTime, command.nextShot);
+            break;
+        case CMD_SYNC_SESSION:
+            syncSession(command.plan, command.startTime, now);
+            break;
+        case CMD_STOP_SESSION:
+            stopSession();
+            break;
+        case CMD_SHOT_JOB:
+            if (!shotJobsAdd(command.jobId, command.count, command.spacingMs, now)) {
+                jobsRejected++;
+            }
+            break;
+        case CMD_SET_IR_PROFILE:
+            if (command.irProfile < IR_PROFILE_COUNT) {
+                pendingIrProfile = command.irProfile;
+                irProfilePending = true;
+            }
+            break;
+    }
+}
+
+bool sessionPoll(uint32_t now) {
+    // Session first, a job shot can only go out if the session left the sender idle
+    bool changed = updateIrProfile();
+    changed |= updateSession(now);
+    changed |= updateJobs(now);
+    return changed;
+}
+
+uint32_t sessionShotDeadline(uint16_t slot) {
+    return session.sessionStartTime + scheduleOffsets[slot];
+}
+
+uint32_t sessionTimeToNextEvent(uint32_t now, uint32_t maxWaitMs) {
+    uint32_t wait = maxWaitMs;
+    
+    // Retry soon while the previous train is still on air
+    if (irProfilePending && wait > IR_PROFILE_RETRY_MS) wait = IR_PROFILE_RETRY_MS;
+    
+    if (session.state == STATE_RUNNING) {
+        int32_t untilShot = (int32_t)(session.nextShotTime - now);
+        if (untilShot <= 0) return 0;
+        if ((uint32_t)untilShot < wait) wait = untilShot;
+    }
+    
+    uint32_t jobDeadline;
+    if (shotJobsNextDeadline(now, jobDeadline)) {
+        int32_t untilJob = (int32_t)(jobDeadline - now);
+        if (untilJob <= 0) return 0;
+        if ((uint32_t)untilJob < wait) wait = untilJob;
+    }
+    return wait;
+}
+
+void sessionFillSnapshot(StatusSnapshot& snapshot) {
+    snapshot.session = session;
+    snapshot.lateness = shotLateness;
+    snapshot.jobsPending = shotJobsPending();
+    snapshot.lastJobId = lastJobId;
+    snapshot.jobShotsFired = jobShotsFired;
+    snapshot.jobsRejected = jobsRejected;
+    snapshot.irProfile = irProfile;
+}
+
+uint16_t calculateTotalShots(uint16_t minutes) {
+    return ((uint32_t)minutes * 60000) / DEFAULT_INTERVAL_MS;
+}
+
+uint32_t calculateIntervalMs() {
+    return DEFAULT_INTERVAL_MS;
+}
+
+void sessionPlanForMinutes(SequencePlan& plan, uint16_t minutes) {
+    sequenceFixed(plan, calculateTotalShots(minutes), calculateIntervalMs());
+}
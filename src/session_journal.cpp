@@ -0,0 +1,177 @@
+#include "session_journal.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "wall_clock.h"
+
+static File journalFile;
+static bool journalReady = false;
+static uint32_t nextSequence = 1;
+
+// Current session as journaled
+static uint32_t sessionId = 0;
+static int64_t sessionStartEpochMs = 0;
+static uint32_t lastConfigSequence = 0;
+
+// Records waiting for the next batch write
+static JournalRecord batch[JOURNAL_BATCH_RECORDS];
+static uint8_t batchCount = 0;
+static unsigned long batchStarted = 0;
+
+static bool preallocate() {
+    journalFile = LittleFS.open(JOURNAL_PATH, "w+");
+    if (!journalFile) return false;
+    
+    uint8_t zeros[256] = {0};
+    for (uint32_t written = 0; written < JOURNAL_CAPACITY * sizeof(JournalRecord); written += sizeof(zeros)) {
+        if (journalFile.write(zeros, sizeof(zeros)) != sizeof(zeros)) return false;
+    }
+    journalFile.flush();
+    return true;
+}
+
+static void flushBatch() {
+    if (!journalReady || batchCount == 0) return;
+    
+    // Records are contiguous in sequence, but may wrap around the ring end
+    uint8_t done = 0;
+    while (done < batchCount) {
+        uint32_t slot = batch[done].sequence % JOURNAL_CAPACITY;
+        uint8_t run = 1;
+        while (done + run < batchCount && slot + run < JOURNAL_CAPACITY) run++;
+        
+        journalFile.seek(slot * sizeof(JournalRecord));
+        journalFile.write((const uint8_t*)&batch[done], run * sizeof(JournalRecord));
+        done += run;
+    }
+    journalFile.flush();
+    batchCount = 0;
+}
+
+static void append(JournalType type, const SessionData& session, uint16_t shot) {
+    if (!journalReady) return;
+    
+    JournalRecord& record = batch[batchCount];
+    record = JournalRecord();
+    record.sequence = nextSequence++;
+    record.type = type;
+    record.shot = shot;
+    record.startEpochMs = sessionStartEpochMs;
+    record.sessionId = sessionId;
+    record.intervalMs = session.intervalMs;
+    record.minutes = session.totalMinutes;
+    record.totalShots = session.totalShots;
+    journalSeal(record);
+    
+    if (type != JOURNAL_SHOT) lastConfigSequence = record.sequence;
+    if (batchCount++ == 0) batchStarted = millis();
+    if (batchCount == JOURNAL_BATCH_RECORDS) flushBatch();
+}
+
+bool sessionJournalBegin(JournalRecovery& recovery) {
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS mount failed, session journal disabled");
+        return false;
+    }
+    
+    const size_t bytes = JOURNAL_CAPACITY * sizeof(JournalRecord);
+    bool exists = LittleFS.exists(JOURNAL_PATH);
+    if (exists) {
+        journalFile = LittleFS.open(JOURNAL_PATH, "r+");
+    }
+    
+    if (!journalFile || journalFile.size() != bytes) {
+        if (journalFile) journalFile.close();
+        if (!preallocate()) {
+            Serial.println("Failed to create session journal");
+            return false;
+        }
+    } else {
+        // One-off buffer for the replay, released right after
+        JournalRecord* records = (JournalRecord*)malloc(bytes);
+        if (records == nullptr) return false;
+        
+        journalFile.seek(0);
+        size_t read = journalFile.read((uint8_t*)records, bytes);
+        if (read == bytes) {
+            recovery = journalRecover(records, JOURNAL_CAPACITY);
+            nextSequence = recovery.nextSequence;
+        }
+        free(records);
+    }
+    
+    journalReady = true;
+    Serial.printf("Session journal: %lu records, %lu skipped, next sequence %lu\n",
+                  (unsigned long)recovery.validRecords, (unsigned long)recovery.skippedRecords,
+                  (unsigned long)nextSequence);
+    return true;
+}
+
+// Plan file: the plan followed by its CRC-32
+bool sessionJournalSavePlan(const SequencePlan& plan) {
+    if (!journalReady) return false;
+    
+    File file = LittleFS.open(JOURNAL_PLAN_PATH, "w");
+    if (!file) return false;
+    
+    uint32_t crc = journalCrc32((const uint8_t*)&plan, sizeof(plan));
+    bool ok = file.write((const uint8_t*)&plan, sizeof(plan)) == sizeof(plan) &&
+              file.write((const uint8_t*)&crc, sizeof(crc)) == sizeof(crc);
+    file.close();
+    return ok;
+}
+
+bool sessionJournalLoadPlan(SequencePlan& plan) {
+    File file = LittleFS.open(JOURNAL_PLAN_PATH, "r");
+    if (!file) return false;
+    
+    uint32_t crc = 0;
+    bool ok = file.read((uint8_t*)&plan, sizeof(plan)) == sizeof(plan) &&
+              file.read((uint8_t*)&crc, sizeof(crc)) == sizeof(crc);
+    file.close();
+    return ok && crc == journalCrc32((const uint8_t*)&plan, sizeof(plan));
+}
+
+void sessionJournalOnStatus(const StatusSnapshot& previous, const StatusSnapshot& current) {
+    const SessionData& before = previous.session;
+    const SessionData& now = current.session;
+    
+    bool started = now.state == STATE_RUNNING &&
+                   (before.state != STATE_RUNNING || before.sessionNumber != now.sessionNumber);
+    if (started) {
+        flushBatch();
+        sessionId = nextSequence;
+        sessionStartEpochMs = wallClockEpochMs() - (int64_t)(millis() - now.sessionStartTime);
+        append(JOURNAL_SESSION_START, now, now.currentShot);
+        flushBatch();
+        return;
+    }
+    
+    // Same session on a corrected start (follower or SNTP re-anchor): the new
+    // anchor rides in the normal batch as a checkpoint
+    if (now.state == STATE_RUNNING && before.sessionStartTime != now.sessionStartTime && sessionId != 0) {
+        sessionStartEpochMs = wallClockEpochMs() - (int64_t)(millis() - now.sessionStartTime);
+        append(JOURNAL_CHECKPOINT, now, now.currentShot);
+    }
+    
+    if (now.currentShot > before.currentShot && sessionId != 0) {
+        append(JOURNAL_SHOT, now, now.currentShot - 1);
+        
+        // Keep the config inside the ring however long the session runs
+        if (nextSequence - lastConfigSequence >= JOURNAL_CHECKPOINT_EVERY) {
+            append(JOURNAL_CHECKPOINT, now, now.currentShot);
+        }
+    }
+    
+    if (before.state == STATE_RUNNING && now.state != STATE_RUNNING && sessionId != 0) {
+        append(JOURNAL_SESSION_END, now, now.currentShot);
+        flushBatch();
+        sessionId = 0;
+    }
+}
+
+void sessionJournalMaintain() {
+    if (batchCount > 0 && millis() - batchStarted >= JOURNAL_FLUSH_MS) {
+        flushBatch();
+    }
+}
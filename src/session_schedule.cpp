@@ -0,0 +1,247 @@
+#include "session_schedule.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <time.h>
+#include "rt_task.h"
+#include "session_journal.h"
+#include "sync_link.h"
+#include "wall_clock.h"
+
+// Network task only, no locking
+static TimerNode nodes[SCHEDULE_CAPACITY];
+static ScheduleEntry entries[SCHEDULE_CAPACITY];
+static TimerWheel wheel;
+static SequencePlan plans[SCHEDULE_PLAN_CAPACITY];
+static uint16_t plansUsed = 0;      // Bit per plan slot
+static uint32_t nextSerial = 0;
+static ScheduleStats stats;
+
+// Wall clock minus the wheel clock when the entries were filed
+static int64_t filedOffsetMs = 0;
+
+static uint64_t wheelNowMs() {
+    return esp_timer_get_time() / 1000;
+}
+
+static int64_t clockOffsetMs() {
+    return wallClockEpochMs() - (int64_t)wheelNowMs();
+}
+
+// Starts go out SESSION_START_DELAY_MS early so the first shot lands on time
+static uint64_t wheelTick(const ScheduleEntry& entry) {
+    int64_t lead = entry.type == CMD_START_SESSION ? SESSION_START_DELAY_MS : 0;
+    int64_t tick = entry.epochMs - lead - filedOffsetMs;
+    return tick > 0 ? tick : 0;
+}
+
+const char* scheduleActionName(CommandType type) {
+    switch (type) {
+        case CMD_START_SESSION: return "start";
+        case CMD_STOP_SESSION: return "stop";
+        default: return "shot";
+    }
+}
+
+static void release(uint16_t index) {
+    if (entries[index].type == CMD_START_SESSION) plansUsed &= ~(1U << entries[index].plan);
+    entries[index].id = 0;
+}
+
+// Clock steps are rare; only then is every entry touched
+static void followClockSteps() {
+    int64_t step = clockOffsetMs() - filedOffsetMs;
+    if (step > -SCHEDULE_STEP_TOLERANCE_MS && step < SCHEDULE_STEP_TOLERANCE_MS) return;
+    
+    filedOffsetMs += step;
+    if (wheel.pending == 0) return;
+    
+    stats.steps++;
+    stats.lastStepMs = step;
+    for (uint16_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+        if (entries[i].id != 0) timerWheelMove(wheel, i, wheelTick(entries[i]));
+    }
+    Serial.printf("Wall clock stepped by %lld ms, %u scheduled entries refiled\n",
+                  (long long)step, wheel.pending);
+}
+
+// Returns whether a session runs afterwards
+static bool fire(const ScheduleEntry& entry, uint64_t now, bool running) {
+    uint64_t lateMs = now - wheelTick(entry);
+    if (lateMs > SCHEDULE_LATE_LIMIT_MS) {
+        stats.missed++;
+        Serial.printf("Scheduled %s %lu missed by %lu s\n", scheduleActionName(entry.type),
+                      (unsigned long)entry.id, (unsigned long)(lateMs / 1000));
+        return running;
+    }
+    
+    bool submitted;
+    if (entry.type == CMD_SHOT_JOB) {
+        submitted = rtSubmitShotJob(entry.count, entry.spacingMs) != 0;
+    } else if (entry.type == CMD_START_SESSION && (running || syncMode() == SYNC_FOLLOWER)) {
+        submitted = false;
+    } else {
+        ControlCommand command;
+        command.type = entry.type;
+        if (entry.type == CMD_START_SESSION) command.plan = plans[entry.plan];
+        submitted = rtSubmit(command);
+        if (submitted && entry.type == CMD_START_SESSION) sessionJournalSavePlan(command.plan);
+    }
+    
+    if (!submitted) {
+        stats.skipped++;
+        Serial.printf("Scheduled %s %lu skipped\n", scheduleActionName(entry.type), (unsigned long)entry.id);
+        return running;
+    }
+    
+    stats.fired++;
+    Serial.printf("Scheduled %s %lu fired\n", scheduleActionName(entry.type), (unsigned long)entry.id);
+    if (entry.type == CMD_START_SESSION) return true;
+    if (entry.type == CMD_STOP_SESSION) return false;
+    return running;
+}
+
+void scheduleBegin() {
+    timerWheelInit(wheel, nodes, SCHEDULE_CAPACITY, wheelNowMs());
+    filedOffsetMs = clockOffsetMs();
+}
+
+const char* scheduleAdd(const ControlCommand& command, int64_t epochMs, uint32_t& id) {
+    if (wallClockSource() == CLOCK_NONE) return "Scheduling needs the wall clock, not synchronized yet";
+    if (command.type != CMD_START_SESSION && command.type != CMD_STOP_SESSION && command.type != CMD_SHOT_JOB) {
+        return "Only starts, stops and shots can be scheduled";
+    }
+    
+    followClockSteps();
+    int64_t aheadMs = epochMs - wallClockEpochMs();
+    if (command.type == CMD_START_SESSION) aheadMs -= SESSION_START_DELAY_MS;
+    if (aheadMs < 0) return "Time is in the past or, for a start, less than 5 s ahead";
+    if (aheadMs > SCHEDULE_MAX_AHEAD_MS) return "Time is more than 30 days ahead";
+    
+    uint8_t plan = 0;
+    if (command.type == CMD_START_SESSION) {
+        while (plan < SCHEDULE_PLAN_CAPACITY && (plansUsed & (1U << plan))) plan++;
+        if (plan == SCHEDULE_PLAN_CAPACITY) return "Too many scheduled starts";
+    }
+    
+    ScheduleEntry entry;
+    entry.type = command.type;
+    entry.plan = plan;
+    entry.count = command.count;
+    entry.spacingMs = command.spacingMs;
+    entry.epochMs = epochMs;
+    
+    uint16_t index = timerWheelAdd(wheel, wheelTick(entry));
+    if (index == TIMER_NONE) return "Schedule full";
+    
+    // Index in the low part so cancelling needs no search
+    entry.id = ++nextSerial * SCHEDULE_CAPACITY + index;
+    entries[index] = entry;
+    if (command.type == CMD_START_SESSION) {
+        plans[plan] = command.plan;
+        plansUsed |= 1U << plan;
+    }
+    id = entry.id;
+    return nullptr;
+}
+
+bool scheduleCancel(uint32_t id) {
+    uint16_t index = id % SCHEDULE_CAPACITY;
+    if (id == 0 || entries[index].id != id) return false;
+    
+    timerWheelCancel(wheel, index);
+    release(index);
+    return true;
+}
+
+void scheduleUpdate(const StatusSnapshot& status) {
+    followClockSteps();
+    
+    uint64_t now = wheelNowMs();
+    timerWheelAdvance(wheel, now);
+    
+    // Entries due on the same pass see each other's start and stop
+    bool running = status.session.state == STATE_RUNNING;
+    uint16_t index;
+    while ((index = timerWheelPop(wheel)) != TIMER_NONE) {
+        running = fire(entries[index], now, running);
+        release(index);
+    }
+}
+
+uint32_t scheduleTimeToNext(uint32_t maxMs) {
+    uint64_t next = timerWheelNextExpiry(wheel);
+    uint64_t now = wheelNowMs();
+    if (next <= now) return 0;
+    return next - now < maxMs ? next - now : maxMs;
+}
+
+uint16_t scheduleList(uint16_t* order, uint16_t capacity) {
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < SCHEDULE_CAPACITY && count < capacity; i++) {
+        if (entries[i].id == 0) continue;
+        
+        // Insertion sort, only ever run for a listing
+        uint16_t at = count++;
+        while (at > 0 && entries[order[at - 1]].epochMs > entries[i].epochMs) {
+            order[at] = order[at - 1];
+            at--;
+        }
+        order[at] = i;
+    }
+    return count;
+}
+
+const ScheduleEntry& scheduleEntry(uint16_t index) {
+    return entries[index];
+}
+
+void scheduleReadStats(ScheduleStats& copy) {
+    copy = stats;
+    copy.pending = wheel.pending;
+    copy.cascaded = wheel.cascaded;
+}
+
+bool scheduleParseTime(const char* text, int64_t afterEpochMs, int64_t& epochMs) {
+    struct tm local;
+    time_t after = afterEpochMs / 1000;
+    localtime_r(&after, &local);
+    
+    int year, month, day, hour, minute, second = 0;
+    int used = 0;
+    bool timeOfDay = false;
+    if (sscanf(text, "%d-%d-%dT%d:%d%n:%d%n", &year, &month, &day, &hour, &minute, &used, &second, &used) >= 5) {
+        local.tm_year = year - 1900;
+        local.tm_mon = month - 1;
+        local.tm_mday = day;
+    } else if (sscanf(text, "%d:%d%n:%d%n", &hour, &minute, &used, &second, &used) >= 2) {
+        timeOfDay = true;
+    } else {
+        return false;
+    }
+    if (text[used] != '\0' || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 59) {
+        return false;
+    }
+    if (!timeOfDay && (month < 1 || month > 12 || day < 1 || day > 31)) return false;
+    
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_sec = second;
+    local.tm_isdst = -1;
+    time_t when = mktime(&local);
+    
+    // Time of day: tomorrow if today's has passed
+    if (timeOfDay && (int64_t)when * 1000 <= afterEpochMs) {
+        local.tm_mday++;
+        local.tm_hour = hour;
+        local.tm_min = minute;
+        local.tm_sec = second;
+        local.tm_isdst = -1;
+        when = mktime(&local);
+    }
+    if (when == (time_t)-1) return false;
+    
+    epochMs = (int64_t)when * 1000;
+    return true;
+}
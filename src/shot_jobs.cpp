@@ -0,0 +1,67 @@
+#include "shot_jobs.h"
+
+#include "shot_scheduler.h"
+
+static ShotJob jobs[MAX_SHOT_JOBS];
+
+bool shotJobsAdd(uint32_t id, uint16_t count, uint32_t spacingMs, uint32_t now) {
+    if (id == 0 || count == 0) return false;
+    
+    for (uint8_t i = 0; i < MAX_SHOT_JOBS; i++) {
+        if (jobs[i].id != 0) continue;
+        
+        jobs[i].id = id;
+        jobs[i].count = count;
+        jobs[i].fired = 0;
+        jobs[i].spacingMs = spacingMs;
+        jobs[i].startTime = now;
+        return true;
+    }
+    return false;
+}
+
+ShotJob* shotJobsDue(uint32_t now) {
+    ShotJob* due = nullptr;
+    
+    // Lowest id first so jobs run in submission order
+    for (uint8_t i = 0; i < MAX_SHOT_JOBS; i++) {
+        ShotJob& job = jobs[i];
+        if (job.id == 0) continue;
+        
+        uint32_t deadline = shotDeadline(job.startTime, 0, job.spacingMs, job.fired);
+        if (!timeReached(now, deadline)) continue;
+        if (due == nullptr || job.id < due->id) due = &job;
+    }
+    return due;
+}
+
+void shotJobsShotFired(ShotJob* job) {
+    job->fired++;
+    if (job->fired >= job->count) {
+        job->id = 0;
+    }
+}
+
+bool shotJobsNextDeadline(uint32_t now, uint32_t& deadline) {
+    bool found = false;
+    
+    for (uint8_t i = 0; i < MAX_SHOT_JOBS; i++) {
+        const ShotJob& job = jobs[i];
+        if (job.id == 0) continue;
+        
+        uint32_t jobDeadline = shotDeadline(job.startTime, 0, job.spacingMs, job.fired);
+        if (!found || (int32_t)(jobDeadline - now) < (int32_t)(deadline - now)) {
+            deadline = jobDeadline;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint8_t shotJobsPending() {
+    uint8_t pending = 0;
+    for (uint8_t i = 0; i < MAX_SHOT_JOBS; i++) {
+        if (jobs[i].id != 0) pending++;
+    }
+    return pending;
+}
@@ -0,0 +1,66 @@
+#include "shot_log.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include "temperature_sensor.h"
+#include "wall_clock.h"
+
+static ShotRecord* records = nullptr;
+static uint32_t capacity = 0;
+
+// Single writer (real-time task). `writing` announces the slot about to be
+// overwritten before its data changes, readers check it after copying,
+// the same scheme as SeqLock.
+static std::atomic<uint32_t> writing{0};
+static std::atomic<uint32_t> written{0};
+
+bool shotLogBegin() {
+    // Several thousand shots fit into PSRAM, otherwise keep a short history
+    if (psramFound()) {
+        records = (ShotRecord*)ps_malloc(SHOT_LOG_CAPACITY_PSRAM * sizeof(ShotRecord));
+        if (records != nullptr) capacity = SHOT_LOG_CAPACITY_PSRAM;
+    }
+    if (records == nullptr) {
+        records = (ShotRecord*)malloc(SHOT_LOG_CAPACITY * sizeof(ShotRecord));
+        if (records != nullptr) capacity = SHOT_LOG_CAPACITY;
+    }
+    return records != nullptr;
+}
+
+void shotLogRecord(ShotRecord& record) {
+    if (records == nullptr) return;
+    
+    record.sequence = written.load(std::memory_order_relaxed) + 1;
+    record.epochMs = wallClockSource() != CLOCK_NONE ? wallClockEpochMs() : 0;
+    record.temperatureCenti = temperatureLatestCenti();
+    record.freeHeap = ESP.getFreeHeap();
+    
+    writing.store(record.sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    memcpy(&records[record.sequence % capacity], &record, sizeof(ShotRecord));
+    
+    written.store(record.sequence, std::memory_order_release);
+}
+
+void shotLogRange(uint32_t& first, uint32_t& next) {
+    next = written.load(std::memory_order_acquire) + 1;
+    first = next > capacity ? next - capacity : 1;
+}
+
+bool shotLogRead(uint32_t sequence, ShotRecord& record) {
+    if (records == nullptr || sequence == 0) return false;
+    if (sequence > written.load(std::memory_order_acquire)) return false;
+    
+    memcpy(&record, &records[sequence % capacity], sizeof(ShotRecord));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    
+    // The slot may have been reused for sequence + capacity meanwhile
+    uint32_t latest = writing.load(std::memory_order_relaxed);
+    return record.sequence == sequence && latest - sequence < capacity;
+}
+
+uint32_t shotLogCapacity() {
+    return capacity;
+}
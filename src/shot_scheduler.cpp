@@ -0,0 +1,54 @@
+#include "shot_scheduler.h"
+
+#include <string.h>
+
+uint16_t dueScheduleSlot(uint32_t now, uint32_t startTime, const uint32_t* offsets, uint16_t count, uint16_t nextSlot) {
+    // Offsets are ascending; usually nothing was missed and this exits at once
+    uint16_t slot = nextSlot;
+    while (slot + 1 < count && timeReached(now, startTime + offsets[slot + 1])) {
+        slot++;
+    }
+    return slot;
+}
+
+void latenessReset(LatenessStats& stats) {
+    stats.count = 0;
+    stats.minMs = 0;
+    stats.maxMs = 0;
+    stats.sumMs = 0;
+    stats.missed = 0;
+    memset(stats.histogram, 0, sizeof(stats.histogram));
+}
+
+void latenessRecord(LatenessStats& stats, uint32_t latenessMs) {
+    if (stats.count == 0 || latenessMs < stats.minMs) stats.minMs = latenessMs;
+    if (latenessMs > stats.maxMs) stats.maxMs = latenessMs;
+    stats.count++;
+    stats.sumMs += latenessMs;
+    
+    uint16_t bucket = latenessMs < LATENESS_BUCKETS ? latenessMs : LATENESS_BUCKETS - 1;
+    if (stats.histogram[bucket] < UINT16_MAX) stats.histogram[bucket]++;
+}
+
+uint32_t latenessMeanMs(const LatenessStats& stats) {
+    if (stats.count == 0) return 0;
+    return (uint32_t)(stats.sumMs / stats.count);
+}
+
+uint32_t latenessPercentileMs(const LatenessStats& stats, uint8_t percentile) {
+    if (stats.count == 0) return 0;
+    
+    // Rank of the requested percentile, rounded up (nearest-rank method)
+    uint32_t rank = ((uint64_t)stats.count * percentile + 99) / 100;
+    if (rank == 0) rank = 1;
+    
+    uint32_t seen = 0;
+    for (uint16_t i = 0; i < LATENESS_BUCKETS; i++) {
+        seen += stats.histogram[i];
+        if (seen >= rank) {
+            // The overflow bucket has no upper bound, report the observed maximum
+            return i == LATENESS_BUCKETS - 1 ? stats.maxMs : i;
+        }
+    }
+    return stats.maxMs;
+}
@@ -0,0 +1,104 @@
+#include "shot_sequence.h"
+
+#include <math.h>
+
+static bool validInterval(uint32_t intervalMs) {
+    return intervalMs >= MIN_SEQUENCE_INTERVAL_MS && intervalMs <= MAX_SEQUENCE_INTERVAL_MS;
+}
+
+// Interval after shot `k` of a linear ramp, exact integer interpolation
+static uint32_t linearInterval(const SequencePhase& phase, uint16_t k) {
+    if (phase.shots < 2) return phase.intervalMs;
+    int64_t span = (int64_t)phase.endIntervalMs - phase.intervalMs;
+    return phase.intervalMs + (int32_t)(span * k / (phase.shots - 1));
+}
+
+void sequenceFixed(SequencePlan& plan, uint16_t shots, uint32_t intervalMs) {
+    plan = SequencePlan();
+    plan.phaseCount = 1;
+    plan.phases[0].type = PHASE_FIXED;
+    plan.phases[0].shots = shots;
+    plan.phases[0].intervalMs = intervalMs;
+}
+
+SequenceError sequenceCompile(const SequencePlan& plan, uint32_t startDelayMs,
+                              uint32_t* offsets, uint16_t capacity, SequenceSummary& summary) {
+    summary = SequenceSummary();
+    if (plan.phaseCount == 0 || plan.phaseCount > MAX_SEQUENCE_PHASES) return SEQUENCE_NO_PHASES;
+    
+    // 64 bit cursor so oversized plans are rejected instead of wrapping
+    uint64_t cursor = startDelayMs;
+    uint32_t shots = 0;
+    
+    for (uint8_t p = 0; p < plan.phaseCount; p++) {
+        const SequencePhase& phase = plan.phases[p];
+        
+        switch (phase.type) {
+            case PHASE_PAUSE:
+                cursor += phase.durationMs;
+                continue;
+            case PHASE_AT:
+                if (phase.durationMs < cursor) return SEQUENCE_AT_IN_PAST;
+                cursor = phase.durationMs;
+                continue;
+            case PHASE_FIXED:
+            case PHASE_BURST:
+            case PHASE_RAMP_LINEAR:
+            case PHASE_RAMP_EXP:
+                break;
+            default:
+                return SEQUENCE_BAD_PHASE;
+        }
+        
+        if (phase.shots == 0) return SEQUENCE_BAD_PHASE;
+        if (!validInterval(phase.intervalMs)) return SEQUENCE_BAD_INTERVAL;
+        bool ramp = phase.type == PHASE_RAMP_LINEAR || phase.type == PHASE_RAMP_EXP;
+        if (ramp && !validInterval(phase.endIntervalMs)) return SEQUENCE_BAD_INTERVAL;
+        if (shots + phase.shots > MAX_SEQUENCE_SHOTS) return SEQUENCE_TOO_MANY_SHOTS;
+        
+        // Exponential ramps step by a constant ratio, the only floating point
+        // in the schedule and only done here
+        float ratio = 1.0f;
+        float exact = phase.intervalMs;
+        if (phase.type == PHASE_RAMP_EXP && phase.shots > 1) {
+            ratio = powf((float)phase.endIntervalMs / phase.intervalMs, 1.0f / (phase.shots - 1));
+        }
+        
+        for (uint16_t k = 0; k < phase.shots; k++) {
+            if (offsets != nullptr && shots < capacity) offsets[shots] = (uint32_t)cursor;
+            shots++;
+            
+            uint32_t interval = phase.intervalMs;
+            if (phase.type == PHASE_RAMP_LINEAR) {
+                interval = linearInterval(phase, k);
+            } else if (phase.type == PHASE_RAMP_EXP) {
+                interval = k + 1 == phase.shots ? phase.endIntervalMs : (uint32_t)(exact + 0.5f);
+                exact *= ratio;
+            }
+            cursor += interval;
+        }
+        if (cursor > MAX_SEQUENCE_DURATION_MS) return SEQUENCE_TOO_LONG;
+    }
+    
+    if (cursor > MAX_SEQUENCE_DURATION_MS) return SEQUENCE_TOO_LONG;
+    if (shots == 0) return SEQUENCE_NO_SHOTS;
+    if (offsets != nullptr && shots > capacity) return SEQUENCE_TOO_MANY_SHOTS;
+    
+    summary.shots = shots;
+    summary.durationMs = (uint32_t)cursor;
+    return SEQUENCE_OK;
+}
+
+const char* sequenceErrorText(SequenceError error) {
+    switch (error) {
+        case SEQUENCE_OK: return "ok";
+        case SEQUENCE_NO_PHASES: return "Between 1 and 8 phases required";
+        case SEQUENCE_BAD_PHASE: return "Unknown phase type or phase without shots";
+        case SEQUENCE_BAD_INTERVAL: return "Intervals must be 200 ms to 1 h";
+        case SEQUENCE_AT_IN_PAST: return "Start time lies before the end of the previous phases";
+        case SEQUENCE_NO_SHOTS: return "Sequence has no shots";
+        case SEQUENCE_TOO_MANY_SHOTS: return "Too many shots";
+        case SEQUENCE_TOO_LONG: return "Sequence longer than 7 days";
+    }
+    return "Invalid sequence";
+}
@@ -0,0 +1,71 @@
+#include "status_events.h"
+
+static WiFiClient eventClients[MAX_EVENT_CLIENTS];
+static unsigned long lastEventTime = 0;
+
+static const char SSE_RESPONSE_HEADER[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 2000\n\n";
+
+static void writeEvent(WiFiClient& client, const char* data, size_t len) {
+    client.write((const uint8_t*)"data: ", 6);
+    client.write((const uint8_t*)data, len);
+    client.write((const uint8_t*)"\n\n", 2);
+}
+
+bool statusEventsSubscribe(WiFiClient& client, const char* initialData, size_t len) {
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++) {
+        if (eventClients[i] && eventClients[i].connected()) continue;
+        
+        eventClients[i] = client;
+        eventClients[i].setNoDelay(true);
+        eventClients[i].setTimeout(1); // Seconds; a stalled browser must not hold up the loop
+        eventClients[i].write((const uint8_t*)SSE_RESPONSE_HEADER, sizeof(SSE_RESPONSE_HEADER) - 1);
+        writeEvent(eventClients[i], initialData, len);
+        return true;
+    }
+    return false;
+}
+
+void statusEventsPublish(const char* data, size_t len) {
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++) {
+        if (!eventClients[i]) continue;
+        
+        if (!eventClients[i].connected()) {
+            eventClients[i].stop();
+            eventClients[i] = WiFiClient();
+            continue;
+        }
+        writeEvent(eventClients[i], data, len);
+    }
+    lastEventTime = millis();
+}
+
+void statusEventsMaintain() {
+    if (millis() - lastEventTime < EVENT_KEEPALIVE_MS) return;
+    lastEventTime = millis();
+    
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++) {
+        if (!eventClients[i]) continue;
+        
+        if (!eventClients[i].connected()) {
+            eventClients[i].stop();
+            eventClients[i] = WiFiClient();
+            continue;
+        }
+        eventClients[i].write((const uint8_t*)": ping\n\n", 8);
+    }
+}
+
+uint8_t statusEventsClientCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_EVENT_CLIENTS; i++) {
+        if (eventClients[i] && eventClients[i].connected()) count++;
+    }
+    return count;
+}
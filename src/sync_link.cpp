@@ -0,0 +1,255 @@
+#include "sync_link.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <esp_timer.h>
+#include <string.h>
+#include "network_manager.h"
+#include "rt_task.h"
+#include "session_journal.h"
+
+static WiFiUDP udp;
+static SyncStatus sync;
+static uint32_t txSeq = 0;
+static uint32_t lastBeaconMs = 0;
+static uint32_t lastReportMs = 0;
+
+// Leader: the running session as beaconed
+static uint32_t leaderStartMs = 0;
+static int64_t leaderStartUs = 0;
+static bool leaderPlanValid = false;
+static SequencePlan leaderPlan;
+static SyncFollower followers[SYNC_MAX_FOLLOWERS];
+
+// Follower: latest beacon and the session taken from it
+static SyncPacket beacon;
+static bool beaconPending = false;
+static int64_t followedStartUs = 0;
+static uint32_t followedLeader = 0;
+static uint32_t anchoredStartMs = 0;
+
+static const char* const SYNC_MODE_NAMES[] = {"off", "leader", "follower"};
+
+static void sendPacket(const SyncPacket& packet) {
+    uint8_t buffer[SYNC_MAX_PACKET];
+    size_t len = syncEncode(packet, buffer, sizeof(buffer));
+    if (len == 0) return;
+    
+    udp.beginMulticastPacket();
+    udp.write(buffer, len);
+    udp.endPacket();
+}
+
+static void sendBeacon(const StatusSnapshot& status) {
+    SyncPacket packet;
+    packet.type = SYNC_BEACON;
+    packet.nodeId = sync.nodeId;
+    packet.seq = ++txSeq;
+    
+    if (status.session.state == STATE_RUNNING) {
+        // The plan of the running session is the journaled one
+        if (status.session.sessionStartTime != leaderStartMs || !leaderPlanValid) {
+            leaderStartMs = status.session.sessionStartTime;
+            leaderStartUs = syncStartUs(esp_timer_get_time(), leaderStartMs);
+            leaderPlanValid = sessionJournalLoadPlan(leaderPlan);
+        }
+        packet.sessionRunning = leaderPlanValid;
+        packet.sessionStartUs = leaderStartUs;
+        packet.plan = leaderPlan;
+    }
+    
+    packet.sentUs = esp_timer_get_time();
+    sendPacket(packet);
+    sync.beaconsSent++;
+}
+
+static void sendReport(const StatusSnapshot& status) {
+    SyncPacket packet;
+    packet.type = SYNC_REPORT;
+    packet.nodeId = sync.nodeId;
+    packet.seq = ++txSeq;
+    packet.leaderId = sync.clock.leaderId;
+    packet.offsetUs = sync.clock.offsetUs;
+    packet.jitterUs = sync.clock.jitterUs;
+    packet.skewPpb = sync.clock.skewPpb;
+    packet.samples = sync.clock.count;
+    packet.following = sync.following && status.session.state == STATE_RUNNING;
+    packet.currentShot = status.session.currentShot;
+    packet.sentUs = esp_timer_get_time();
+    sendPacket(packet);
+}
+
+static void receivePackets() {
+    uint8_t buffer[SYNC_MAX_PACKET];
+    
+    while (udp.parsePacket() > 0) {
+        // Stamp first, everything after this adds to the apparent delay
+        int64_t localUs = esp_timer_get_time();
+        int len = udp.read(buffer, sizeof(buffer));
+        
+        SyncPacket packet;
+        if (len <= 0 || !syncDecode(buffer, len, packet) || packet.nodeId == sync.nodeId) continue;
+        
+        if (sync.mode == SYNC_FOLLOWER && packet.type == SYNC_BEACON) {
+            // Stay with one leader until it goes quiet
+            bool current = sync.clock.count == 0 || packet.nodeId == sync.clock.leaderId;
+            if (!current && millis() - lastBeaconMs < SYNC_LOST_MS) continue;
+            
+            clockSyncAddSample(sync.clock, packet.nodeId, packet.seq, packet.sentUs, localUs);
+            beacon = packet;
+            beaconPending = true;
+            lastBeaconMs = millis();
+            sync.beaconsReceived++;
+        } else if (sync.mode == SYNC_LEADER && packet.type == SYNC_REPORT && packet.leaderId == sync.nodeId) {
+            syncFollowerUpdate(followers, SYNC_MAX_FOLLOWERS, packet, millis());
+        }
+    }
+}
+
+static bool submitSync(const SequencePlan& plan, uint32_t startMs) {
+    ControlCommand command;
+    command.type = CMD_SYNC_SESSION;
+    command.plan = plan;
+    command.startTime = startMs;
+    if (!rtSubmit(command)) return false;
+    
+    anchoredStartMs = startMs;
+    return true;
+}
+
+// Runs the leader's session on the local clock, once per received beacon
+static void followLeader(const StatusSnapshot& status) {
+    if (!clockSyncReady(sync.clock)) return;
+    bool running = status.session.state == STATE_RUNNING;
+    
+    if (!beacon.sessionRunning) {
+        if (sync.following && running) {
+            ControlCommand stop;
+            stop.type = CMD_STOP_SESSION;
+            rtSubmit(stop);
+            Serial.println("Leader stopped its session");
+        }
+        sync.following = false;
+        return;
+    }
+    
+    uint32_t startMs = syncLocalStartMs(sync.clock, beacon.sessionStartUs, esp_timer_get_time());
+    
+    if (!sync.following || beacon.sessionStartUs != followedStartUs || beacon.nodeId != followedLeader) {
+        // A new session from the leader replaces whatever runs locally
+        if (running) {
+            ControlCommand stop;
+            stop.type = CMD_STOP_SESSION;
+            rtSubmit(stop);
+        }
+        // Command queue full: try again on the next beacon, without
+        // replacing the journaled plan
+        if (!submitSync(beacon.plan, startMs)) return;
+        sessionJournalSavePlan(beacon.plan);
+        sync.following = true;
+        followedStartUs = beacon.sessionStartUs;
+        followedLeader = beacon.nodeId;
+        Serial.printf("Following session of %08lx, offset %lld us, jitter %lu us\n",
+                      (unsigned long)beacon.nodeId, (long long)sync.clock.offsetUs,
+                      (unsigned long)sync.clock.jitterUs);
+        return;
+    }
+    
+    // Same session: move the deadlines once the estimate has left the noise,
+    // but leave a locally stopped or completed session alone
+    int32_t moved = (int32_t)(startMs - anchoredStartMs);
+    uint32_t threshold = sync.clock.jitterUs / 1000 + 1;
+    if (threshold < SYNC_REANCHOR_MIN_MS) threshold = SYNC_REANCHOR_MIN_MS;
+    if (running && (uint32_t)abs(moved) >= threshold) submitSync(beacon.plan, startMs);
+}
+
+static void updateLink() {
+    bool station = networkState() == NET_STATION;
+    if (station && !sync.linkUp) {
+        IPAddress group(SYNC_GROUP[0], SYNC_GROUP[1], SYNC_GROUP[2], SYNC_GROUP[3]);
+        sync.linkUp = udp.beginMulticast(group, SYNC_PORT);
+        if (sync.linkUp) Serial.printf("Sync %s on %s:%u\n", syncModeName(sync.mode), group.toString().c_str(), SYNC_PORT);
+    } else if (!station && sync.linkUp) {
+        udp.stop();
+        sync.linkUp = false;
+    }
+}
+
+void syncBegin(SyncMode mode) {
+    // Unique part of the MAC address
+    sync.nodeId = (uint32_t)(ESP.getEfuseMac() >> 16);
+    if (sync.nodeId == 0) sync.nodeId = 1;
+    syncSetMode(mode);
+}
+
+void syncSetMode(SyncMode mode) {
+    if (mode == sync.mode) return;
+    
+    sync.mode = mode;
+    sync.following = false;
+    clockSyncReset(sync.clock, 0);
+    for (SyncFollower& follower : followers) follower = SyncFollower();
+    beaconPending = false;
+    leaderPlanValid = false;
+    
+    if (mode == SYNC_OFF && sync.linkUp) {
+        udp.stop();
+        sync.linkUp = false;
+    }
+}
+
+SyncMode syncMode() {
+    return sync.mode;
+}
+
+void syncUpdate(const StatusSnapshot& status) {
+    if (sync.mode == SYNC_OFF) return;
+    
+    updateLink();
+    if (!sync.linkUp) return;
+    
+    receivePackets();
+    uint32_t now = millis();
+    
+    if (sync.mode == SYNC_LEADER) {
+        if (now - lastBeaconMs >= SYNC_BEACON_MS) {
+            lastBeaconMs = now;
+            sendBeacon(status);
+        }
+        return;
+    }
+    
+    if (beaconPending) {
+        beaconPending = false;
+        followLeader(status);
+    }
+    if (sync.clock.count > 0 && now - lastReportMs >= SYNC_REPORT_MS) {
+        lastReportMs = now;
+        sendReport(status);
+    }
+}
+
+void syncReadStatus(SyncStatus& status) {
+    status = sync;
+    status.locked = clockSyncReady(sync.clock);
+    status.beaconAgeMs = sync.clock.count > 0 ? millis() - lastBeaconMs : 0;
+}
+
+const SyncFollower* syncFollowers() {
+    return followers;
+}
+
+const char* syncModeName(SyncMode mode) {
+    return mode <= SYNC_FOLLOWER ? SYNC_MODE_NAMES[mode] : "unknown";
+}
+
+bool syncModeFind(const char* name, SyncMode& mode) {
+    for (uint8_t i = 0; i <= SYNC_FOLLOWER; i++) {
+        if (strcmp(SYNC_MODE_NAMES[i], name) == 0) {
+            mode = (SyncMode)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,108 @@
+#include "temperature_filter.h"
+
+#include <math.h>
+
+static const int32_t IIR_ONE = 1 << TEMP_IIR_FRACTION_BITS;
+
+int32_t temperatureOversample(int32_t* conversions, uint8_t count, uint8_t& rejected) {
+    // Compact the usable conversions to the front, insertion-sorted
+    uint8_t valid = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t value = conversions[i];
+        if (value < TEMP_MIN_MILLI || value > TEMP_MAX_MILLI) continue;
+        uint8_t j = valid++;
+        while (j > 0 && conversions[j - 1] > value) {
+            conversions[j] = conversions[j - 1];
+            j--;
+        }
+        conversions[j] = value;
+    }
+    rejected = count - valid;
+    if (valid == 0 || valid * 2 < count) return TEMP_INVALID_MILLI;
+    
+    // Spikes from WiFi bursts on the ADC land at the ends
+    uint8_t trim = valid > 2 * TEMP_TRIM ? TEMP_TRIM : 0;
+    int32_t sum = 0;
+    for (uint8_t i = trim; i < valid - trim; i++) sum += conversions[i];
+    int32_t n = valid - 2 * trim;
+    return sum >= 0 ? (sum + n / 2) / n : (sum - n / 2) / n;
+}
+
+void temperatureFilterReset(TemperatureFilter& filter) {
+    filter = TemperatureFilter();
+}
+
+static void startMinute(TemperatureFilter& filter, uint32_t startMs) {
+    filter.collecting = true;
+    filter.minuteStartMs = startMs;
+    filter.minuteSum = 0;
+    filter.minuteReadings = 0;
+}
+
+bool temperatureFilterAdd(TemperatureFilter& filter, uint32_t nowMs, int32_t milliC, TemperatureMinute& completed) {
+    // After a long gap the old state says nothing about the new reading
+    if (filter.primed && nowMs - filter.lastMs > TEMP_STALE_MS) {
+        filter.primed = false;
+        filter.restarts++;
+    }
+    
+    if (!filter.primed) {
+        filter.state = milliC * IIR_ONE;
+        filter.primed = true;
+    } else {
+        // y += (x - y) / 2^k; both factors are powers of two, so shifts only
+        filter.state += (milliC * IIR_ONE - filter.state) / (1 << TEMP_IIR_SHIFT);
+    }
+    filter.lastMs = nowMs;
+    filter.readings++;
+    
+    // Close the minute this reading no longer belongs to
+    bool closed = false;
+    if (filter.collecting && nowMs - filter.minuteStartMs >= TEMP_MINUTE_MS) {
+        if (filter.minuteReadings > 0) {
+            int32_t n = filter.minuteReadings;
+            int32_t sum = filter.minuteSum;
+            completed.startMs = filter.minuteStartMs;
+            completed.meanCenti = temperatureMilliToCenti(sum >= 0 ? (sum + n / 2) / n : (sum - n / 2) / n);
+            completed.minCenti = temperatureMilliToCenti(filter.minuteMin);
+            completed.maxCenti = temperatureMilliToCenti(filter.minuteMax);
+            completed.readings = filter.minuteReadings;
+            closed = true;
+        }
+        // Stay on the minute grid across gaps
+        uint32_t minutes = (nowMs - filter.minuteStartMs) / TEMP_MINUTE_MS;
+        startMinute(filter, filter.minuteStartMs + minutes * TEMP_MINUTE_MS);
+    } else if (!filter.collecting) {
+        startMinute(filter, nowMs);
+    }
+    
+    int32_t value = temperatureFilterValue(filter);
+    if (filter.minuteReadings == 0 || value < filter.minuteMin) filter.minuteMin = value;
+    if (filter.minuteReadings == 0 || value > filter.minuteMax) filter.minuteMax = value;
+    filter.minuteSum += value;
+    filter.minuteReadings++;
+    return closed;
+}
+
+int32_t temperatureFilterValue(const TemperatureFilter& filter) {
+    if (!filter.primed) return TEMP_INVALID_MILLI;
+    int32_t half = IIR_ONE / 2;
+    return filter.state >= 0 ? (filter.state + half) / IIR_ONE : (filter.state - half) / IIR_ONE;
+}
+
+int32_t temperatureNtcMilli(uint32_t milliVolts) {
+    // Within 1% of either rail the divider is open or shorted
+    if (milliVolts < TEMP_NTC_SUPPLY_MV / 100 || milliVolts > TEMP_NTC_SUPPLY_MV - TEMP_NTC_SUPPLY_MV / 100) {
+        return TEMP_INVALID_MILLI;
+    }
+    
+    // Beta equation: 1/T = 1/T25 + ln(R/R25)/B
+    float resistance = (float)TEMP_NTC_SERIES_OHM * milliVolts / (TEMP_NTC_SUPPLY_MV - milliVolts);
+    float inverseKelvin = 1.0f / 298.15f + logf(resistance / TEMP_NTC_R25_OHM) / TEMP_NTC_BETA;
+    return (int32_t)lroundf((1.0f / inverseKelvin - 273.15f) * 1000.0f);
+}
+
+int16_t temperatureMilliToCenti(int32_t milliC) {
+    if (milliC == TEMP_INVALID_MILLI) return TEMP_UNKNOWN_CENTI;
+    return (int16_t)(milliC >= 0 ? (milliC + 5) / 10 : (milliC - 5) / 10);
+}
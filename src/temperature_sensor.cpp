@@ -0,0 +1,118 @@
+#include "temperature_sensor.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include "seqlock.h"
+
+static std::atomic<int16_t> latestCenti{TEMP_UNKNOWN_CENTI};
+static TemperatureStatus sensorStatus;
+static SeqLock<TemperatureStatus> statusLock;
+static TemperatureFilter filter;
+
+// Minutes in static RAM, 12 bytes each. Single writer (sampling task),
+// same announce-then-write scheme as the shot log.
+static TemperatureMinute history[TEMP_HISTORY_MINUTES];
+static std::atomic<uint32_t> writing{0};
+static std::atomic<uint32_t> written{0};
+
+// One conversion in 1/1000 °C, out of range if the sensor failed
+static int32_t readConversion() {
+#ifdef TEMP_SENSOR_PIN
+    return temperatureNtcMilli(analogReadMilliVolts(TEMP_SENSOR_PIN));
+#else
+    return (int32_t)(temperatureRead() * 1000.0f);
+#endif
+}
+
+static void appendMinute(const TemperatureMinute& minute) {
+    uint32_t sequence = written.load(std::memory_order_relaxed) + 1;
+    writing.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    memcpy(&history[sequence % TEMP_HISTORY_MINUTES], &minute, sizeof(TemperatureMinute));
+    
+    written.store(sequence, std::memory_order_release);
+}
+
+static void sample() {
+    int32_t conversions[TEMP_OVERSAMPLE];
+    for (uint8_t i = 0; i < TEMP_OVERSAMPLE; i++) conversions[i] = readConversion();
+    
+    uint8_t rejected = 0;
+    int32_t reading = temperatureOversample(conversions, TEMP_OVERSAMPLE, rejected);
+    uint32_t now = millis();
+    sensorStatus.rejected += rejected;
+    
+    if (reading == TEMP_INVALID_MILLI) {
+        sensorStatus.dropped++;
+    } else {
+        TemperatureMinute minute;
+        if (temperatureFilterAdd(filter, now, reading, minute)) appendMinute(minute);
+        sensorStatus.milliC = temperatureFilterValue(filter);
+        sensorStatus.rawMilliC = reading;
+        sensorStatus.readingMs = now;
+        sensorStatus.readings = filter.readings;
+        sensorStatus.restarts = filter.restarts;
+    }
+    
+    sensorStatus.valid = sensorStatus.readings > 0 && now - sensorStatus.readingMs <= TEMP_STALE_MS;
+    latestCenti.store(sensorStatus.valid ? temperatureMilliToCenti(sensorStatus.milliC) : TEMP_UNKNOWN_CENTI,
+                      std::memory_order_relaxed);
+    statusLock.write(sensorStatus);
+}
+
+static void temperatureTask(void* parameter) {
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+        sample();
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(TEMP_SAMPLE_MS));
+        
+        // The tick count jumps over a light sleep; carry on from now
+        // instead of catching up with a burst of readings
+        TickType_t now = xTaskGetTickCount();
+        if (now - wake >= pdMS_TO_TICKS(TEMP_SAMPLE_MS)) wake = now;
+    }
+}
+
+bool temperatureSensorBegin() {
+#ifdef TEMP_SENSOR_PIN
+    analogSetPinAttenuation(TEMP_SENSOR_PIN, ADC_11db);
+#endif
+    statusLock.write(sensorStatus);
+    BaseType_t result = xTaskCreatePinnedToCore(temperatureTask, "temperature", TEMP_TASK_STACK, nullptr,
+                                                TEMP_TASK_PRIORITY, nullptr, TEMP_TASK_CORE);
+    return result == pdPASS;
+}
+
+const char* temperatureSensorName() {
+#ifdef TEMP_SENSOR_PIN
+    return "ntc";
+#else
+    return "internal";
+#endif
+}
+
+int16_t temperatureLatestCenti() {
+    return latestCenti.load(std::memory_order_relaxed);
+}
+
+void temperatureReadStatus(TemperatureStatus& status) {
+    statusLock.read(status);
+}
+
+void temperatureHistoryRange(uint32_t& first, uint32_t& next) {
+    next = written.load(std::memory_order_acquire) + 1;
+    first = next > TEMP_HISTORY_MINUTES ? next - TEMP_HISTORY_MINUTES : 1;
+}
+
+bool temperatureHistoryRead(uint32_t sequence, TemperatureMinute& minute) {
+    if (sequence == 0 || sequence > written.load(std::memory_order_acquire)) return false;
+    
+    memcpy(&minute, &history[sequence % TEMP_HISTORY_MINUTES], sizeof(TemperatureMinute));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    
+    // The slot may have been reused for sequence + TEMP_HISTORY_MINUTES meanwhile
+    uint32_t latest = writing.load(std::memory_order_relaxed);
+    return latest - sequence < TEMP_HISTORY_MINUTES;
+}
@@ -0,0 +1,216 @@
+#include "timer_wheel.h"
+
+static const uint64_t SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+static void pushFront(TimerWheel& wheel, uint16_t list, uint16_t timer) {
+    TimerNode& node = wheel.nodes[timer];
+    node.list = list;
+    node.prev = TIMER_NONE;
+    node.next = wheel.heads[list];
+    if (node.next != TIMER_NONE) wheel.nodes[node.next].prev = timer;
+    wheel.heads[list] = timer;
+}
+
+static void appendDue(TimerWheel& wheel, uint16_t timer) {
+    TimerNode& node = wheel.nodes[timer];
+    node.list = TIMER_LIST_DUE;
+    node.next = TIMER_NONE;
+    node.prev = wheel.dueTail;
+    if (wheel.dueTail != TIMER_NONE) {
+        wheel.nodes[wheel.dueTail].next = timer;
+    } else {
+        wheel.heads[TIMER_LIST_DUE] = timer;
+    }
+    wheel.dueTail = timer;
+}
+
+static void unlink(TimerWheel& wheel, uint16_t timer) {
+    TimerNode& node = wheel.nodes[timer];
+    if (node.prev != TIMER_NONE) {
+        wheel.nodes[node.prev].next = node.next;
+    } else {
+        wheel.heads[node.list] = node.next;
+    }
+    if (node.next != TIMER_NONE) {
+        wheel.nodes[node.next].prev = node.prev;
+    } else if (node.list == TIMER_LIST_DUE) {
+        wheel.dueTail = node.prev;
+    }
+    
+    // Last timer of a slot leaves it
+    if (node.list < TIMER_LIST_OVERFLOW && wheel.heads[node.list] == TIMER_NONE) {
+        wheel.occupied[node.list / TIMER_WHEEL_SLOTS] &= ~(1ULL << (node.list % TIMER_WHEEL_SLOTS));
+    }
+}
+
+// The lowest level whose next round still contains the expiry: above that
+// level the expiry and `now` agree digit for digit
+static void file(TimerWheel& wheel, uint16_t timer) {
+    uint64_t expires = wheel.nodes[timer].expires;
+    if (expires < wheel.now) {
+        appendDue(wheel, timer);
+        return;
+    }
+    
+    uint64_t differing = expires ^ wheel.now;
+    for (uint8_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint8_t shift = level * TIMER_WHEEL_SLOT_BITS;
+        if ((differing >> (shift + TIMER_WHEEL_SLOT_BITS)) != 0) continue;
+        
+        uint8_t slot = (expires >> shift) & SLOT_MASK;
+        pushFront(wheel, level * TIMER_WHEEL_SLOTS + slot, timer);
+        wheel.occupied[level] |= 1ULL << slot;
+        return;
+    }
+    pushFront(wheel, TIMER_LIST_OVERFLOW, timer);
+}
+
+// Detaches a whole list and files its timers again against the current `now`
+static void refile(TimerWheel& wheel, uint16_t list) {
+    uint16_t timer = wheel.heads[list];
+    if (timer == TIMER_NONE) return;
+    
+    wheel.heads[list] = TIMER_NONE;
+    if (list < TIMER_LIST_OVERFLOW) {
+        wheel.occupied[list / TIMER_WHEEL_SLOTS] &= ~(1ULL << (list % TIMER_WHEEL_SLOTS));
+    }
+    while (timer != TIMER_NONE) {
+        uint16_t next = wheel.nodes[timer].next;
+        file(wheel, timer);
+        wheel.cascaded++;
+        timer = next;
+    }
+}
+
+// `now` just reached a multiple of 64: every level whose digit changed
+// hands its current slot down
+static void cascade(TimerWheel& wheel) {
+    for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        uint8_t digit = (wheel.now >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK;
+        refile(wheel, level * TIMER_WHEEL_SLOTS + digit);
+        if (digit != 0) return;
+    }
+    refile(wheel, TIMER_LIST_OVERFLOW);
+}
+
+void timerWheelInit(TimerWheel& wheel, TimerNode* nodes, uint16_t capacity, uint64_t now) {
+    wheel = TimerWheel();
+    wheel.nodes = nodes;
+    wheel.capacity = capacity;
+    wheel.now = now;
+    for (uint16_t i = 0; i < TIMER_LIST_COUNT; i++) {
+        wheel.heads[i] = TIMER_NONE;
+    }
+    
+    // Free nodes chain through `next`
+    for (uint16_t i = 0; i < capacity; i++) {
+        nodes[i].list = TIMER_NONE;
+        nodes[i].next = i + 1 < capacity ? i + 1 : TIMER_NONE;
+    }
+    wheel.freeHead = capacity > 0 ? 0 : TIMER_NONE;
+}
+
+uint16_t timerWheelAdd(TimerWheel& wheel, uint64_t expires) {
+    uint16_t timer = wheel.freeHead;
+    if (timer == TIMER_NONE) return TIMER_NONE;
+    
+    wheel.freeHead = wheel.nodes[timer].next;
+    wheel.nodes[timer].expires = expires;
+    file(wheel, timer);
+    wheel.pending++;
+    return timer;
+}
+
+void timerWheelMove(TimerWheel& wheel, uint16_t timer, uint64_t expires) {
+    if (timer >= wheel.capacity || wheel.nodes[timer].list == TIMER_NONE) return;
+    
+    unlink(wheel, timer);
+    wheel.nodes[timer].expires = expires;
+    file(wheel, timer);
+}
+
+bool timerWheelCancel(TimerWheel& wheel, uint16_t timer) {
+    if (timer >= wheel.capacity || wheel.nodes[timer].list == TIMER_NONE) return false;
+    
+    unlink(wheel, timer);
+    wheel.nodes[timer].list = TIMER_NONE;
+    wheel.nodes[timer].next = wheel.freeHead;
+    wheel.freeHead = timer;
+    wheel.pending--;
+    return true;
+}
+
+void timerWheelAdvance(TimerWheel& wheel, uint64_t tick) {
+    // Nothing filed, nothing to cascade
+    if (wheel.pending == 0) {
+        if (tick >= wheel.now) wheel.now = tick + 1;
+        return;
+    }
+    
+    while (wheel.now <= tick) {
+        uint64_t roundEnd = (wheel.now | SLOT_MASK) + 1;
+        uint64_t ahead = wheel.occupied[0] >> (wheel.now & SLOT_MASK);
+        
+        if (ahead != 0) {
+            uint64_t expires = wheel.now + __builtin_ctzll(ahead);
+            if (expires > tick) {
+                wheel.now = tick + 1;
+                return;
+            }
+            
+            // Every timer in a level-0 slot expires on the same tick
+            uint16_t list = expires & SLOT_MASK;
+            uint16_t timer = wheel.heads[list];
+            wheel.heads[list] = TIMER_NONE;
+            wheel.occupied[0] &= ~(1ULL << list);
+            while (timer != TIMER_NONE) {
+                uint16_t next = wheel.nodes[timer].next;
+                appendDue(wheel, timer);
+                timer = next;
+            }
+            
+            wheel.now = expires + 1;
+            if (wheel.now != roundEnd) continue;
+        } else {
+            // Nothing left in this level-0 round
+            if (roundEnd > tick + 1) {
+                wheel.now = tick + 1;
+                return;
+            }
+            wheel.now = roundEnd;
+        }
+        cascade(wheel);
+    }
+}
+
+uint16_t timerWheelPop(TimerWheel& wheel) {
+    uint16_t timer = wheel.heads[TIMER_LIST_DUE];
+    if (timer == TIMER_NONE) return TIMER_NONE;
+    
+    timerWheelCancel(wheel, timer);
+    return timer;
+}
+
+uint64_t timerWheelNextExpiry(const TimerWheel& wheel) {
+    if (wheel.heads[TIMER_LIST_DUE] != TIMER_NONE) return wheel.now;
+    
+    uint64_t ahead = wheel.occupied[0] >> (wheel.now & SLOT_MASK);
+    if (ahead != 0) return wheel.now + __builtin_ctzll(ahead);
+    
+    // Higher levels only hold slots after the current digit; the first one
+    // found starts no earlier than its slot
+    for (uint8_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        uint8_t shift = level * TIMER_WHEEL_SLOT_BITS;
+        uint8_t digit = (wheel.now >> shift) & SLOT_MASK;
+        uint64_t later = wheel.occupied[level] & ~((2ULL << digit) - 1);
+        if (later == 0) continue;
+        
+        uint64_t round = wheel.now >> (shift + TIMER_WHEEL_SLOT_BITS) << (shift + TIMER_WHEEL_SLOT_BITS);
+        return round | ((uint64_t)__builtin_ctzll(later) << shift);
+    }
+    
+    if (wheel.heads[TIMER_LIST_OVERFLOW] != TIMER_NONE) {
+        return ((wheel.now >> TIMER_WHEEL_SPAN_BITS) + 1) << TIMER_WHEEL_SPAN_BITS;
+    }
+    return UINT64_MAX;
+}
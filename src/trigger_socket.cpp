@@ -0,0 +1,361 @@
+#include "trigger_socket.h"
+
+#include <Arduino.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+#include <string.h>
+#include "metrics.h"
+#include "rt_task.h"
+#include "shot_jobs.h"
+#include "shot_log.h"
+#include "shot_scheduler.h"
+
+// RFC 6455 subset: single unfragmented frames with the short length form,
+// which covers every message here as well as pings and close frames
+static const uint8_t WS_MAX_PAYLOAD = 125;
+static const uint8_t WS_OP_TEXT = 0x1;
+static const uint8_t WS_OP_BINARY = 0x2;
+static const uint8_t WS_OP_CLOSE = 0x8;
+static const uint8_t WS_OP_PING = 0x9;
+static const uint8_t WS_OP_PONG = 0xA;
+static const uint16_t WS_CLOSE_NORMAL = 1000;
+static const uint16_t WS_CLOSE_PROTOCOL = 1002;
+static const uint16_t WS_CLOSE_UNSUPPORTED = 1003;
+static const uint16_t WS_CLOSE_TOO_BIG = 1009;
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+struct TriggerClient {
+    WiFiClient socket;
+    uint8_t rx[6 + WS_MAX_PAYLOAD];     // Header, mask and payload of one frame
+    uint8_t rxLen;
+    uint32_t lastRxMs;
+    uint32_t lastPingMs;
+};
+
+struct TriggerPending {
+    uint32_t jobId;             // 0 = free
+    uint16_t tag;
+    uint8_t client;
+    uint16_t shotsLeft;
+    uint32_t deadlineMs;
+};
+
+static TriggerClient clients[MAX_TRIGGER_CLIENTS];
+static TriggerPending pending[MAX_TRIGGER_PENDING];
+static uint8_t pendingCount = 0;
+static uint32_t logCursor = 0;
+
+static void put16(uint8_t* p, uint16_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) p[i] = value >> (8 * i);
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return p[0] | (uint16_t)p[1] << 8;
+}
+
+static uint32_t get32(const uint8_t* p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static bool acceptKey(const char* key, char* out, size_t size) {
+    char input[64 + sizeof(WS_GUID)];
+    int len = snprintf(input, sizeof(input), "%s%s", key, WS_GUID);
+    if (len <= (int)sizeof(WS_GUID) - 1 || (size_t)len >= sizeof(input)) return false;
+    
+    uint8_t digest[20];
+#if MBEDTLS_VERSION_MAJOR >= 3
+    if (mbedtls_sha1((const unsigned char*)input, len, digest) != 0) return false;
+#else
+    if (mbedtls_sha1_ret((const unsigned char*)input, len, digest) != 0) return false;
+#endif
+    size_t written = 0;
+    return mbedtls_base64_encode((unsigned char*)out, size, &written, digest, sizeof(digest)) == 0;
+}
+
+static void dropClient(uint8_t slot) {
+    clients[slot].socket.stop();
+    clients[slot].socket = WiFiClient();
+    clients[slot].rxLen = 0;
+    
+    // Nobody left to acknowledge to; the jobs themselves still fire
+    for (TriggerPending& entry : pending) {
+        if (entry.jobId != 0 && entry.client == slot) {
+            entry.jobId = 0;
+            pendingCount--;
+        }
+    }
+}
+
+// One write per frame, so with Nagle off it leaves as a single segment
+static void sendFrame(uint8_t slot, uint8_t opcode, const uint8_t* payload, uint8_t len) {
+    uint8_t frame[2 + WS_MAX_PAYLOAD];
+    frame[0] = 0x80 | opcode;
+    frame[1] = len;
+    if (len > 0) memcpy(frame + 2, payload, len);
+    if (clients[slot].socket.write(frame, 2 + len) != 2u + len) dropClient(slot);
+}
+
+static void closeClient(uint8_t slot, uint16_t code) {
+    uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};     // Network order
+    sendFrame(slot, WS_OP_CLOSE, payload, sizeof(payload));
+    if (clients[slot].socket) dropClient(slot);
+}
+
+static void sendError(uint8_t slot, uint16_t tag, TriggerError error) {
+    uint8_t message[4] = {TRIGGER_ERROR};
+    put16(message + 1, tag);
+    message[3] = error;
+    sendFrame(slot, WS_OP_BINARY, message, sizeof(message));
+}
+
+static void sendState(uint8_t slot, uint16_t tag, const StatusSnapshot& status) {
+    uint8_t message[13] = {TRIGGER_STATE};
+    put16(message + 1, tag);
+    put32(message + 3, millis());
+    message[7] = status.session.state;
+    put16(message + 8, status.session.currentShot);
+    put16(message + 10, status.session.totalShots);
+    message[12] = status.jobsPending;
+    sendFrame(slot, WS_OP_BINARY, message, sizeof(message));
+}
+
+static void queueJob(uint8_t slot, uint16_t tag, uint16_t count, uint32_t spacingMs, uint32_t receivedMs) {
+    // Reserve the acknowledgement first, a job nobody hears about is worse
+    // than a refused one
+    TriggerPending* entry = nullptr;
+    for (uint8_t i = 0; i < MAX_TRIGGER_PENDING && entry == nullptr; i++) {
+        if (pending[i].jobId == 0) entry = &pending[i];
+    }
+    uint32_t jobId = entry != nullptr ? rtSubmitShotJob(count, spacingMs) : 0;
+    if (jobId == 0) {
+        sendError(slot, tag, TRIGGER_ERR_BUSY);
+        return;
+    }
+    
+    entry->jobId = jobId;
+    entry->tag = tag;
+    entry->client = slot;
+    entry->shotsLeft = count;
+    entry->deadlineMs = receivedMs + (count - 1) * spacingMs + TRIGGER_ACK_TIMEOUT_MS;
+    pendingCount++;
+    
+    uint8_t message[11] = {TRIGGER_QUEUED};
+    put16(message + 1, tag);
+    put32(message + 3, jobId);
+    put32(message + 7, receivedMs);
+    sendFrame(slot, WS_OP_BINARY, message, sizeof(message));
+}
+
+static void handleMessage(uint8_t slot, const uint8_t* data, uint8_t len, const StatusSnapshot& status) {
+    METRIC_TIME_SCOPE(METRIC_TRIGGER_FRAME);
+    uint32_t receivedMs = millis();
+    rtHoldAwake(IDLE_HOLD_AWAKE_MS);
+    
+    if (len < 3) {
+        sendError(slot, 0, TRIGGER_ERR_INVALID);
+        return;
+    }
+    uint16_t tag = get16(data + 1);
+    
+    switch (data[0]) {
+        case TRIGGER_SHOT:
+            queueJob(slot, tag, 1, 0, receivedMs);
+            break;
+        case TRIGGER_BURST: {
+            // Same limits as POST /burst
+            uint16_t count = len >= 9 ? get16(data + 3) : 0;
+            uint32_t spacingMs = len >= 9 ? get32(data + 5) : 0;
+            if (count < 1 || count > MAX_BURST_COUNT ||
+                spacingMs < MIN_BURST_SPACING_MS || spacingMs > MAX_BURST_SPACING_MS) {
+                sendError(slot, tag, TRIGGER_ERR_INVALID);
+                break;
+            }
+            queueJob(slot, tag, count, spacingMs, receivedMs);
+            break;
+        }
+        case TRIGGER_STATUS:
+            sendState(slot, tag, status);
+            break;
+        default:
+            sendError(slot, tag, TRIGGER_ERR_INVALID);
+            break;
+    }
+}
+
+// Handles the first complete frame in the receive buffer; false if there is
+// none yet or the client was dropped
+static bool handleFrame(uint8_t slot, const StatusSnapshot& status) {
+    TriggerClient& client = clients[slot];
+    if (client.rxLen < 2) return false;
+    
+    bool fin = client.rx[0] & 0x80;
+    uint8_t opcode = client.rx[0] & 0x0F;
+    bool masked = client.rx[1] & 0x80;
+    uint8_t len = client.rx[1] & 0x7F;
+    
+    // Clients must mask; fragments and the extended lengths are never needed
+    if (!masked || !fin || opcode == 0) {
+        closeClient(slot, WS_CLOSE_PROTOCOL);
+        return false;
+    }
+    if (len > WS_MAX_PAYLOAD) {
+        closeClient(slot, WS_CLOSE_TOO_BIG);
+        return false;
+    }
+    uint8_t frameLen = 6 + len;
+    if (client.rxLen < frameLen) return false;
+    
+    uint8_t* payload = client.rx + 6;
+    for (uint8_t i = 0; i < len; i++) payload[i] ^= client.rx[2 + i % 4];
+    
+    switch (opcode) {
+        case WS_OP_BINARY:
+            handleMessage(slot, payload, len, status);
+            break;
+        case WS_OP_PING:
+            sendFrame(slot, WS_OP_PONG, payload, len);
+            break;
+        case WS_OP_PONG:
+            break;
+        case WS_OP_CLOSE:
+            closeClient(slot, len >= 2 ? (uint16_t)(payload[0] << 8 | payload[1]) : WS_CLOSE_NORMAL);
+            return false;
+        case WS_OP_TEXT:
+        default:
+            closeClient(slot, WS_CLOSE_UNSUPPORTED);
+            return false;
+    }
+    if (!client.socket) return false;
+    
+    client.rxLen -= frameLen;
+    memmove(client.rx, client.rx + frameLen, client.rxLen);
+    return true;
+}
+
+static void readFrames(uint8_t slot, const StatusSnapshot& status) {
+    TriggerClient& client = clients[slot];
+    
+    int available;
+    while (client.socket && (available = client.socket.available()) > 0) {
+        size_t space = sizeof(client.rx) - client.rxLen;
+        int len = client.socket.read(client.rx + client.rxLen, (size_t)available < space ? available : space);
+        if (len <= 0) break;
+        client.rxLen += len;
+        client.lastRxMs = millis();
+        while (handleFrame(slot, status)) {}
+    }
+}
+
+// FIRED acknowledgements for pending jobs from the new shot log records
+static void scanShotLog() {
+    uint32_t first, next;
+    shotLogRange(first, next);
+    if (pendingCount == 0) {
+        logCursor = next;
+        return;
+    }
+    if ((int32_t)(logCursor - first) < 0) logCursor = first;
+    
+    for (; logCursor != next; logCursor++) {
+        ShotRecord record;
+        if (!shotLogRead(logCursor, record) || record.kind != SHOT_JOB) continue;
+        
+        for (TriggerPending& entry : pending) {
+            if (entry.jobId == 0 || (uint16_t)entry.jobId != record.jobId) continue;
+            
+            uint8_t message[13] = {TRIGGER_FIRED};
+            put16(message + 1, entry.tag);
+            put32(message + 3, entry.jobId);
+            put16(message + 7, record.index);
+            put32(message + 9, record.actualMs);
+            uint8_t slot = entry.client;
+            if (--entry.shotsLeft == 0) {
+                entry.jobId = 0;
+                pendingCount--;
+            }
+            sendFrame(slot, WS_OP_BINARY, message, sizeof(message));
+            break;
+        }
+    }
+}
+
+bool triggerSocketAccept(WiFiClient& client, const char* key) {
+    char accept[32];
+    if (!acceptKey(key, accept, sizeof(accept))) return false;
+    
+    // A reloaded page leaves its old socket behind; the quietest one goes
+    uint8_t slot = 0;
+    for (uint8_t i = 0; i < MAX_TRIGGER_CLIENTS; i++) {
+        if (!clients[i].socket || !clients[i].socket.connected()) {
+            slot = i;
+            break;
+        }
+        if (millis() - clients[i].lastRxMs > millis() - clients[slot].lastRxMs) slot = i;
+    }
+    if (clients[slot].socket) dropClient(slot);
+    
+    char response[160];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n"
+                       "\r\n", accept);
+    
+    TriggerClient& entry = clients[slot];
+    entry.socket = client;
+    entry.socket.setNoDelay(true);
+    entry.socket.setTimeout(1); // Seconds; a stalled browser must not hold up the loop
+    entry.rxLen = 0;
+    entry.lastRxMs = millis();
+    entry.lastPingMs = millis();
+    entry.socket.write((const uint8_t*)response, len);
+    return true;
+}
+
+void triggerSocketUpdate(const StatusSnapshot& status) {
+    uint32_t now = millis();
+    
+    for (uint8_t i = 0; i < MAX_TRIGGER_CLIENTS; i++) {
+        TriggerClient& client = clients[i];
+        if (!client.socket) continue;
+        
+        if (!client.socket.connected() || now - client.lastRxMs > TRIGGER_IDLE_TIMEOUT_MS) {
+            dropClient(i);
+            continue;
+        }
+        readFrames(i, status);
+        
+        if (client.socket && now - client.lastPingMs >= TRIGGER_PING_MS) {
+            client.lastPingMs = now;
+            sendFrame(i, WS_OP_PING, nullptr, 0);
+        }
+    }
+    
+    scanShotLog();
+    
+    // Jobs the real-time task refused or never got to
+    for (TriggerPending& entry : pending) {
+        if (entry.jobId == 0 || !timeReached(now, entry.deadlineMs)) continue;
+        
+        uint8_t slot = entry.client;
+        uint16_t tag = entry.tag;
+        entry.jobId = 0;
+        pendingCount--;
+        sendError(slot, tag, TRIGGER_ERR_DROPPED);
+    }
+}
+
+uint8_t triggerSocketClientCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_TRIGGER_CLIENTS; i++) {
+        if (clients[i].socket && clients[i].socket.connected()) count++;
+    }
+    return count;
+}
@@ -0,0 +1,103 @@
+#include "wall_clock.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <sys/time.h>
+
+static const uint32_t RTC_CLOCK_MAGIC = 0xA57C10C4;
+
+// Not cleared on reset, only on power loss
+struct RtcClock {
+    uint32_t magic;
+    int64_t epoch;
+    uint32_t check;
+};
+RTC_NOINIT_ATTR static RtcClock rtcClock;
+
+static WallClockSource source = CLOCK_NONE;
+static unsigned long lastRtcSave = 0;
+static unsigned long lastNvsSave = 0;
+
+static uint32_t rtcCheck(const RtcClock& clock) {
+    return clock.magic ^ (uint32_t)clock.epoch ^ (uint32_t)(clock.epoch >> 32) ^ 0x5A5A5A5A;
+}
+
+static void setEpoch(int64_t epoch) {
+    struct timeval tv;
+    tv.tv_sec = epoch;
+    tv.tv_usec = 0;
+    settimeofday(&tv, nullptr);
+}
+
+static void saveNvs(int64_t epoch) {
+    Preferences prefs;
+    if (!prefs.begin("clock", false)) return;
+    prefs.putLong64("epoch", epoch);
+    prefs.end();
+}
+
+void wallClockRestore() {
+    setenv("TZ", TIMEZONE, 1);
+    tzset();
+    
+    if (rtcClock.magic == RTC_CLOCK_MAGIC && rtcClock.check == rtcCheck(rtcClock)) {
+        setEpoch(rtcClock.epoch);
+        source = CLOCK_RTC;
+        return;
+    }
+    
+    Preferences prefs;
+    if (prefs.begin("clock", true)) {
+        int64_t epoch = prefs.getLong64("epoch", 0);
+        prefs.end();
+        if (epoch > 0) {
+            setEpoch(epoch);
+            source = CLOCK_NVS;
+        }
+    }
+}
+
+void wallClockSynced() {
+    source = CLOCK_NTP;
+    
+    // Persist right away so even an early power loss keeps a close time
+    lastNvsSave = millis();
+    saveNvs(time(nullptr));
+}
+
+void wallClockMaintain() {
+    if (source == CLOCK_NONE) return;
+    
+    unsigned long now = millis();
+    if (now - lastRtcSave >= 1000) {
+        lastRtcSave = now;
+        rtcClock.magic = RTC_CLOCK_MAGIC;
+        rtcClock.epoch = time(nullptr);
+        rtcClock.check = rtcCheck(rtcClock);
+    }
+    
+    // Flash only for synchronized time and rarely, to spare the sectors
+    if (source == CLOCK_NTP && now - lastNvsSave >= CLOCK_NVS_SAVE_INTERVAL_MS) {
+        lastNvsSave = now;
+        saveNvs(time(nullptr));
+    }
+}
+
+int64_t wallClockEpochMs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+WallClockSource wallClockSource() {
+    return source;
+}
+
+const char* wallClockSourceName() {
+    switch (source) {
+        case CLOCK_NVS: return "nvs";
+        case CLOCK_RTC: return "rtc";
+        case CLOCK_NTP: return "ntp";
+        default: return "none";
+    }
+}